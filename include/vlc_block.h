@@ -619,6 +619,80 @@ static inline void vlc_fifo_Cleanup(void *fifo)
 }
 #define vlc_fifo_CleanupPush(fifo) vlc_cleanup_push(vlc_fifo_Cleanup, fifo)
 
+/**
+ * \defgroup block_spsc Single producer, single consumer block queue
+ *
+ * Lock-free alternative to block_fifo_t for queues with exactly one
+ * producer thread and one consumer thread. Queueing and dequeueing do not
+ * take any lock; the consumer thread only sleeps (and the producer only
+ * wakes it up) when the queue is empty.
+ *
+ * Unlike block_fifo_t, there is no lock to hold while looking at the queue:
+ * block_SpscCount() and block_SpscSize() are only snapshots.
+ * @{
+ */
+
+typedef struct block_spsc_t block_spsc_t;
+
+/**
+ * Creates a single producer, single consumer queue of blocks.
+ *
+ * The created queue must be released with block_SpscRelease().
+ *
+ * @return the queue or NULL on memory error
+ */
+VLC_API block_spsc_t *block_SpscNew(void) VLC_USED VLC_MALLOC;
+
+/**
+ * Destroys a queue created by block_SpscNew().
+ *
+ * @note Any queued blocks are also destroyed.
+ * @warning Neither the producer nor the consumer may be using the queue
+ * when this function is called.
+ */
+VLC_API void block_SpscRelease(block_spsc_t *);
+
+/**
+ * Queues blocks at the end of a queue.
+ *
+ * This function may only be called from the producer thread.
+ * If memory is exhausted, the remaining blocks are dropped.
+ *
+ * @param block head of a block list to queue (may be NULL)
+ */
+VLC_API void block_SpscPut(block_spsc_t *, block_t *block);
+
+/**
+ * Dequeues the first block from a queue, if any.
+ *
+ * This function may only be called from the consumer thread.
+ *
+ * @return a block, or NULL if the queue is empty
+ */
+VLC_API block_t *block_SpscTryGet(block_spsc_t *) VLC_USED;
+
+/**
+ * Dequeues the first block from a queue, waiting until there is one if
+ * necessary. This function is (always) a cancellation point.
+ *
+ * This function may only be called from the consumer thread.
+ *
+ * @return a valid block
+ */
+VLC_API block_t *block_SpscGet(block_spsc_t *) VLC_USED;
+
+/**
+ * Counts the blocks in a queue.
+ */
+VLC_API size_t block_SpscCount(block_spsc_t *) VLC_USED;
+
+/**
+ * Counts the bytes in the blocks of a queue.
+ */
+VLC_API size_t block_SpscSize(block_spsc_t *) VLC_USED;
+
+/** @} */
+
 /** @} */
 
 /** @} */
@@ -0,0 +1,139 @@
+/*****************************************************************************
+ * vlc_executor.h: thread pool
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_EXECUTOR_H
+# define VLC_EXECUTOR_H 1
+
+/**
+ * \defgroup executor Thread pool
+ * \ingroup thread
+ *
+ * An executor runs tasks on a bounded set of worker threads, so that
+ * short-lived parallel jobs do not each need their own threads.
+ *
+ * Each worker has its own queue of tasks. A task submitted from a worker
+ * thread is queued on that worker (and runs last-in first-out there, while
+ * its data is still in cache); other tasks are spread over the workers.
+ * Idle workers take tasks from the other workers' queues (work stealing).
+ * Worker threads are only created as tasks are submitted.
+ *
+ * LibVLC provides one executor shared by all its objects, sized after the
+ * number of CPUs: see vlc_executor_GetShared().
+ * @{
+ */
+
+typedef struct vlc_executor vlc_executor_t;
+
+/**
+ * Task for an executor.
+ *
+ * The structure is owned by the caller, and must remain valid until the
+ * task has run or has been canceled.
+ */
+struct vlc_runnable
+{
+    /**
+     * Runs the task, from a worker thread.
+     *
+     * The structure may be freed or submitted again from this callback.
+     */
+    void (*run)(void *userdata);
+    void *userdata; /**< opaque pointer passed to run() */
+
+    /* Private data (for the executor) */
+    struct vlc_runnable *prev, *next;
+};
+
+/**
+ * Executor statistics.
+ */
+struct vlc_executor_stats
+{
+    unsigned threads; /**< started worker threads */
+    unsigned max_threads; /**< maximum worker threads */
+    uint64_t submitted; /**< submitted tasks */
+    uint64_t completed; /**< run tasks */
+    uint64_t canceled; /**< canceled tasks */
+    uint64_t stolen; /**< tasks run by another worker than their own */
+    mtime_t busy; /**< total time spent running tasks */
+    mtime_t uptime; /**< time since the creation of the executor */
+};
+
+/**
+ * Creates an executor.
+ *
+ * @param max_threads maximum number of worker threads (at least 1)
+ * @return the executor or NULL on error
+ */
+VLC_API vlc_executor_t *vlc_executor_New(unsigned max_threads)
+VLC_USED VLC_MALLOC;
+
+/**
+ * Destroys an executor.
+ *
+ * Waits for all the queued tasks to run, then terminates the worker
+ * threads. No tasks may be submitted during or after this call.
+ */
+VLC_API void vlc_executor_Delete(vlc_executor_t *);
+
+/**
+ * Queues a task.
+ *
+ * The task runs as soon as a worker is available. Tasks are started in no
+ * particular order, and may run concurrently with each other.
+ *
+ * If no worker thread can be started at all, the task is run synchronously
+ * by the calling thread.
+ *
+ * @param runnable task (must not be queued already)
+ */
+VLC_API void vlc_executor_Submit(vlc_executor_t *,
+                                 struct vlc_runnable *runnable);
+
+/**
+ * Cancels a queued task.
+ *
+ * @retval true the task was dequeued and will not run
+ * @retval false the task is running, has run, or was not submitted
+ */
+VLC_API bool vlc_executor_Cancel(vlc_executor_t *,
+                                 struct vlc_runnable *runnable);
+
+/**
+ * Reads the statistics of an executor.
+ *
+ * The values are read without stopping the workers: they are only
+ * snapshots, and may not be consistent with each other.
+ */
+VLC_API void vlc_executor_GetStats(vlc_executor_t *,
+                                   struct vlc_executor_stats *stats);
+
+/**
+ * Gets the executor of a LibVLC instance.
+ *
+ * Its maximum number of threads is set by the "executor-threads" option.
+ * The executor remains valid as long as the LibVLC instance.
+ */
+VLC_API vlc_executor_t *vlc_executor_GetShared(vlc_object_t *) VLC_USED;
+#define vlc_executor_GetShared(o) vlc_executor_GetShared(VLC_OBJECT(o))
+
+/** @} */
+
+#endif
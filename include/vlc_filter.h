@@ -26,6 +26,7 @@
 #define VLC_FILTER_H 1
 
 #include <vlc_es.h>
+#include <vlc_picture.h>
 
 /**
  * \defgroup filter Filters
@@ -47,6 +48,9 @@ typedef struct filter_owner_t
         struct
         {
             picture_t * (*buffer_new)( filter_t * );
+            /** Maximum number of bands per picture for filter_SliceVideo()
+             * (0 or 1 to process pictures on the calling thread only) */
+            unsigned slices;
         } video;
         struct
         {
@@ -105,6 +109,20 @@ struct filter_t
                           subpicture_region_t *, const vlc_fourcc_t * );
     };
 
+    /** Filter a band of lines of a picture (video filter, optional)
+     *
+     * Filters whose output lines can be computed independently of each
+     * other set this in addition to pf_video_filter, and call
+     * filter_SliceVideo() from pf_video_filter once the output picture is
+     * allocated. This callback may then be invoked concurrently from several
+     * threads, on non-overlapping bands of the output picture.
+     *
+     * The band is given in lines of the first plane of the output picture:
+     * see filter_SlicePlane() for the other planes. */
+    void (*pf_video_slice)( filter_t *, picture_t *p_outpic,
+                            const picture_t *p_inpic,
+                            unsigned i_first_line, unsigned i_lines );
+
     union
     {
         /* TODO: video filter drain */
@@ -168,6 +186,40 @@ static inline picture_t *filter_NewPicture( filter_t *p_filter )
     return pic;
 }
 
+/**
+ * Processes a picture in bands of lines.
+ *
+ * This splits the output picture into horizontal bands, and calls
+ * pf_video_slice for each of them, using the LibVLC thread pool if the
+ * owner allows it. It returns once all the bands are done.
+ *
+ * \param p_outpic output picture
+ * \param p_inpic input picture
+ */
+VLC_API void filter_SliceVideo( filter_t *, picture_t *p_outpic,
+                                const picture_t *p_inpic );
+
+/**
+ * Converts a band of lines of the first plane of a picture to the
+ * corresponding band of another plane.
+ *
+ * \param p_pic picture
+ * \param i_plane plane index
+ * \param pi_first first line of the band (in the first plane) [IN/OUT]
+ * \param pi_lines lines in the band (in the first plane) [IN/OUT]
+ */
+static inline void filter_SlicePlane( const picture_t *p_pic, int i_plane,
+                                      unsigned *restrict pi_first,
+                                      unsigned *restrict pi_lines )
+{
+    const unsigned num = p_pic->p[i_plane].i_visible_lines;
+    const unsigned den = p_pic->p[0].i_visible_lines;
+    const unsigned end = (*pi_first + *pi_lines) * num / den;
+
+    *pi_first = *pi_first * num / den;
+    *pi_lines = end - *pi_first;
+}
+
 /**
  * Flush a filter
  *
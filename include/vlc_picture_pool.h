@@ -83,12 +83,12 @@ VLC_API picture_pool_t * picture_pool_New(unsigned count,
                                           picture_t *const *tab) VLC_USED;
 
 /**
- * Allocates pictures from the heap and creates a picture pool with them.
- * This is a convenience wrapper for picture_NewFromFormat() and
- * picture_pool_New().
+ * Creates a picture pool of pictures allocated from the heap.
+ * The pictures are allocated by picture_NewFromFormat() the first time they
+ * are obtained from the pool, so that unused pictures cost no memory.
  *
  * @param fmt video format of pictures to allocate from the heap
- * @param count number of pictures to allocate
+ * @param count maximum number of pictures to allocate
  *
  * @return a pointer to the new pool on success, NULL on error
  */
@@ -161,6 +161,12 @@ void picture_pool_Cancel( picture_pool_t *, bool canceled );
  */
 bool picture_pool_OwnsPic( picture_pool_t *, picture_t *);
 
+/**
+ * Test if a picture was allocated outside of any picture pool, typically by
+ * a decoder exporting its own buffers without copy.
+ */
+bool picture_pool_IsForeignPic( picture_t * );
+
 /**
  * Reserves pictures from a pool and creates a new pool with those.
  *
@@ -184,6 +190,13 @@ VLC_USED;
  */
 VLC_API unsigned picture_pool_GetSize(const picture_pool_t *);
 
+/**
+ * @return the number of pictures allocated so far in the given pool, lower
+ * than its size if created by picture_pool_NewFromFormat()
+ * @note This function is thread-safe.
+ */
+VLC_API unsigned picture_pool_GetAllocated(picture_pool_t *);
+
 
 #endif /* VLC_PICTURE_POOL_H */
 
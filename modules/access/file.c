@@ -51,6 +51,9 @@
 #else
 #   include <unistd.h>
 #endif
+#ifdef HAVE_MMAP
+#   include <sys/mman.h>
+#endif
 #include <dirent.h>
 
 #include <vlc_common.h>
@@ -63,12 +66,41 @@
 #include <vlc_fs.h>
 #include <vlc_url.h>
 #include <vlc_interrupt.h>
+#include <vlc_atomic.h>
+
+#ifdef HAVE_MMAP
+/* Size of the file windows mapped at once (multiple of the page size) */
+# define MMAP_WINDOW_SIZE (8 << 20)
+/* Size of the blocks handed to the stream layer */
+# define MMAP_BLOCK_SIZE (1 << 20)
+/* Files smaller than this are read */
+# define MMAP_MIN_FILE_SIZE (16 << 20)
+
+typedef struct
+{
+    void *addr;
+    size_t length;
+    uint64_t offset;
+    atomic_uint refs; /* one per block, plus one for the access */
+} file_window_t;
+
+typedef struct
+{
+    block_t self;
+    file_window_t *window;
+} file_block_t;
+#endif
 
 struct access_sys_t
 {
     int fd;
 
     bool b_pace_control;
+#ifdef HAVE_MMAP
+    uint64_t offset; /* read position */
+    uint64_t size; /* file size at last check */
+    file_window_t *window; /* current window (or NULL) */
+#endif
 };
 
 #if !defined (_WIN32) && !defined (__OS2__)
@@ -126,11 +158,19 @@ static bool IsRemote (const char *path)
 #ifndef HAVE_POSIX_FADVISE
 # define posix_fadvise(fd, off, len, adv)
 #endif
+#ifndef HAVE_POSIX_MADVISE
+# define posix_madvise(addr, len, adv)
+#endif
 
 static ssize_t Read (stream_t *, void *, size_t);
 static int FileSeek (stream_t *, uint64_t);
 static int NoSeek (stream_t *, uint64_t);
 static int FileControl (stream_t *, int, va_list);
+#ifdef HAVE_MMAP
+static block_t *MmapBlock (stream_t *, bool *);
+static int MmapSeek (stream_t *, uint64_t);
+static void MmapWindowRelease (file_window_t *);
+#endif
 
 /*****************************************************************************
  * FileOpen: open the file
@@ -213,6 +253,9 @@ int FileOpen( vlc_object_t *p_this )
     p_access->pf_control = FileControl;
     p_access->p_sys = p_sys;
     p_sys->fd = fd;
+#ifdef HAVE_MMAP
+    p_sys->window = NULL;
+#endif
 
     if (S_ISREG (st.st_mode) || S_ISBLK (st.st_mode))
     {
@@ -231,6 +274,23 @@ int FileOpen( vlc_object_t *p_this )
             fcntl (fd, F_RDAHEAD, 0);
         else
             fcntl (fd, F_RDAHEAD, 1);
+#endif
+#ifdef HAVE_MMAP
+        /* Map large local files rather than copying them. Remote files are
+         * not mapped, as the process gets SIGBUS if they are truncated. */
+        if (S_ISREG (st.st_mode) && st.st_size >= MMAP_MIN_FILE_SIZE
+         && var_InheritBool (p_access, "file-mmap")
+         && !IsRemote(fd, p_access->psz_filepath))
+        {
+            p_access->pf_read = NULL;
+            p_access->pf_block = MmapBlock;
+            p_access->pf_seek = MmapSeek;
+            p_sys->offset = 0;
+            p_sys->size = st.st_size;
+            p_sys->window = NULL;
+            msg_Dbg (p_access, "mapping file in %u MiB windows",
+                     MMAP_WINDOW_SIZE >> 20);
+        }
 #endif
     }
     else
@@ -253,7 +313,7 @@ void FileClose (vlc_object_t * p_this)
 {
     stream_t     *p_access = (stream_t*)p_this;
 
-    if (p_access->pf_read == NULL)
+    if (p_access->pf_readdir != NULL)
     {
         DirClose (p_this);
         return;
@@ -261,6 +321,11 @@ void FileClose (vlc_object_t * p_this)
 
     access_sys_t *p_sys = p_access->p_sys;
 
+#ifdef HAVE_MMAP
+    /* Blocks still in use keep their window mapped */
+    if (p_sys->window != NULL)
+        MmapWindowRelease (p_sys->window);
+#endif
     vlc_close (p_sys->fd);
 }
 
@@ -299,6 +364,163 @@ static int FileSeek (stream_t *p_access, uint64_t i_pos)
     return VLC_SUCCESS;
 }
 
+#ifdef HAVE_MMAP
+/*****************************************************************************
+ * Memory mapped reading
+ *****************************************************************************/
+static void MmapWindowRelease (file_window_t *window)
+{
+    if (atomic_fetch_sub (&window->refs, 1) != 1)
+        return;
+
+    munmap (window->addr, window->length);
+    free (window);
+}
+
+static void MmapBlockRelease (block_t *block)
+{
+    file_block_t *fb = (file_block_t *)block;
+
+    MmapWindowRelease (fb->window);
+    free (fb);
+}
+
+/**
+ * Maps the window containing the read position. If no block references the
+ * current window anymore, its address range is reused.
+ */
+static file_window_t *MmapWindow (stream_t *p_access)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    file_window_t *window = p_sys->window;
+    uint64_t offset = p_sys->offset & ~(uint64_t)(MMAP_WINDOW_SIZE - 1);
+    size_t length = __MIN(p_sys->size - offset, MMAP_WINDOW_SIZE);
+    void *addr = NULL;
+    int flags = MAP_PRIVATE;
+
+    if (window != NULL)
+    {
+        if (window->offset == offset && window->length == length)
+            return window;
+
+        if (atomic_load (&window->refs) == 1 && window->length >= length)
+        {   /* Recycle the window: only the access uses it */
+            munmap ((char *)window->addr + length, window->length - length);
+            addr = window->addr;
+            flags |= MAP_FIXED;
+        }
+        else
+        {
+            MmapWindowRelease (window);
+            window = NULL;
+        }
+        p_sys->window = NULL;
+    }
+
+    /* Demuxers and packetizers may write to their blocks: map the file
+     * copy-on-write so the file is never modified. */
+    void *map = mmap (addr, length, PROT_READ | PROT_WRITE, flags,
+                      p_sys->fd, offset);
+    if (map == MAP_FAILED)
+    {
+        msg_Err (p_access, "cannot map file at offset %"PRIu64": %s",
+                 offset, vlc_strerror_c(errno));
+        if (window != NULL)
+        {   /* The recycled range may or may not be unmapped by now */
+            munmap (addr, length);
+            free (window);
+        }
+        return NULL;
+    }
+
+    if (window == NULL)
+    {
+        window = malloc (sizeof (*window));
+        if (unlikely(window == NULL))
+        {
+            munmap (map, length);
+            return NULL;
+        }
+        atomic_init (&window->refs, 1);
+    }
+    window->addr = map;
+    window->length = length;
+    window->offset = offset;
+
+    /* Read ahead the current window and the next one */
+    posix_madvise (map, length, POSIX_MADV_SEQUENTIAL);
+    posix_madvise (map, length, POSIX_MADV_WILLNEED);
+    posix_fadvise (p_sys->fd, offset + length, MMAP_WINDOW_SIZE,
+                   POSIX_FADV_WILLNEED);
+
+    p_sys->window = window;
+    return window;
+}
+
+static block_t *MmapBlock (stream_t *p_access, bool *restrict eof)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    if (p_sys->offset >= p_sys->size)
+    {   /* The file may have grown */
+        struct stat st;
+
+        if (fstat (p_sys->fd, &st) == 0 && (uint64_t)st.st_size > p_sys->size)
+            p_sys->size = st.st_size;
+        if (p_sys->offset >= p_sys->size)
+        {
+            *eof = true;
+            return NULL;
+        }
+    }
+
+    file_window_t *window = MmapWindow (p_access);
+    if (window == NULL)
+    {   /* Fall back to reading */
+        block_t *block = block_Alloc (MMAP_BLOCK_SIZE);
+        if (unlikely(block == NULL))
+            return NULL;
+
+        ssize_t val = pread (p_sys->fd, block->p_buffer, MMAP_BLOCK_SIZE,
+                             p_sys->offset);
+        if (val <= 0)
+        {
+            if (val < 0)
+                msg_Err (p_access, "read error: %s", vlc_strerror_c(errno));
+            block_Release (block);
+            *eof = true;
+            return NULL;
+        }
+        block->i_buffer = val;
+        p_sys->offset += val;
+        return block;
+    }
+
+    size_t skip = p_sys->offset - window->offset;
+    size_t length = __MIN(window->length - skip, MMAP_BLOCK_SIZE);
+
+    file_block_t *fb = malloc (sizeof (*fb));
+    if (unlikely(fb == NULL))
+        return NULL;
+
+    block_Init (&fb->self, (char *)window->addr + skip, length);
+    fb->self.pf_release = MmapBlockRelease;
+    fb->window = window;
+    atomic_fetch_add (&window->refs, 1);
+
+    p_sys->offset += length;
+    return &fb->self;
+}
+
+static int MmapSeek (stream_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    p_sys->offset = i_pos;
+    return VLC_SUCCESS;
+}
+#endif
+
 static int NoSeek (stream_t *p_access, uint64_t i_pos)
 {
     /* vlc_assert_unreachable(); ?? */
@@ -39,6 +39,13 @@ vlc_module_begin ()
     set_capability( "access", 50 )
     add_shortcut( "file", "fd", "stream" )
     set_callbacks( FileOpen, FileClose )
+#ifdef HAVE_MMAP
+    add_bool( "file-mmap", false, N_("Map files in memory"),
+              N_("Map large local files in memory instead of copying "
+                 "them. This saves CPU time and memory bandwidth with high "
+                 "bitrate files, but VLC crashes if the file is truncated "
+                 "while it is being read."), true )
+#endif
 
     add_submodule()
     set_section( N_("Directory" ), NULL )
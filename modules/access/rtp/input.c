@@ -31,6 +31,7 @@
 
 #include <limits.h>
 #include <errno.h>
+#include <time.h>
 #include <unistd.h>
 #ifdef HAVE_POLL
 # include <poll.h>
@@ -100,6 +101,189 @@ static int rtp_timeout (mtime_t deadline)
     return t;
 }
 
+#ifdef HAVE_RECVMMSG
+/* Maximum number of datagrams received with one system call */
+# define RTP_BATCH 16
+/* Reception time and drop counter */
+# define RTP_CONTROL_SIZE (CMSG_SPACE(sizeof (struct timespec)) \
+                         + CMSG_SPACE(sizeof (uint32_t)))
+
+struct rtp_dgram_batch
+{
+    struct mmsghdr msgv[RTP_BATCH];
+    struct iovec iov[RTP_BATCH];
+    union
+    {
+        struct cmsghdr hdr;
+        char buf[RTP_CONTROL_SIZE];
+    } control[RTP_BATCH];
+    block_t *blocks[RTP_BATCH]; /**< preallocated blocks */
+    size_t mru;
+    uint32_t drops; /**< datagrams dropped by the kernel */
+    bool has_control;
+};
+
+static void rtp_dgram_init (struct rtp_dgram_batch *batch, int fd)
+{
+    memset (batch, 0, sizeof (*batch));
+    for (unsigned i = 0; i < RTP_BATCH; i++)
+    {
+        batch->msgv[i].msg_hdr.msg_iov = &batch->iov[i];
+        batch->msgv[i].msg_hdr.msg_iovlen = 1;
+    }
+    batch->mru = DEFAULT_MRU;
+# ifdef SO_TIMESTAMPNS
+    /* Datagrams are processed in batches: get their reception time from
+     * the kernel, for the jitter estimation. */
+    if (setsockopt (fd, SOL_SOCKET, SO_TIMESTAMPNS, &(int){ 1 },
+                    sizeof (int)) == 0)
+        batch->has_control = true;
+# endif
+# ifdef SO_RXQ_OVFL
+    if (setsockopt (fd, SOL_SOCKET, SO_RXQ_OVFL, &(int){ 1 },
+                    sizeof (int)) == 0)
+        batch->has_control = true;
+# endif
+    (void) fd;
+}
+
+static void rtp_dgram_cleanup (void *data)
+{
+    struct rtp_dgram_batch *batch = data;
+
+    for (unsigned i = 0; i < RTP_BATCH; i++)
+        if (batch->blocks[i] != NULL)
+            block_Release (batch->blocks[i]);
+}
+
+/**
+ * Parses the ancillary data of a received datagram.
+ * @param offset difference between the monotonic and real-time clocks
+ * @return the reception time of the datagram, or VLC_TS_INVALID
+ */
+static mtime_t rtp_dgram_control (demux_t *demux,
+                                  struct rtp_dgram_batch *batch,
+                                  struct msghdr *msg, mtime_t offset)
+{
+    mtime_t date = VLC_TS_INVALID;
+
+    if (msg->msg_control == NULL)
+        return date;
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR (msg);
+         cmsg != NULL;
+         cmsg = CMSG_NXTHDR (msg, cmsg))
+    {
+        if (cmsg->cmsg_level != SOL_SOCKET)
+            continue;
+# ifdef SCM_TIMESTAMPNS
+        if (cmsg->cmsg_type == SCM_TIMESTAMPNS)
+        {
+            struct timespec ts;
+
+            memcpy (&ts, CMSG_DATA (cmsg), sizeof (ts));
+            date = INT64_C(1000000) * ts.tv_sec + ts.tv_nsec / 1000 + offset;
+        }
+# endif
+# ifdef SO_RXQ_OVFL
+        if (cmsg->cmsg_type == SO_RXQ_OVFL)
+        {
+            uint32_t count;
+
+            memcpy (&count, CMSG_DATA (cmsg), sizeof (count));
+            if (count != batch->drops)
+            {
+                msg_Warn (demux, "%"PRIu32" RTP packets lost (receive "
+                          "buffer overrun)", count - batch->drops);
+                batch->drops = count;
+            }
+        }
+# endif
+    }
+    return date;
+}
+
+/**
+ * Receives and processes all pending datagrams, up to the batch size.
+ * @return false if memory is exhausted
+ */
+static bool rtp_dgram_recv (demux_t *demux, struct rtp_dgram_batch *batch,
+                            int fd, int trunc_flag)
+{
+    unsigned count = 0;
+
+    for (; count < RTP_BATCH; count++)
+    {
+        block_t *block = batch->blocks[count];
+
+        if (block == NULL)
+        {
+            block = block_Alloc (batch->mru);
+            if (unlikely(block == NULL))
+                break;
+            batch->blocks[count] = block;
+        }
+
+        struct msghdr *msg = &batch->msgv[count].msg_hdr;
+
+        batch->iov[count].iov_base = block->p_buffer;
+        batch->iov[count].iov_len = block->i_buffer;
+        msg->msg_control = batch->has_control ? batch->control[count].buf
+                                              : NULL;
+        msg->msg_controllen = batch->has_control
+                            ? sizeof (batch->control[count]) : 0;
+    }
+
+    if (unlikely(count == 0))
+    {
+        if (batch->mru == DEFAULT_MRU)
+            return false; /* we are totallly screwed */
+        batch->mru = DEFAULT_MRU; /* retry with shrunk MRU */
+        return true;
+    }
+
+    int val = recvmmsg (fd, batch->msgv, count, MSG_DONTWAIT | trunc_flag,
+                        NULL);
+    if (val == -1)
+    {
+        msg_Warn (demux, "RTP network error: %s", vlc_strerror_c(errno));
+        return true;
+    }
+
+    mtime_t now = mdate (), offset = 0;
+# ifdef SO_TIMESTAMPNS
+    struct timespec ts;
+
+    if (batch->has_control && clock_gettime (CLOCK_REALTIME, &ts) == 0)
+        offset = now - (INT64_C(1000000) * ts.tv_sec + ts.tv_nsec / 1000);
+# endif
+
+    for (int i = 0; i < val; i++)
+    {
+        block_t *block = batch->blocks[i];
+        size_t len = batch->msgv[i].msg_len;
+
+        batch->blocks[i] = NULL;
+        if (batch->msgv[i].msg_hdr.msg_flags & trunc_flag)
+        {
+            msg_Err(demux, "%zu bytes packet truncated (MRU was %zu)",
+                    len, block->i_buffer);
+            block->i_flags |= BLOCK_FLAG_CORRUPTED;
+            batch->mru = len;
+        }
+        else
+            block->i_buffer = len;
+
+        block->i_pts = rtp_dgram_control (demux, batch,
+                                          &batch->msgv[i].msg_hdr, offset);
+        if (block->i_pts == VLC_TS_INVALID)
+            block->i_pts = now;
+        rtp_process (demux, block);
+    }
+    return true;
+}
+#endif
+
 /**
  * RTP/RTCP session thread for datagram sockets
  */
@@ -115,6 +299,11 @@ void *rtp_dgram_thread (void *opaque)
     const int trunc_flag = 0;
 #endif
 
+#ifdef HAVE_RECVMMSG
+    struct rtp_dgram_batch batch;
+
+    rtp_dgram_init (&batch, rtp_fd);
+#else
     struct iovec iov =
     {
         .iov_len = DEFAULT_MRU,
@@ -124,11 +313,15 @@ void *rtp_dgram_thread (void *opaque)
         .msg_iov = &iov,
         .msg_iovlen = 1,
     };
+#endif
 
     struct pollfd ufd[1];
     ufd[0].fd = rtp_fd;
     ufd[0].events = POLLIN;
 
+#ifdef HAVE_RECVMMSG
+    vlc_cleanup_push (rtp_dgram_cleanup, &batch);
+#endif
     for (;;)
     {
         int n = poll (ufd, 1, rtp_timeout (deadline));
@@ -145,6 +338,10 @@ void *rtp_dgram_thread (void *opaque)
             if (unlikely(ufd[0].revents & POLLHUP))
                 break; /* RTP socket dead (DCCP only) */
 
+#ifdef HAVE_RECVMMSG
+            if (!rtp_dgram_recv (demux, &batch, rtp_fd, trunc_flag))
+                break;
+#else
             block_t *block = block_Alloc (iov.iov_len);
             if (unlikely(block == NULL))
             {
@@ -178,6 +375,7 @@ void *rtp_dgram_thread (void *opaque)
                           vlc_strerror_c(errno));
                 block_Release (block);
             }
+#endif
         }
 
     dequeue:
@@ -185,6 +383,10 @@ void *rtp_dgram_thread (void *opaque)
             deadline = VLC_TS_INVALID;
         vlc_restorecancel (canc);
     }
+#ifdef HAVE_RECVMMSG
+    vlc_cleanup_pop ();
+    rtp_dgram_cleanup (&batch);
+#endif
     return NULL;
 }
 
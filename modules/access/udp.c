@@ -56,9 +56,21 @@
 static int  Open( vlc_object_t * );
 static void Close( vlc_object_t * );
 
+#ifdef HAVE_RECVMMSG
+/* Maximum number of datagrams per read */
+# define UDP_BATCH_MAX 64
+/* Default number of datagrams per read */
+# define UDP_BATCH_DEFAULT 32
+/* Maximum size of the buffer for a read */
+# define UDP_BATCH_SIZE (UDP_BATCH_MAX * 1500)
+#endif
+
 #define BUFFER_TEXT N_("Receive buffer")
 #define BUFFER_LONGTEXT N_("UDP receive buffer size (bytes)" )
 #define TIMEOUT_TEXT N_("UDP Source timeout (sec)")
+#define BATCH_TEXT N_("Datagrams per read")
+#define BATCH_LONGTEXT N_( \
+    "Maximum number of datagrams received with a single system call." )
 
 vlc_module_begin ()
     set_shortname( N_("UDP" ) )
@@ -69,6 +81,10 @@ vlc_module_begin ()
     add_obsolete_integer( "server-port" ) /* since 2.0.0 */
     add_obsolete_integer( "udp-buffer" ) /* since 3.0.0 */
     add_integer( "udp-timeout", -1, TIMEOUT_TEXT, NULL, true )
+#ifdef HAVE_RECVMMSG
+    add_integer_with_range( "udp-batch", UDP_BATCH_DEFAULT, 1, UDP_BATCH_MAX,
+                            BATCH_TEXT, BATCH_LONGTEXT, true )
+#endif
 
     set_capability( "access", 0 )
     add_shortcut( "udp", "udpstream", "udp4", "udp6" )
@@ -81,6 +97,22 @@ struct access_sys_t
     int fd;
     int timeout;
     size_t mtu;
+#ifdef HAVE_RECVMMSG
+    unsigned batch;
+    struct mmsghdr msgs[UDP_BATCH_MAX];
+    struct iovec iov[UDP_BATCH_MAX];
+# ifdef SO_RXQ_OVFL
+    union
+    {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof (uint32_t))];
+    } control[UDP_BATCH_MAX];
+# endif
+    /* Statistics */
+    uintmax_t datagrams;
+    uint32_t drops; /* by the kernel, when the receive buffer is full */
+    unsigned truncated;
+#endif
 };
 
 /*****************************************************************************
@@ -174,6 +206,27 @@ static int Open( vlc_object_t *p_this )
     if( sys->timeout > 0)
         sys->timeout *= 1000;
 
+#ifdef HAVE_RECVMMSG
+    sys->batch = var_InheritInteger( p_access, "udp-batch" );
+    if( sys->batch < 1 || sys->batch > UDP_BATCH_MAX )
+        sys->batch = UDP_BATCH_DEFAULT;
+    memset( sys->msgs, 0, sizeof( sys->msgs ) );
+    for( unsigned i = 0; i < UDP_BATCH_MAX; i++ )
+    {
+        sys->msgs[i].msg_hdr.msg_iov = &sys->iov[i];
+        sys->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+# ifdef SO_RXQ_OVFL
+    /* Get the count of datagrams dropped for lack of buffer space */
+    if( setsockopt( sys->fd, SOL_SOCKET, SO_RXQ_OVFL, &(int){ 1 },
+                    sizeof (int) ) == 0 )
+        for( unsigned i = 0; i < UDP_BATCH_MAX; i++ )
+            sys->msgs[i].msg_hdr.msg_control = sys->control[i].buf;
+# endif
+    sys->datagrams = 0;
+    sys->drops = 0;
+    sys->truncated = 0;
+#endif
     return VLC_SUCCESS;
 }
 
@@ -185,6 +238,10 @@ static void Close( vlc_object_t *p_this )
     stream_t     *p_access = (stream_t*)p_this;
     access_sys_t *sys = p_access->p_sys;
 
+#ifdef HAVE_RECVMMSG
+    msg_Dbg( p_access, "%ju datagrams received, %"PRIu32" lost, "
+             "%u truncated", sys->datagrams, sys->drops, sys->truncated );
+#endif
     net_Close( sys->fd );
 }
 
@@ -218,14 +275,56 @@ static int Control( stream_t *p_access, int i_query, va_list args )
     return VLC_SUCCESS;
 }
 
+#ifdef HAVE_RECVMMSG
+/**
+ * Checks the count of datagrams dropped by the kernel.
+ */
+static void CheckDrops(stream_t *access, struct msghdr *msg)
+{
+# ifdef SO_RXQ_OVFL
+    access_sys_t *sys = access->p_sys;
+
+    if (msg->msg_control == NULL)
+        return;
+
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg);
+         cmsg != NULL;
+         cmsg = CMSG_NXTHDR(msg, cmsg))
+    {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SO_RXQ_OVFL)
+            continue;
+
+        uint32_t drops;
+
+        memcpy(&drops, CMSG_DATA(cmsg), sizeof (drops));
+        if (drops != sys->drops)
+        {
+            msg_Warn(access, "%"PRIu32" datagrams lost (receive buffer "
+                     "overrun)", drops - sys->drops);
+            sys->drops = drops;
+        }
+    }
+# else
+    (void) access; (void) msg;
+# endif
+}
+#endif
+
 /*****************************************************************************
  * BlockUDP:
  *****************************************************************************/
 static block_t *BlockUDP(stream_t *access, bool *restrict eof)
 {
     access_sys_t *sys = access->p_sys;
+#ifdef HAVE_RECVMMSG
+    /* Receive as many datagrams as available, up to the batch size, and
+     * return them in a single block. */
+    unsigned batch = __MAX(__MIN(sys->batch, UDP_BATCH_SIZE / sys->mtu), 1u);
+#else
+    const unsigned batch = 1;
+#endif
 
-    block_t *pkt = block_Alloc(sys->mtu);
+    block_t *pkt = block_Alloc(batch * sys->mtu);
     if (unlikely(pkt == NULL))
     {   /* OOM - dequeue and discard one packet */
         char dummy;
@@ -239,16 +338,6 @@ static block_t *BlockUDP(stream_t *access, bool *restrict eof)
     const int trunc_flag = 0;
 #endif
 
-    struct iovec iov = {
-        .iov_base = pkt->p_buffer,
-        .iov_len = sys->mtu,
-    };
-    struct msghdr msg = {
-        .msg_iov = &iov,
-        .msg_iovlen = 1,
-        .msg_flags = trunc_flag,
-    };
-
     struct pollfd ufd[1];
 
     ufd[0].fd = sys->fd;
@@ -264,14 +353,77 @@ static block_t *BlockUDP(stream_t *access, bool *restrict eof)
             goto skip;
      }
 
-    ssize_t len = recvmsg(sys->fd, &msg, trunc_flag);
+#ifdef HAVE_RECVMMSG
+    for (unsigned i = 0; i < batch; i++)
+    {
+        sys->iov[i].iov_base = pkt->p_buffer + i * sys->mtu;
+        sys->iov[i].iov_len = sys->mtu;
+# ifdef SO_RXQ_OVFL
+        sys->msgs[i].msg_hdr.msg_controllen =
+            sys->msgs[i].msg_hdr.msg_control ? sizeof (sys->control[i]) : 0;
+# endif
+    }
 
-    if (len < 0)
+    int count = recvmmsg(sys->fd, sys->msgs, batch, MSG_DONTWAIT | trunc_flag,
+                         NULL);
+    if (count <= 0)
+        goto skip;
+
+    uint8_t *p = pkt->p_buffer;
+    size_t mtu = sys->mtu;
+
+    for (int i = 0; i < count; i++)
     {
-skip:
-        block_Release(pkt);
-        return NULL;
+        size_t len = sys->msgs[i].msg_len;
+
+        if (sys->msgs[i].msg_hdr.msg_flags & trunc_flag)
+        {
+            msg_Err(access, "%zu bytes packet truncated (MTU was %zu)",
+                    len, sys->mtu);
+            pkt->i_flags |= BLOCK_FLAG_CORRUPTED;
+            sys->truncated++;
+            mtu = __MAX(mtu, len);
+            len = sys->mtu;
+        }
+
+        /* Pack the datagrams */
+        if (p != sys->iov[i].iov_base)
+            memmove(p, sys->iov[i].iov_base, len);
+        p += len;
+    }
+
+    pkt->i_buffer = p - pkt->p_buffer;
+    sys->mtu = mtu;
+    sys->datagrams += count;
+    CheckDrops(access, &sys->msgs[count - 1].msg_hdr);
+
+    if ((unsigned)count * 4 < batch)
+    {   /* Do not hold a large buffer for a few datagrams */
+        block_t *copy = block_Alloc(pkt->i_buffer);
+        if (likely(copy != NULL))
+        {
+            memcpy(copy->p_buffer, pkt->p_buffer, pkt->i_buffer);
+            copy->i_flags = pkt->i_flags;
+            block_Release(pkt);
+            pkt = copy;
+        }
     }
+    return pkt;
+#else
+    struct iovec iov = {
+        .iov_base = pkt->p_buffer,
+        .iov_len = sys->mtu,
+    };
+    struct msghdr msg = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_flags = trunc_flag,
+    };
+
+    ssize_t len = recvmsg(sys->fd, &msg, trunc_flag);
+
+    if (len < 0)
+        goto skip;
 
     if (msg.msg_flags & trunc_flag)
     {
@@ -284,4 +436,9 @@ skip:
         pkt->i_buffer = len;
 
     return pkt;
+#endif
+
+skip:
+    block_Release(pkt);
+    return NULL;
 }
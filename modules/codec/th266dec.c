@@ -0,0 +1,1057 @@
+/*****************************************************************************
+ * th266dec.c: Tencent th266dec decoder (VVC/H.266) module
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * Based on dav1d.c by: Adrien Maglo <magsoft@videolan.org>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_codec.h>
+#include <vlc_atomic.h>
+
+#include <assert.h>
+
+#include <th266dec_api.h>
+
+#include "../video_chroma/copy.h"
+#include "../packetizer/hxxx_nal.h"
+#include "../packetizer/vvc_nal.h"
+
+/****************************************************************************
+ * Local prototypes
+ ****************************************************************************/
+static int OpenDecoder(vlc_object_t *);
+static void CloseDecoder(vlc_object_t *);
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+
+#define THREADS_TEXT N_("Threads")
+#define THREADS_LONGTEXT N_( "Max number of threads used for decoding, default 0=auto" )
+#define THREAD_BUDGET_TEXT N_("Threads budget")
+#define THREAD_BUDGET_LONGTEXT N_( "Max number of threads used by all the " \
+    "decoders running at the same time, when the number of threads is " \
+    "automatic, default 0=number of CPUs" )
+#define ZERO_COPY_TEXT N_("Zero-copy output")
+#define ZERO_COPY_LONGTEXT N_( "Output the pictures of the decoder without " \
+    "copying them, when their memory layout allows it. This only saves the " \
+    "copy when the video output converts or filters the pictures: " \
+    "displays rendering directly copy them to their own buffers." )
+#define COPY_THREADS_TEXT N_("Copy threads")
+#define COPY_THREADS_LONGTEXT N_( "Number of threads used to convert the " \
+    "8 bits pictures stored in 16 bits words by the decoder." )
+#define SKIP_FRAMES_TEXT N_("Skip frames when late")
+#define SKIP_FRAMES_LONGTEXT N_( "Pictures not decoded when " \
+    "the decoding is late: the non-reference pictures, and also the " \
+    "pictures of the upper temporal sub-layers when very late." )
+
+static const int skip_frames_values[] = { 0, 1, 2 };
+static const char *const skip_frames_texts[] = {
+    N_("None"), N_("Non-reference pictures"),
+    N_("Non-reference pictures and temporal sub-layers") };
+
+vlc_module_begin ()
+    set_shortname("th266dec")
+    set_description(N_("th266dec VVC/H.266 video decoder"))
+    set_capability("video decoder", 100)
+    set_callbacks(OpenDecoder, CloseDecoder)
+    set_category(CAT_INPUT)
+    set_subcategory(SUBCAT_INPUT_VCODEC)
+
+    add_integer("th266dec-threads", 0,
+                THREADS_TEXT, THREADS_LONGTEXT, false)
+    add_integer("th266dec-thread-budget", 0,
+                THREAD_BUDGET_TEXT, THREAD_BUDGET_LONGTEXT, true)
+    add_bool("th266dec-zero-copy", true,
+             ZERO_COPY_TEXT, ZERO_COPY_LONGTEXT, true)
+    add_integer_with_range("th266dec-copy-threads", 1, 1, 16,
+                COPY_THREADS_TEXT, COPY_THREADS_LONGTEXT, true)
+    add_integer("th266dec-skip-frames", 1,
+                SKIP_FRAMES_TEXT, SKIP_FRAMES_LONGTEXT, true)
+        change_integer_list(skip_frames_values, skip_frames_texts)
+vlc_module_end ()
+
+/* The decoder outputs pictures in display order without timestamps: the
+ * timestamps of the input blocks are kept sorted and the earliest one is
+ * given to each output picture. */
+#define TH266DEC_MAX_PENDING_TS 64
+
+/* Maximum number of decoder pictures held by the video output. Above this,
+ * pictures are copied so that the decoder does not run out of buffers. */
+#define TH266DEC_MAX_EXPORTED 8
+
+/* Number of consecutive late pictures before skipping the non-reference
+ * pictures, then the upper temporal sub-layers */
+#define TH266DEC_LATE_SKIP_NONREF    4
+#define TH266DEC_LATE_SKIP_SUBLAYERS 12
+
+/* Automatic threads count: one thread per slice of this many luma samples.
+ * Without tiles, subpictures nor wavefront, the parallelism only comes from
+ * the frames pipelining and the loop filters, so fewer threads are useful. */
+#define TH266DEC_SAMPLES_PER_THREAD (1920 * 1080 / 8)
+#define TH266DEC_MAX_SERIAL_THREADS 8
+#define TH266DEC_MAX_THREADS        64
+
+/* Size of the samples in the decoder buffers */
+#if defined(TH266DEC_FIX_8BIT_OUTPUT) && TH266DEC_FIX_8BIT_OUTPUT
+# define TH266DEC_SAMPLE_SIZE(bitdepth) (2)
+#else
+# define TH266DEC_SAMPLE_SIZE(bitdepth) ((bitdepth) > 8 ? 2 : 1)
+#endif
+
+/*****************************************************************************
+ * th266dec_instance_t: decoder instance
+ *****************************************************************************
+ * The instance is shared with the pictures exported without copy, as they
+ * can outlive the decoder (and the module).
+ *****************************************************************************/
+typedef struct
+{
+    TH266DecDecoderHandle handle;
+    atomic_uint           refs;
+    atomic_uint           exported; /* pictures held by the video output */
+
+    vlc_mutex_t           lock;
+    bool                  closed;
+    picture_sys_t        *released; /* pictures to give back to the decoder */
+} th266dec_instance_t;
+
+struct picture_sys_t
+{
+    TH266DecOutputPicture img;
+    th266dec_instance_t  *inst;
+    picture_sys_t        *next;
+};
+
+/* Thread converting a slice of the pictures */
+typedef struct
+{
+    vlc_thread_t   thread;
+    vlc_sem_t      start;
+    decoder_sys_t *sys;
+    unsigned       slice;
+} th266dec_copy_worker_t;
+
+/*****************************************************************************
+ * decoder_sys_t: th266dec decoder descriptor
+ *****************************************************************************/
+struct decoder_sys_t
+{
+    TH266DecConfig       config;
+    unsigned             budget_threads; /* taken from the process budget */
+    th266dec_instance_t *inst;
+    bool                 b_zero_copy;
+
+    /* 16 to 8 bits conversion, the decoder thread converts the first slice */
+    unsigned                copy_threads;
+    th266dec_copy_worker_t *copy_workers;
+    vlc_sem_t               copy_done;
+    struct
+    {
+        picture_t     *dst;
+        const uint8_t *src[3];
+        size_t         src_pitch[3];
+        unsigned       width;
+        unsigned       height;
+        bool           quit;
+    } copy_job;
+
+    date_t   pts;
+    mtime_t  pending_ts[TH266DEC_MAX_PENDING_TS];
+    unsigned pending_count;
+
+    /* Late pictures skipping */
+    int      i_skip_frames;
+    mtime_t  i_late_threshold;
+    unsigned i_late_frames;
+    uint8_t  i_skip_tid; /* skip TemporalId >= i_skip_tid, 0 if disabled */
+
+    /* Statistics */
+    uint64_t i_exported;
+    uint64_t i_exported_bytes;
+    uint64_t i_copied;
+    uint64_t i_skipped;
+};
+
+static const struct
+{
+    vlc_fourcc_t         i_chroma;
+    TH266DecChromaFormat i_chroma_id;
+    uint8_t              i_bitdepth;
+} chroma_table[] =
+{
+    {VLC_CODEC_GREY, kTH266DecChromaFormat400, 8},
+    {VLC_CODEC_I420, kTH266DecChromaFormat420, 8},
+    {VLC_CODEC_I422, kTH266DecChromaFormat422, 8},
+    {VLC_CODEC_I444, kTH266DecChromaFormat444, 8},
+
+    {VLC_CODEC_I420_10L, kTH266DecChromaFormat420, 10},
+    {VLC_CODEC_I422_10L, kTH266DecChromaFormat422, 10},
+    {VLC_CODEC_I444_10L, kTH266DecChromaFormat444, 10},
+};
+
+static vlc_fourcc_t FindVlcChroma(const TH266DecOutputPicture *img)
+{
+    for (unsigned int i = 0; i < ARRAY_SIZE(chroma_table); i++)
+        if (chroma_table[i].i_chroma_id == img->header.chroma_format &&
+            chroma_table[i].i_bitdepth == img->planes[0].bit_depth)
+            return chroma_table[i].i_chroma;
+
+    return 0;
+}
+
+/****************************************************************************
+ * Timestamps reordering
+ ****************************************************************************/
+static void PushTimestamp(decoder_sys_t *p_sys, mtime_t ts)
+{
+    if (ts <= VLC_TS_INVALID)
+        return;
+
+    /* Drop the earliest timestamp if the decoder swallowed pictures */
+    if (p_sys->pending_count == TH266DEC_MAX_PENDING_TS)
+    {
+        memmove(&p_sys->pending_ts[0], &p_sys->pending_ts[1],
+                (TH266DEC_MAX_PENDING_TS - 1) * sizeof(mtime_t));
+        p_sys->pending_count--;
+    }
+
+    unsigned i = p_sys->pending_count;
+    while (i > 0 && p_sys->pending_ts[i - 1] > ts)
+    {
+        p_sys->pending_ts[i] = p_sys->pending_ts[i - 1];
+        i--;
+    }
+    p_sys->pending_ts[i] = ts;
+    p_sys->pending_count++;
+}
+
+static mtime_t PopTimestamp(decoder_sys_t *p_sys)
+{
+    mtime_t ts = VLC_TS_INVALID;
+
+    if (p_sys->pending_count > 0)
+    {
+        ts = p_sys->pending_ts[0];
+        p_sys->pending_count--;
+        memmove(&p_sys->pending_ts[0], &p_sys->pending_ts[1],
+                p_sys->pending_count * sizeof(mtime_t));
+    }
+
+    /* Interpolate missing timestamps from the frame rate */
+    if (ts > VLC_TS_INVALID)
+        date_Set(&p_sys->pts, ts);
+    else if (date_Get(&p_sys->pts) > VLC_TS_INVALID)
+        ts = date_Get(&p_sys->pts);
+    date_Increment(&p_sys->pts, 1);
+
+    return ts;
+}
+
+/****************************************************************************
+ * Late pictures skipping
+ ****************************************************************************/
+static void UpdateLateFrames(decoder_t *dec, const block_t *block)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    if (block->i_pts <= VLC_TS_INVALID ||
+        (block->i_flags & BLOCK_FLAG_PREROLL))
+        return;
+
+    mtime_t i_display_date = decoder_GetDisplayDate(dec, block->i_pts);
+    if (i_display_date > VLC_TS_INVALID &&
+        i_display_date + p_sys->i_late_threshold <= mdate())
+        p_sys->i_late_frames++;
+    else
+        p_sys->i_late_frames = 0;
+}
+
+/* Gets the NAL type and TemporalId of the first slice of the picture */
+static bool GetPictureNAL(const block_t *block, uint8_t *pi_type, uint8_t *pi_tid)
+{
+    hxxx_iterator_ctx_t it;
+    const uint8_t *p_nal;
+    size_t i_nal;
+
+    hxxx_iterator_init(&it, block->p_buffer, block->i_buffer, 0);
+    while (hxxx_annexb_iterate_next(&it, &p_nal, &i_nal))
+    {
+        if (i_nal < 2)
+            continue;
+        *pi_type = vvc_getNALType(p_nal);
+        if (vvc_isVCL(*pi_type))
+        {
+            *pi_tid = vvc_getNALTemporalId(p_nal);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Non-reference pictures can be skipped without breaking the decoding of
+ * the others. So can all the pictures of the upper temporal sub-layers,
+ * as they are never referenced by the lower ones, until the next random
+ * access point. */
+static bool SkipPicture(decoder_t *dec, const block_t *block)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+    uint8_t i_type, i_tid;
+
+    if (!GetPictureNAL(block, &i_type, &i_tid))
+        return false;
+
+    if (vvc_isRAP(i_type))
+    {
+        p_sys->i_skip_tid = 0;
+        return false;
+    }
+
+    /* References of this picture may have been skipped */
+    if (p_sys->i_skip_tid > 0 && i_tid >= p_sys->i_skip_tid)
+        return true;
+
+    const bool b_preroll = block->i_flags & BLOCK_FLAG_PREROLL;
+    if (!dec->b_frame_drop_allowed || p_sys->i_skip_frames <= 0 ||
+        (!b_preroll && p_sys->i_late_frames <= TH266DEC_LATE_SKIP_NONREF))
+        return false;
+
+    /* Flagged by the packetizer from ph_non_ref_pic_flag */
+    if (block->i_flags & BLOCK_FLAG_TYPE_B)
+        return true;
+
+    if (p_sys->i_skip_frames > 1 && !b_preroll && i_tid > 0 &&
+        p_sys->i_late_frames > TH266DEC_LATE_SKIP_SUBLAYERS)
+    {
+        msg_Warn(dec, "Too late, skipping temporal sub-layers %u and above "
+                 "until the next random access point", i_tid);
+        p_sys->i_skip_tid = i_tid;
+        return true;
+    }
+
+    return false;
+}
+
+/* NAL units kept when skipping a picture: they set the decoder state used by
+ * the following pictures */
+static bool IsDecoderStateNAL(uint8_t i_type)
+{
+    return (i_type >= VVC_NAL_OPI && i_type <= VVC_NAL_SUFF_APS) ||
+           i_type == VVC_NAL_EOS || i_type == VVC_NAL_EOB;
+}
+
+/* Removes the picture from its access unit: its slices, picture header and
+ * SEI go, while the parameter sets stay. The APS in particular are often sent
+ * again with each picture, and the next reference pictures may use them. */
+static void StripPicture(block_t *block)
+{
+    const uint8_t *p_tail = &block->p_buffer[block->i_buffer];
+    const uint8_t *p_nal = startcode_FindAnnexB(block->p_buffer, p_tail);
+    const uint8_t *p_start = p_nal;
+    uint8_t *p_out = block->p_buffer;
+
+    /* Each NAL unit is copied with its start code, zero_byte included */
+    if (p_nal != NULL && p_nal > block->p_buffer && p_nal[-1] == 0)
+        p_start--;
+
+    while (p_nal != NULL)
+    {
+        const uint8_t *p_next = startcode_FindAnnexB(p_nal + 3, p_tail);
+        const uint8_t *p_end = p_next != NULL ? p_next : p_tail;
+
+        if (p_next != NULL && p_next[-1] == 0)
+            p_end--;
+
+        if (p_end - p_nal >= 5 &&
+            IsDecoderStateNAL(vvc_getNALType(&p_nal[3])))
+        {
+            memmove(p_out, p_start, p_end - p_start);
+            p_out += p_end - p_start;
+        }
+        p_start = p_end;
+        p_nal = p_next;
+    }
+    block->i_buffer = p_out - block->p_buffer;
+}
+
+/****************************************************************************
+ * Threads
+ ****************************************************************************/
+
+/* Threads used by all the decoders with an automatic threads count */
+static vlc_mutex_t thread_budget_lock = VLC_STATIC_MUTEX;
+static unsigned thread_budget_used;
+
+static unsigned AcquireThreads(unsigned wanted, unsigned budget)
+{
+    vlc_mutex_lock(&thread_budget_lock);
+    unsigned available = budget > thread_budget_used
+                       ? budget - thread_budget_used : 0;
+    /* Always decode, even when the budget is exhausted */
+    unsigned threads = __MAX(__MIN(wanted, available), 1);
+    thread_budget_used += threads;
+    vlc_mutex_unlock(&thread_budget_lock);
+    return threads;
+}
+
+static void ReleaseThreads(unsigned threads)
+{
+    vlc_mutex_lock(&thread_budget_lock);
+    assert(thread_budget_used >= threads);
+    thread_budget_used -= threads;
+    vlc_mutex_unlock(&thread_budget_lock);
+}
+
+/* Gets the picture size and partitioning from the parameter sets of the
+ * extradata, if any */
+static bool GetStreamParallelism(decoder_t *dec, unsigned *pi_width,
+                                 unsigned *pi_height, bool *pb_partitioned)
+{
+    vvc_sequence_parameter_set_t *p_sps = NULL;
+    vvc_picture_parameter_set_t *p_pps = NULL;
+    hxxx_iterator_ctx_t it;
+    const uint8_t *p_nal;
+    size_t i_nal;
+
+    hxxx_iterator_init(&it, dec->fmt_in.p_extra, dec->fmt_in.i_extra, 0);
+    while ((p_sps == NULL || p_pps == NULL) &&
+           hxxx_annexb_iterate_next(&it, &p_nal, &i_nal))
+    {
+        if (i_nal < 2)
+            continue;
+        const uint8_t i_type = vvc_getNALType(p_nal);
+        if (i_type == VVC_NAL_SPS && p_sps == NULL)
+            p_sps = vvc_decode_sps(p_nal, i_nal, true);
+        else if (i_type == VVC_NAL_PPS && p_pps == NULL)
+            p_pps = vvc_decode_pps(p_nal, i_nal, true);
+    }
+
+    bool b_ret = false;
+    if (p_sps != NULL && p_pps != NULL)
+    {
+        unsigned i_vw, i_vh, i_tiles, i_subpics;
+        bool b_wpp;
+        vvc_get_picture_size(p_sps, p_pps, pi_width, pi_height, &i_vw, &i_vh);
+        if (vvc_get_parallelism(p_sps, p_pps, &i_tiles, &i_subpics, &b_wpp))
+        {
+            *pb_partitioned = i_tiles > 1 || i_subpics > 1 || b_wpp;
+            b_ret = true;
+        }
+    }
+
+    if (p_sps != NULL)
+        vvc_rbsp_release_sps(p_sps);
+    if (p_pps != NULL)
+        vvc_rbsp_release_pps(p_pps);
+    return b_ret;
+}
+
+/* Number of threads worth using for the stream */
+static unsigned GetStreamThreads(decoder_t *dec, unsigned cpus)
+{
+    unsigned i_width = dec->fmt_in.video.i_width;
+    unsigned i_height = dec->fmt_in.video.i_height;
+    bool b_partitioned = true; /* unknown, do not limit */
+
+    if (GetStreamParallelism(dec, &i_width, &i_height, &b_partitioned))
+        msg_Dbg(dec, "%ux%u stream%s", i_width, i_height,
+                b_partitioned ? " with tiles, subpictures or wavefront" : "");
+
+    if (i_width == 0 || i_height == 0)
+        return cpus;
+
+    uint64_t i_threads = ((uint64_t)i_width * i_height
+                          + TH266DEC_SAMPLES_PER_THREAD - 1)
+                       / TH266DEC_SAMPLES_PER_THREAD;
+    if (!b_partitioned)
+        i_threads = __MIN(i_threads, TH266DEC_MAX_SERIAL_THREADS);
+    return VLC_CLIP(i_threads, 1, cpus);
+}
+
+/****************************************************************************
+ * Decoder instance
+ ****************************************************************************/
+static th266dec_instance_t *InstanceNew(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+    th266dec_instance_t *inst = malloc(sizeof(*inst));
+    if (unlikely(inst == NULL))
+        return NULL;
+
+    if (TH266DecCreateDecoder(&p_sys->config, &inst->handle) != kTH266DecOk)
+    {
+        msg_Err(dec, "Could not open the th266dec decoder");
+        free(inst);
+        return NULL;
+    }
+    atomic_init(&inst->refs, 1);
+    atomic_init(&inst->exported, 0);
+    vlc_mutex_init(&inst->lock);
+    inst->closed = false;
+    inst->released = NULL;
+
+    /* Out of band parameter sets, in Annex B format */
+    if (dec->fmt_in.i_extra > 3)
+    {
+        TH266DecDataPacket packet = {
+            .has_complete_nal = true,
+            .data_buf = dec->fmt_in.p_extra,
+            .data_size = dec->fmt_in.i_extra,
+        };
+        if (TH266DecPushData(inst->handle, &packet) != kTH266DecOk)
+            msg_Warn(dec, "Failed to push the codec extradata");
+    }
+    return inst;
+}
+
+static void InstanceRelease(th266dec_instance_t *inst)
+{
+    if (atomic_fetch_sub(&inst->refs, 1) != 1)
+        return;
+
+    assert(inst->released == NULL);
+    TH266DecCloseDecoder(inst->handle);
+    vlc_mutex_destroy(&inst->lock);
+    free(inst);
+}
+
+/* Gives the pictures released by the video output back to the decoder.
+ * The decoder API is not thread-safe, so this is done by the decoder thread
+ * only, before using the decoder. */
+static void InstanceRecycle(th266dec_instance_t *inst)
+{
+    vlc_mutex_lock(&inst->lock);
+    picture_sys_t *sys = inst->released;
+    inst->released = NULL;
+    vlc_mutex_unlock(&inst->lock);
+
+    while (sys != NULL)
+    {
+        picture_sys_t *next = sys->next;
+        TH266DecReleaseOutputPicture(inst->handle, &sys->img);
+        free(sys);
+        sys = next;
+    }
+}
+
+static void InstanceClose(th266dec_instance_t *inst)
+{
+    /* Late pictures will be released directly to the unused decoder */
+    vlc_mutex_lock(&inst->lock);
+    inst->closed = true;
+    vlc_mutex_unlock(&inst->lock);
+
+    InstanceRecycle(inst);
+    InstanceRelease(inst);
+}
+
+static void ReleasePicture(picture_t *pic)
+{
+    picture_sys_t *sys = pic->p_sys;
+    th266dec_instance_t *inst = sys->inst;
+
+    free(pic);
+
+    vlc_mutex_lock(&inst->lock);
+    if (inst->closed)
+    {
+        TH266DecReleaseOutputPicture(inst->handle, &sys->img);
+        free(sys);
+    }
+    else
+    {
+        sys->next = inst->released;
+        inst->released = sys;
+    }
+    vlc_mutex_unlock(&inst->lock);
+
+    atomic_fetch_sub(&inst->exported, 1);
+    InstanceRelease(inst);
+}
+
+/****************************************************************************
+ * Pictures output
+ ****************************************************************************/
+static void CopyPlane(uint8_t *dst, size_t dst_pitch,
+                      const uint8_t *src, size_t src_pitch,
+                      size_t width, unsigned height)
+{
+    for (unsigned y = 0; y < height; y++)
+    {
+        memcpy(dst, src, width);
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+}
+
+static void *CopyThread(void *data)
+{
+    th266dec_copy_worker_t *worker = data;
+    decoder_sys_t *p_sys = worker->sys;
+
+    for (;;)
+    {
+        vlc_sem_wait(&worker->start);
+        if (p_sys->copy_job.quit)
+            break;
+        Copy16To8_P_to_P(p_sys->copy_job.dst, p_sys->copy_job.src,
+                         p_sys->copy_job.src_pitch, p_sys->copy_job.width,
+                         p_sys->copy_job.height, worker->slice,
+                         p_sys->copy_threads);
+        vlc_sem_post(&p_sys->copy_done);
+    }
+    return NULL;
+}
+
+static void StartCopyThreads(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+    unsigned count = var_InheritInteger(dec, "th266dec-copy-threads");
+
+    p_sys->copy_threads = 1;
+    if (count <= 1)
+        return;
+    p_sys->copy_workers = vlc_obj_calloc(VLC_OBJECT(dec), count - 1,
+                                         sizeof(*p_sys->copy_workers));
+    if (unlikely(p_sys->copy_workers == NULL))
+        return;
+
+    vlc_sem_init(&p_sys->copy_done, 0);
+    for (unsigned i = 0; i < count - 1; i++)
+    {
+        th266dec_copy_worker_t *worker = &p_sys->copy_workers[i];
+
+        worker->sys = p_sys;
+        worker->slice = i + 1;
+        vlc_sem_init(&worker->start, 0);
+        if (vlc_clone(&worker->thread, CopyThread, worker,
+                      VLC_THREAD_PRIORITY_VIDEO))
+        {
+            vlc_sem_destroy(&worker->start);
+            break;
+        }
+        p_sys->copy_threads++;
+    }
+}
+
+static void StopCopyThreads(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    if (p_sys->copy_workers == NULL)
+        return;
+
+    p_sys->copy_job.quit = true;
+    for (unsigned i = 0; i < p_sys->copy_threads - 1; i++)
+    {
+        th266dec_copy_worker_t *worker = &p_sys->copy_workers[i];
+
+        vlc_sem_post(&worker->start);
+        vlc_join(worker->thread, NULL);
+        vlc_sem_destroy(&worker->start);
+    }
+    vlc_sem_destroy(&p_sys->copy_done);
+}
+
+/* Converts the 8 bits samples stored in 16 bits words, split in slices
+ * across the copy threads */
+static void NarrowPicture(decoder_t *dec, picture_t *pic,
+                          const TH266DecOutputPicture *img)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    for (int i = 0; i < 3; i++)
+    {
+        p_sys->copy_job.src[i] = img->planes[i].pix;
+        p_sys->copy_job.src_pitch[i] = img->planes[i].stride;
+    }
+    p_sys->copy_job.dst = pic;
+    p_sys->copy_job.width = img->header.width;
+    p_sys->copy_job.height = img->header.height;
+
+    for (unsigned i = 0; i < p_sys->copy_threads - 1; i++)
+        vlc_sem_post(&p_sys->copy_workers[i].start);
+
+    Copy16To8_P_to_P(pic, p_sys->copy_job.src, p_sys->copy_job.src_pitch,
+                     img->header.width, img->header.height,
+                     0, p_sys->copy_threads);
+
+    for (unsigned i = 0; i < p_sys->copy_threads - 1; i++)
+        vlc_sem_wait(&p_sys->copy_done);
+}
+
+/* Wraps a decoder picture, it will be given back to the decoder when the
+ * last reference to the picture is released. */
+static picture_t *ExportPicture(decoder_t *dec, const TH266DecOutputPicture *img,
+                                const vlc_chroma_description_t *dsc)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+    th266dec_instance_t *inst = p_sys->inst;
+
+    picture_sys_t *sys = malloc(sizeof(*sys));
+    if (unlikely(sys == NULL))
+        return NULL;
+    sys->img = *img;
+    sys->inst = inst;
+    sys->next = NULL;
+
+    picture_resource_t res = {
+        .p_sys = sys,
+        .pf_destroy = ReleasePicture,
+    };
+    size_t i_bytes = 0;
+    for (unsigned i = 0; i < dsc->plane_count; i++)
+    {
+        res.p[i].p_pixels = img->planes[i].pix;
+        res.p[i].i_lines  = (img->header.height * dsc->p[i].h.num
+                             + dsc->p[i].h.den - 1) / dsc->p[i].h.den;
+        res.p[i].i_pitch  = img->planes[i].stride;
+        i_bytes += res.p[i].i_lines * res.p[i].i_pitch;
+    }
+
+    picture_t *pic = picture_NewFromResource(&dec->fmt_out.video, &res);
+    if (unlikely(pic == NULL))
+    {
+        free(sys);
+        return NULL;
+    }
+
+    atomic_fetch_add(&inst->refs, 1);
+    atomic_fetch_add(&inst->exported, 1);
+    p_sys->i_exported++;
+    p_sys->i_exported_bytes += i_bytes;
+    return pic;
+}
+
+static picture_t *NewPicture(decoder_t *dec, const TH266DecOutputPicture *img,
+                             bool *exported)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+    video_format_t *v = &dec->fmt_out.video;
+    const vlc_fourcc_t i_chroma = FindVlcChroma(img);
+
+    if (i_chroma == 0)
+    {
+        msg_Err(dec, "Unsupported chroma format %d (%d bits)",
+                img->header.chroma_format, img->planes[0].bit_depth);
+        return NULL;
+    }
+
+    if (v->i_visible_width != img->header.width ||
+        v->i_visible_height != img->header.height)
+        msg_Dbg(dec, "dimension change! %ux%u -> %ux%u",
+                v->i_visible_width, v->i_visible_height,
+                img->header.width, img->header.height);
+
+    v->i_visible_width  = img->header.width;
+    v->i_visible_height = img->header.height;
+    v->i_width  = (img->header.width + 0x7F) & ~0x7F;
+    v->i_height = (img->header.height + 0x7F) & ~0x7F;
+
+    if( !v->i_sar_num || !v->i_sar_den )
+    {
+        v->i_sar_num = 1;
+        v->i_sar_den = 1;
+    }
+
+    v->projection_mode = dec->fmt_in.video.projection_mode;
+    v->multiview_mode = dec->fmt_in.video.multiview_mode;
+    v->pose = dec->fmt_in.video.pose;
+    dec->fmt_out.video.i_chroma = dec->fmt_out.i_codec = i_chroma;
+
+    if (decoder_UpdateVideoFormat(dec) != VLC_SUCCESS)
+        return NULL;
+
+    const vlc_chroma_description_t *dsc = vlc_fourcc_GetChromaDescription(i_chroma);
+    const unsigned pixel_size = img->planes[0].bit_depth > 8 ? 2 : 1;
+    const unsigned sample_size = TH266DEC_SAMPLE_SIZE(img->planes[0].bit_depth);
+
+    if (p_sys->b_zero_copy && pixel_size == sample_size &&
+        atomic_load(&p_sys->inst->exported) < TH266DEC_MAX_EXPORTED)
+    {
+        picture_t *pic = ExportPicture(dec, img, dsc);
+        if (likely(pic != NULL))
+        {
+            *exported = true;
+            return pic;
+        }
+    }
+
+    picture_t *pic = decoder_NewPicture(dec);
+    if (unlikely(pic == NULL))
+        return NULL;
+
+    if (pixel_size != sample_size)
+        NarrowPicture(dec, pic, img);
+    else
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        unsigned width  = (img->header.width * dsc->p[i].w.num
+                           + dsc->p[i].w.den - 1) / dsc->p[i].w.den;
+        unsigned height = (img->header.height * dsc->p[i].h.num
+                           + dsc->p[i].h.den - 1) / dsc->p[i].h.den;
+
+        CopyPlane(pic->p[i].p_pixels, pic->p[i].i_pitch,
+                  img->planes[i].pix, img->planes[i].stride,
+                  __MIN(width * pixel_size, (unsigned)pic->p[i].i_pitch),
+                  __MIN(height, (unsigned)pic->p[i].i_lines));
+    }
+    p_sys->i_copied++;
+    return pic;
+}
+
+static void OutputPictures(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+    th266dec_instance_t *inst = p_sys->inst;
+    TH266DecOutputPicture img;
+
+    while (TH266DecGetOutputPicture(inst->handle, &img) == kTH266DecOk)
+    {
+        mtime_t ts = PopTimestamp(p_sys);
+        bool exported = false;
+        picture_t *pic = NewPicture(dec, &img, &exported);
+
+        if (!exported)
+            TH266DecReleaseOutputPicture(inst->handle, &img);
+        if (pic == NULL)
+            continue;
+
+        pic->b_progressive = true; /* codec does not support interlacing */
+        pic->date = ts;
+        decoder_QueueVideo(dec, pic);
+    }
+}
+
+/****************************************************************************
+ * Flush: clears decoder between seeks
+ ****************************************************************************/
+static void FlushDecoder(decoder_t *dec)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    /* th266dec has no flush API, restart the decoder instead */
+    if (p_sys->inst != NULL)
+        InstanceClose(p_sys->inst);
+    p_sys->inst = InstanceNew(dec);
+
+    p_sys->pending_count = 0;
+    date_Set(&p_sys->pts, VLC_TS_INVALID);
+
+    p_sys->i_late_frames = 0;
+    p_sys->i_skip_tid = 0;
+}
+
+/****************************************************************************
+ * Decode: the whole thing
+ ****************************************************************************/
+static int Decode(decoder_t *dec, block_t *block)
+{
+    decoder_sys_t *p_sys = dec->p_sys;
+    th266dec_instance_t *inst = p_sys->inst;
+    TH266DecStatus status;
+
+    if (unlikely(inst == NULL))
+    {
+        if (block)
+            block_Release(block);
+        return VLCDEC_ECRITICAL;
+    }
+
+    InstanceRecycle(inst);
+
+    if (block == NULL) /* Drain */
+    {
+        TH266DecNotifyEndOfStream(inst->handle);
+        do
+        {
+            status = TH266DecDecodeFrame(inst->handle);
+            OutputPictures(dec);
+        }
+        while (status == kTH266DecOk);
+
+        if (status != kTH266DecEndOfStream)
+            msg_Err(dec, "Failed to flush decoder, status %d", status);
+
+        /* The decoder cannot be fed again after the end of stream */
+        FlushDecoder(dec);
+        return VLCDEC_SUCCESS;
+    }
+
+    if (block->i_flags & (BLOCK_FLAG_DISCONTINUITY|BLOCK_FLAG_CORRUPTED))
+    {
+        if (block->i_flags & BLOCK_FLAG_CORRUPTED)
+        {
+            block_Release(block);
+            return VLCDEC_SUCCESS;
+        }
+        date_Set(&p_sys->pts, VLC_TS_INVALID);
+    }
+
+    UpdateLateFrames(dec, block);
+    if (SkipPicture(dec, block))
+    {
+        p_sys->i_skipped++;
+        StripPicture(block);
+        if (block->i_buffer == 0)
+        {
+            block_Release(block);
+            return VLCDEC_SUCCESS;
+        }
+    }
+    else
+        PushTimestamp(p_sys, block->i_pts > VLC_TS_INVALID ? block->i_pts
+                                                            : block->i_dts);
+
+    TH266DecDataPacket packet = {
+        .has_complete_nal = true,
+        .data_buf = block->p_buffer,
+        .data_size = block->i_buffer,
+    };
+    status = TH266DecPushData(inst->handle, &packet);
+    block_Release(block);
+    if (status != kTH266DecOk)
+    {
+        msg_Err(dec, "Failed to push data, status %d", status);
+        return VLCDEC_SUCCESS;
+    }
+
+    status = TH266DecDecodeFrame(inst->handle);
+    if (status != kTH266DecOk && status != kTH266DecNeedMoreData)
+    {
+        msg_Warn(dec, "Failed to decode data, status %d", status);
+        return VLCDEC_SUCCESS;
+    }
+
+    OutputPictures(dec);
+    return VLCDEC_SUCCESS;
+}
+
+/*****************************************************************************
+ * OpenDecoder: probe the decoder
+ *****************************************************************************/
+static int OpenDecoder(vlc_object_t *p_this)
+{
+    decoder_t *dec = (decoder_t *)p_this;
+
+    if (dec->fmt_in.i_codec != VLC_CODEC_VVC)
+        return VLC_EGENERIC;
+
+    decoder_sys_t *p_sys = vlc_obj_calloc(p_this, 1, sizeof(*p_sys));
+    if (!p_sys)
+        return VLC_ENOMEM;
+    dec->p_sys = p_sys;
+
+    int i_threads = var_InheritInteger(p_this, "th266dec-threads");
+    if (i_threads <= 0)
+    {
+        const unsigned cpus = vlc_GetCPUCount();
+        int i_budget = var_InheritInteger(p_this, "th266dec-thread-budget");
+        if (i_budget <= 0)
+            i_budget = cpus;
+        const unsigned wanted = __MIN(GetStreamThreads(dec, cpus),
+                                      TH266DEC_MAX_THREADS);
+        p_sys->budget_threads = AcquireThreads(wanted, i_budget);
+        if (p_sys->budget_threads < wanted)
+            msg_Dbg(p_this, "threads budget of %d reached, using %u threads "
+                    "instead of %u", i_budget, p_sys->budget_threads, wanted);
+        i_threads = p_sys->budget_threads;
+    }
+    p_sys->config.num_threads = VLC_CLIP(i_threads, 1, TH266DEC_MAX_THREADS);
+    p_sys->config.enable_multi_thread = p_sys->config.num_threads > 1;
+    p_sys->b_zero_copy = var_InheritBool(p_this, "th266dec-zero-copy");
+    p_sys->i_skip_frames = var_InheritInteger(p_this, "th266dec-skip-frames");
+
+    p_sys->inst = InstanceNew(dec);
+    if (p_sys->inst == NULL)
+    {
+        if (p_sys->budget_threads > 0)
+            ReleaseThreads(p_sys->budget_threads);
+        return VLC_EGENERIC;
+    }
+
+    StartCopyThreads(dec);
+
+    msg_Dbg(p_this, "Using th266dec with %d threads (%u copy threads)%s",
+            p_sys->config.num_threads, p_sys->copy_threads,
+            p_sys->b_zero_copy ? ", exporting its pictures" : "");
+
+    if (dec->fmt_in.video.i_frame_rate && dec->fmt_in.video.i_frame_rate_base)
+    {
+        date_Init(&p_sys->pts, dec->fmt_in.video.i_frame_rate,
+                  dec->fmt_in.video.i_frame_rate_base);
+        /* Half of the frame duration */
+        p_sys->i_late_threshold = CLOCK_FREQ / 2
+            * dec->fmt_in.video.i_frame_rate_base / dec->fmt_in.video.i_frame_rate;
+    }
+    else
+    {
+        date_Init(&p_sys->pts, 25, 1);
+        p_sys->i_late_threshold = 20000;
+    }
+    date_Set(&p_sys->pts, VLC_TS_INVALID);
+
+    dec->pf_decode = Decode;
+    dec->pf_flush = FlushDecoder;
+
+    dec->fmt_out.video.i_width = dec->fmt_in.video.i_width;
+    dec->fmt_out.video.i_height = dec->fmt_in.video.i_height;
+    dec->fmt_out.i_codec = VLC_CODEC_I420;
+
+    if (dec->fmt_in.video.i_sar_num > 0 && dec->fmt_in.video.i_sar_den > 0) {
+        dec->fmt_out.video.i_sar_num = dec->fmt_in.video.i_sar_num;
+        dec->fmt_out.video.i_sar_den = dec->fmt_in.video.i_sar_den;
+    }
+    dec->fmt_out.video.primaries   = dec->fmt_in.video.primaries;
+    dec->fmt_out.video.transfer    = dec->fmt_in.video.transfer;
+    dec->fmt_out.video.space       = dec->fmt_in.video.space;
+    dec->fmt_out.video.b_color_range_full = dec->fmt_in.video.b_color_range_full;
+
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * CloseDecoder: decoder destruction
+ *****************************************************************************/
+static void CloseDecoder(vlc_object_t *p_this)
+{
+    decoder_t *dec = (decoder_t *)p_this;
+    decoder_sys_t *p_sys = dec->p_sys;
+
+    /* The exported pictures are still copied by the video output when the
+     * display renders directly, see its own log */
+    msg_Dbg(dec, "%"PRIu64" pictures exported (%"PRIu64" MiB), "
+            "%"PRIu64" pictures copied, %"PRIu64" pictures skipped",
+            p_sys->i_exported, p_sys->i_exported_bytes >> 20,
+            p_sys->i_copied, p_sys->i_skipped);
+
+    StopCopyThreads(dec);
+    if (p_sys->inst != NULL)
+        InstanceClose(p_sys->inst);
+    if (p_sys->budget_threads > 0)
+        ReleaseThreads(p_sys->budget_threads);
+}
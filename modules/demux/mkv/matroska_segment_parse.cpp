@@ -35,6 +35,7 @@ extern "C" {
 #include "../xiph.h"
 #include "../windows_audio_commons.h"
 #include "../mp4/libmp4.h"
+#include "../../packetizer/vvc_nal.h"
 }
 
 #include <vlc_codecs.h>
@@ -1643,6 +1644,17 @@ bool matroska_segment_c::TrackInit( mkv_track_t * p_tk )
 
             fill_extra_data( vars.p_tk, 0 );
         }
+        S_CASE("V_MPEGI/ISO/VVC") {
+            vars.p_tk->fmt.i_codec = VLC_CODEC_VVC;
+
+            /* CodecPrivate is a VvcDecoderConfigurationRecord: the packetizer
+             * extracts the parameter sets and converts blocks to AnnexB */
+            if( !vvc_isvvcC( vars.p_tk->p_extra_data, vars.p_tk->i_extra_data ) )
+                msg_Warn( vars.p_demuxer, "missing or invalid VVC CodecPrivate" );
+
+            vars.p_fmt->b_packetized = false;
+            fill_extra_data( vars.p_tk, 0 );
+        }
         S_CASE("V_QUICKTIME") {
             ONLY_FMT(VIDEO);
             if( vars.p_tk->i_extra_data > 4 )
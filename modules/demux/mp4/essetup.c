@@ -602,6 +602,37 @@ int SetupVideoES( demux_t *p_demux, mp4_track_t *p_track, MP4_Box_t *p_sample )
             break;
         }
 
+        /* vvc1/vvi1: send vvcC, samples are converted to AnnexB
+         * by the packetizer */
+        case VLC_FOURCC( 'v', 'v', 'c', '1' ):
+        case VLC_FOURCC( 'v', 'v', 'i', '1' ):
+        {
+            MP4_Box_t *p_vvcC = MP4_BoxGet( p_sample, "vvcC" );
+
+            p_track->fmt.i_codec = VLC_CODEC_VVC;
+            p_track->fmt.b_packetized = false;
+
+            /* Skip the FullBox version and flags */
+            const MP4_Box_data_binary_t *p_bin = p_vvcC ? p_vvcC->data.p_binary : NULL;
+            if( p_bin && p_bin->i_blob > 4 &&
+                ((const uint8_t *)p_bin->p_blob)[0] == 0 )
+            {
+                p_track->fmt.p_extra = malloc( p_bin->i_blob - 4 );
+                if( p_track->fmt.p_extra )
+                {
+                    p_track->fmt.i_extra = p_bin->i_blob - 4;
+                    memcpy( p_track->fmt.p_extra,
+                            &((const uint8_t *)p_bin->p_blob)[4],
+                            p_track->fmt.i_extra );
+                }
+            }
+            else
+            {
+                msg_Err( p_demux, "missing vvcC" );
+            }
+            break;
+        }
+
         case ATOM_vp08:
         case ATOM_vp09:
         case ATOM_vp10:
@@ -35,12 +35,14 @@
 #include <vlc_codec.h>
 #include "../packetizer/hevc_nal.h" /* definitions, inline helpers */
 #include "../packetizer/h264_nal.h" /* definitions, inline helpers */
+#include "../packetizer/vvc_nal.h" /* definitions, inline helpers */
 
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
 static int  OpenH264 ( vlc_object_t * );
 static int  OpenHEVC ( vlc_object_t * );
+static int  OpenVVC  ( vlc_object_t * );
 static void Close( vlc_object_t * );
 
 #define FPS_TEXT N_("Frames per Second")
@@ -68,6 +70,17 @@ vlc_module_begin ()
         set_callbacks( OpenHEVC, Close )
         add_shortcut( "hevc", "h265" )
 
+    add_submodule()
+        set_shortname( "VVC")
+        set_category( CAT_INPUT )
+        set_subcategory( SUBCAT_INPUT_DEMUX )
+        set_description( N_("VVC/H.266 video demuxer" ) )
+        set_capability( "demux", 6 )
+        set_section( N_("VVC/H.266 video demuxer" ), NULL )
+        add_float( "vvc-fps", 0.0, FPS_TEXT, FPS_LONGTEXT, true )
+        set_callbacks( OpenVVC, Close )
+        add_shortcut( "vvc", "h266" )
+
 vlc_module_end ()
 
 /*****************************************************************************
@@ -109,6 +122,12 @@ typedef struct
     bool b_pps;
 } h264_probe_ctx_t;
 
+typedef struct
+{
+    bool b_sps;
+    bool b_pps;
+} vvc_probe_ctx_t;
+
 static int ProbeHEVC( const uint8_t *p_peek, size_t i_peek, void *p_priv )
 {
     hevc_probe_ctx_t *p_ctx = (hevc_probe_ctx_t *) p_priv;
@@ -168,6 +187,58 @@ static int ProbeHEVC( const uint8_t *p_peek, size_t i_peek, void *p_priv )
     return 0; /* Probe more */
 }
 
+static int ProbeVVC( const uint8_t *p_peek, size_t i_peek, void *p_priv )
+{
+    vvc_probe_ctx_t *p_ctx = (vvc_probe_ctx_t *) p_priv;
+
+    if( i_peek < 2 )
+        return -1;
+
+    if( (p_peek[0] & 0xC0) || (p_peek[1] & 0x07) == 0 ) /* forbidden/reserved bits, temporal id */
+        return -1;
+
+    const uint8_t i_type = vvc_getNALType( p_peek );
+    const uint8_t i_layer = vvc_getNALLayer( p_peek );
+
+    if( i_layer != 0 )
+        return -1;
+
+    switch( i_type )
+    {
+        case VVC_NAL_SPS:
+            p_ctx->b_sps = true;
+            break;
+        case VVC_NAL_PPS:
+            if( !p_ctx->b_sps )
+                return -1;
+            p_ctx->b_pps = true;
+            break;
+        case VVC_NAL_IDR_W_RADL:
+        case VVC_NAL_IDR_N_LP:
+        case VVC_NAL_CRA:
+        case VVC_NAL_GDR: /* Key Frame */
+            if( p_ctx->b_sps && p_ctx->b_pps )
+                return 1;
+            return -1;
+        case VVC_NAL_AUD:
+            if( i_peek < H26X_MIN_PEEK ||
+                p_peek[3] != 0 || p_peek[4] != 0 ) /* Must prefix another NAL */
+                return -1;
+            break;
+        case VVC_NAL_OPI:
+        case VVC_NAL_DCI:
+        case VVC_NAL_VPS:
+        case VVC_NAL_PREF_APS:
+        case VVC_NAL_PH:
+        case VVC_NAL_PREF_SEI:
+            break;
+        default:
+            return -1; /* See 7.4.2.4.4 for sequence order */
+    }
+
+    return 0; /* Probe more */
+}
+
 static int ProbeH264( const uint8_t *p_peek, size_t i_peek, void *p_priv )
 {
     h264_probe_ctx_t *p_ctx = (h264_probe_ctx_t *) p_priv;
@@ -392,6 +463,16 @@ static int OpenHEVC( vlc_object_t * p_this )
                         &ctx, rgi_psz_ext, rgi_psz_mime );
 }
 
+static int OpenVVC( vlc_object_t * p_this )
+{
+    vvc_probe_ctx_t ctx = { 0, 0 };
+    const char *rgi_psz_ext[] = { ".h266", ".266", ".vvc", ".bin", ".bit", ".raw", NULL };
+    const char *rgi_psz_mime[] = { "video/h266", "video/vvc", "video/VVC", NULL };
+
+    return GenericOpen( (demux_t*)p_this, "vvc", VLC_CODEC_VVC, ProbeVVC,
+                        &ctx, rgi_psz_ext, rgi_psz_mime );
+}
+
 /*****************************************************************************
  * Close: frees unused data
  *****************************************************************************/
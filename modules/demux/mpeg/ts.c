@@ -1667,6 +1667,59 @@ static void ParsePESDataChain( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes )
     }
 }
 
+/* Large PES, such as the access units of UHD video, span thousands of TS
+ * packets. Instead of chaining them and gathering the chain at the end, their
+ * payloads are copied as they come into a single block sized from the PES
+ * length, or from the size of the previous PES of the stream. */
+#define PES_FLAT_GATHER_MIN (64 * 1024)
+
+static block_t *PESGatherNew( ts_stream_t *p_pes, block_t *p_pkt )
+{
+    size_t i_size = p_pes->gather.i_data_size;
+    if( i_size == 0 )
+        i_size = p_pes->gather.i_last_size + p_pes->gather.i_last_size / 4;
+    if( i_size < PES_FLAT_GATHER_MIN || i_size < p_pkt->i_buffer )
+        return p_pkt;
+
+    block_t *p_data = block_Alloc( i_size );
+    if( unlikely(p_data == NULL) )
+        return p_pkt;
+
+    memcpy( p_data->p_buffer, p_pkt->p_buffer, p_pkt->i_buffer );
+    p_data->i_buffer = p_pkt->i_buffer;
+    p_data->i_flags = p_pkt->i_flags;
+    block_Release( p_pkt );
+    p_pes->gather.b_flat = true;
+    return p_data;
+}
+
+static bool PESGatherAppend( ts_stream_t *p_pes, block_t *p_pkt )
+{
+    block_t *p_data = p_pes->gather.p_data;
+    const size_t i_used = p_data->i_buffer;
+    const size_t i_room = p_data->p_start + p_data->i_size
+                        - (p_data->p_buffer + i_used);
+
+    if( i_room < p_pkt->i_buffer )
+    {
+        p_data = block_Realloc( p_data, 0,
+                                __MAX( 2 * i_used, i_used + p_pkt->i_buffer ) );
+        p_pes->gather.p_data = p_data;
+        if( unlikely(p_data == NULL) )
+        {
+            block_Release( p_pkt );
+            return false;
+        }
+        p_data->i_buffer = i_used;
+        p_pes->gather.pp_last = &p_data->p_next;
+    }
+
+    memcpy( &p_data->p_buffer[i_used], p_pkt->p_buffer, p_pkt->i_buffer );
+    p_data->i_buffer += p_pkt->i_buffer;
+    block_Release( p_pkt );
+    return true;
+}
+
 static bool PushPESBlock( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt, bool b_unit_start )
 {
     bool b_ret = false;
@@ -1678,8 +1731,10 @@ static bool PushPESBlock( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt, bool
         /* Flush the pes from pid */
         p_pes->gather.p_data = NULL;
         p_pes->gather.i_data_size = 0;
+        p_pes->gather.i_last_size = p_pes->gather.i_gathered;
         p_pes->gather.i_gathered = 0;
         p_pes->gather.pp_last = &p_pes->gather.p_data;
+        p_pes->gather.b_flat = false;
         ParsePESDataChain( p_demux, pid, p_datachain );
         b_ret = true;
     }
@@ -1694,8 +1749,25 @@ static bool PushPESBlock( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt, bool
         return b_ret;
     }
 
-    block_ChainLastAppend( &p_pes->gather.pp_last, p_pkt );
-    p_pes->gather.i_gathered += p_pkt->i_buffer;
+    const size_t i_payload = p_pkt->i_buffer;
+    if( p_pes->gather.b_flat )
+    {
+        if( !PESGatherAppend( p_pes, p_pkt ) )
+        {
+            /* drop the whole PES */
+            p_pes->gather.i_data_size = p_pes->gather.i_gathered = 0;
+            p_pes->gather.pp_last = &p_pes->gather.p_data;
+            p_pes->gather.b_flat = false;
+            return b_ret;
+        }
+    }
+    else
+    {
+        if( p_pes->gather.p_data == NULL )
+            p_pkt = PESGatherNew( p_pes, p_pkt );
+        block_ChainLastAppend( &p_pes->gather.pp_last, p_pkt );
+    }
+    p_pes->gather.i_gathered += i_payload;
 
     if( p_pes->gather.i_data_size > 0 &&
         p_pes->gather.i_gathered >= p_pes->gather.i_data_size )
@@ -1841,6 +1913,7 @@ static inline void FlushESBuffer( ts_stream_t *p_pes )
         block_ChainRelease( p_pes->gather.p_data );
         p_pes->gather.p_data = NULL;
         p_pes->gather.pp_last = &p_pes->gather.p_data;
+        p_pes->gather.b_flat = false;
         p_pes->gather.i_saved = 0;
     }
     if( p_pes->p_proc )
@@ -2215,16 +2288,27 @@ static int IsVideoEnd( ts_pid_t *p_pid )
 {
     /* jump to near end of PES packet */
     block_t *p = p_pid->u.p_stream->gather.p_data;
-    if( !p || !p->p_next )
-        return 0;
-    while( p->p_next->p_next )
-        p = p->p_next;
-    if( p->p_next->i_buffer > 4)
-        p = p->p_next;
-
-    /* extract last bytes */
     uint8_t tail[ 188 ];
-    const int i_tail = block_ChainExtract( p, tail, sizeof( tail ) );
+    int i_tail;
+
+    if( p && p_pid->u.p_stream->gather.b_flat )
+    {
+        /* gathered in a single block */
+        i_tail = __MIN( p->i_buffer, sizeof( tail ) );
+        memcpy( tail, &p->p_buffer[p->i_buffer - i_tail], i_tail );
+    }
+    else
+    {
+        if( !p || !p->p_next )
+            return 0;
+        while( p->p_next->p_next )
+            p = p->p_next;
+        if( p->p_next->i_buffer > 4)
+            p = p->p_next;
+
+        /* extract last bytes */
+        i_tail = block_ChainExtract( p, tail, sizeof( tail ) );
+    }
     if( i_tail < 4 )
         return 0;
 
@@ -2250,9 +2334,10 @@ static void PCRCheckDTS( demux_t *p_demux, ts_pmt_t *p_pmt, mtime_t i_pcr)
         if( p_pes->gather.i_data_size != 0 )
             continue;
 
-        /* check only MPEG2, H.264 and VC-1 */
+        /* check only MPEG2, H.264, VVC and VC-1 */
         if( p_es->fmt.i_codec != VLC_CODEC_MPGV &&
             p_es->fmt.i_codec != VLC_CODEC_H264 &&
+            p_es->fmt.i_codec != VLC_CODEC_VVC &&
             p_es->fmt.i_codec != VLC_CODEC_VC1 )
             continue;
 
@@ -1432,6 +1432,9 @@ static void PIDFillFormat( demux_t *p_demux, ts_stream_t *p_pes,
     case 0x24:  /* HEVC */
         es_format_Change( fmt, VIDEO_ES, VLC_CODEC_HEVC );
         break;
+    case 0x33:  /* VVC */
+        es_format_Change( fmt, VIDEO_ES, VLC_CODEC_VVC );
+        break;
     case 0x42:  /* CAVS (Chinese AVS) */
         es_format_Change( fmt, VIDEO_ES, VLC_CODEC_CAVS );
         break;
@@ -285,6 +285,8 @@ ts_stream_t *ts_stream_New( demux_t *p_demux, ts_pmt_t *p_program )
     pes->gather.i_gathered = 0;
     pes->gather.p_data = NULL;
     pes->gather.pp_last = &pes->gather.p_data;
+    pes->gather.b_flat = false;
+    pes->gather.i_last_size = 0;
     pes->gather.i_saved = 0;
     pes->b_broken_PUSI_conformance = false;
     pes->b_always_receive = false;
@@ -123,6 +123,8 @@ struct ts_stream_t
         size_t      i_gathered;
         block_t     *p_data;
         block_t     **pp_last;
+        bool        b_flat;      /* payloads copied into the single p_data */
+        size_t      i_last_size; /* size of the previous PES */
         uint8_t     saved[5];
         size_t      i_saved;
     } gather;
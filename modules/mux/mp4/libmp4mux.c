@@ -27,6 +27,7 @@
 #include "libmp4mux.h"
 #include "../demux/mp4/libmp4.h" /* flags */
 #include "../packetizer/hevc_nal.h"
+#include "../packetizer/vvc_nal.h"
 #include "../packetizer/h264_nal.h" /* h264_AnnexB_get_spspps */
 #include "../packetizer/hxxx_nal.h"
 
@@ -656,6 +657,93 @@ static bo_t *GetHvcCTag(es_format_t *p_fmt, bool b_completeness)
     return hvcC;
 }
 
+static bo_t *GetVvcCTag(es_format_t *p_fmt, bool b_completeness)
+{
+    /* Generate vvcC box matching iso/iec 14496-15 6th edition */
+    bo_t *vvcC = box_full_new("vvcC", 0, 0);
+    if(!vvcC || !p_fmt->i_extra)
+        return vvcC;
+
+    /* Extradata is already a VvcDecoderConfigurationRecord */
+    if(vvc_isvvcC(p_fmt->p_extra, p_fmt->i_extra))
+    {
+        (void) bo_add_mem(vvcC, p_fmt->i_extra, p_fmt->p_extra);
+        return vvcC;
+    }
+
+    struct vvc_dcr_params params = { };
+    const uint8_t *p_nal;
+    size_t i_nal;
+
+    hxxx_iterator_ctx_t it;
+    hxxx_iterator_init(&it, p_fmt->p_extra, p_fmt->i_extra, 0);
+    while(hxxx_annexb_iterate_next(&it, &p_nal, &i_nal))
+    {
+        if(i_nal < 2 || i_nal > UINT16_MAX)
+            continue;
+
+        switch (vvc_getNALType(p_nal))
+        {
+            case VVC_NAL_VPS:
+                if(params.i_vps_count != VVC_DCR_VPS_COUNT)
+                {
+                    params.p_vps[params.i_vps_count] = p_nal;
+                    params.rgi_vps[params.i_vps_count] = i_nal;
+                    params.i_vps_count++;
+                }
+                break;
+            case VVC_NAL_SPS:
+                if(params.i_sps_count != VVC_DCR_SPS_COUNT)
+                {
+                    params.p_sps[params.i_sps_count] = p_nal;
+                    params.rgi_sps[params.i_sps_count] = i_nal;
+                    params.i_sps_count++;
+                }
+                break;
+            case VVC_NAL_PPS:
+                if(params.i_pps_count != VVC_DCR_PPS_COUNT)
+                {
+                    params.p_pps[params.i_pps_count] = p_nal;
+                    params.rgi_pps[params.i_pps_count] = i_nal;
+                    params.i_pps_count++;
+                }
+                break;
+            case VVC_NAL_PREF_APS:
+                if(params.i_apspref_count != VVC_DCR_APS_COUNT)
+                {
+                    params.p_apspref[params.i_apspref_count] = p_nal;
+                    params.rgi_apspref[params.i_apspref_count] = i_nal;
+                    params.i_apspref_count++;
+                }
+                break;
+            case VVC_NAL_PREF_SEI:
+                if(params.i_seipref_count != VVC_DCR_SEI_COUNT)
+                {
+                    params.p_seipref[params.i_seipref_count] = p_nal;
+                    params.rgi_seipref[params.i_seipref_count] = i_nal;
+                    params.i_seipref_count++;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    size_t i_dcr;
+    uint8_t *p_dcr = vvc_create_dcr(&params, 4, b_completeness, &i_dcr);
+    if(!p_dcr)
+    {
+        bo_free(vvcC);
+        return NULL;
+    }
+
+    bo_add_mem(vvcC, i_dcr, p_dcr);
+    free(p_dcr);
+
+    return vvcC;
+}
+
 static bo_t *GetWaveFormatExTag(es_format_t *p_fmt, const char *tag)
 {
     bo_t *box = box_new(tag);
@@ -953,6 +1041,8 @@ static bo_t *GetVideBox(vlc_object_t *p_obj, mp4mux_trackinfo_t *p_track, bool b
     /* FIXME: find a way to know if no non-VCL units are in the stream (->hvc1)
      * see 14496-15 8.4.1.1.1 */
     case VLC_CODEC_HEVC: memcpy(fcc, "hev1", 4); break;
+    /* Parameter sets can also be found in the samples (->vvi1) */
+    case VLC_CODEC_VVC: memcpy(fcc, "vvi1", 4); break;
     case VLC_CODEC_YV12: memcpy(fcc, "yv12", 4); break;
     case VLC_CODEC_YUYV: memcpy(fcc, "YUY2", 4); break;
     default:
@@ -1016,6 +1106,11 @@ static bo_t *GetVideBox(vlc_object_t *p_obj, mp4mux_trackinfo_t *p_track, bool b
         /* Write HvcC without forcing VPS/SPS/PPS/SEI array_completeness */
         box_gather(vide, GetHvcCTag(&p_track->fmt, false));
         break;
+
+    case VLC_CODEC_VVC:
+        /* Write vvcC without forcing array_completeness */
+        box_gather(vide, GetVvcCTag(&p_track->fmt, false));
+        break;
     }
 
     return vide;
@@ -1764,6 +1859,13 @@ bool mp4mux_CanMux(vlc_object_t *p_obj, const es_format_t *p_fmt)
             return false;
         }
         break;
+    case VLC_CODEC_VVC:
+        if(!p_fmt->i_extra && p_obj)
+        {
+            msg_Err(p_obj, "VVC muxing from AnnexB source without parameter sets is unsupported");
+            return false;
+        }
+        break;
     case VLC_CODEC_SUBT:
         if(p_obj)
             msg_Warn(p_obj, "subtitle track added like in .mov (even when creating .mp4)");
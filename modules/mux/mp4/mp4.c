@@ -566,6 +566,7 @@ static block_t * BlockDequeue(sout_input_t *p_input, mp4_stream_t *p_stream)
     {
         case VLC_CODEC_H264:
         case VLC_CODEC_HEVC:
+        case VLC_CODEC_VVC:
             p_block = hxxx_AnnexB_to_xVC(p_block, 4);
             break;
         case VLC_CODEC_SUBT:
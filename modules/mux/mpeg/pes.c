@@ -38,6 +38,8 @@
 #include "pes.h"
 #include "bits.h"
 
+#include "../../packetizer/vvc_nal.h"
+
 /** PESHeader, write a pes header
  * \param i_es_size length of payload data. (Must be < PES_PAYLOAD_SIZE_MAX
  *                  unless the conditions for unbounded PES packets are met)
@@ -288,6 +290,63 @@ static inline int PESHeader( uint8_t *p_hdr, mtime_t i_pts, mtime_t i_dts,
     }
 }
 
+/* VVC AU delimiter must be the first NAL unit of the access unit, before
+ * the parameter sets prepended to keyframes. Adds one when missing. */
+static block_t *VVCSetupAccessUnit( block_t *p_es, const es_format_t *p_fmt )
+{
+    const uint8_t *p = p_es->p_buffer;
+    size_t i_aud = 0;
+    bool b_aud = false;
+    bool b_irap = false;
+    unsigned i_nal = 0;
+
+    /* Lookup the leading AUD and the first VCL NAL unit type */
+    for( size_t i = 2; i + 2 < p_es->i_buffer; i++ )
+    {
+        if( p[i-2] != 0 || p[i-1] != 0 || p[i] != 1 )
+            continue;
+
+        const uint8_t i_nal_type = vvc_getNALType( &p[i+1] );
+        if( i_nal++ == 0 )
+            b_aud = ( i_nal_type == VVC_NAL_AUD );
+        else if( b_aud && i_aud == 0 )
+            i_aud = ( i > 2 && p[i-3] == 0 ) ? i - 3 : i - 2;
+
+        if( vvc_isVCL( i_nal_type ) )
+        {
+            b_irap = vvc_isRAP( i_nal_type );
+            break;
+        }
+        i += 2;
+    }
+
+    if( b_aud && i_aud == 0 )
+        i_aud = p_es->i_buffer;
+
+    if( (p_es->i_flags & BLOCK_FLAG_TYPE_I) && p_fmt->i_extra )
+    {
+        p_es = block_Realloc( p_es, p_fmt->i_extra, p_es->i_buffer );
+        memmove( p_es->p_buffer, &p_es->p_buffer[p_fmt->i_extra], i_aud );
+        memcpy( &p_es->p_buffer[i_aud], p_fmt->p_extra, p_fmt->i_extra );
+    }
+
+    if( !b_aud )
+    {
+        p_es = block_Realloc( p_es, 7, p_es->i_buffer );
+        p_es->p_buffer[0] = 0x00;
+        p_es->p_buffer[1] = 0x00;
+        p_es->p_buffer[2] = 0x00;
+        p_es->p_buffer[3] = 0x01;
+        p_es->p_buffer[4] = 0x00; /* layer 0 */
+        p_es->p_buffer[5] = (VVC_NAL_AUD << 3) | 0x01;
+        /* aud_irap_or_gdr_flag, aud_pic_type 2 (I, P and B slices),
+         * rbsp_stop_one_bit */
+        p_es->p_buffer[6] = (b_irap ? 0x80 : 0x00) | 0x28;
+    }
+
+    return p_es;
+}
+
 /** EStoPES, encapsulate an elementary stream block into PES packet(s)
  * each with a maximal payload size of @i_max_pes_size@.
  *
@@ -355,6 +414,9 @@ void EStoPES ( block_t **pp_pes,
         memcpy( p_es->p_buffer, p_fmt->p_extra, p_fmt->i_extra );
     }
 
+    if( p_fmt->i_codec == VLC_CODEC_VVC )
+        p_es = VVCSetupAccessUnit( p_es, p_fmt );
+
     if( p_fmt->i_codec == VLC_CODEC_H264 )
     {
         unsigned offset=2;
@@ -331,6 +331,7 @@ static void UpdateServiceType( uint8_t *pi_service_cat, uint8_t *pi_service_type
             break;
 
         case 0x24: /* HEVC */
+        case 0x33: /* VVC */
         case 0x10: /* MPEG4 */
         case 0x1b: /* H264 */
         case 0xA0: /* private */
@@ -756,6 +757,10 @@ int FillPMTESParams( ts_mux_standard standard, const es_format_t *fmt,
         ts->i_stream_type = 0x24;
         pes->i_stream_id = 0xe0;
         break;
+    case VLC_CODEC_VVC:
+        ts->i_stream_type = 0x33;
+        pes->i_stream_id = 0xe0;
+        break;
     case VLC_CODEC_H264:
         ts->i_stream_type = 0x1b;
         pes->i_stream_id = 0xe0;
@@ -0,0 +1,832 @@
+/*****************************************************************************
+ * vvc_nal.c: VVC/H.266 NAL helpers
+ *****************************************************************************
+ * Copyright © 2020 VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "vvc_nal.h"
+#include "hxxx_nal.h"
+
+#include <vlc_common.h>
+#include <vlc_bits.h>
+
+typedef uint8_t  nal_u1_t;
+typedef uint8_t  nal_u2_t;
+typedef uint8_t  nal_u3_t;
+typedef uint8_t  nal_u4_t;
+typedef uint8_t  nal_u6_t;
+typedef uint8_t  nal_u7_t;
+typedef uint8_t  nal_u8_t;
+typedef uint32_t nal_ue_t;
+
+struct vvc_sequence_parameter_set_t
+{
+    nal_u4_t sps_seq_parameter_set_id;
+    nal_u4_t sps_video_parameter_set_id;
+    nal_u3_t sps_max_sublayers_minus1;
+    nal_u2_t sps_chroma_format_idc;
+    nal_u2_t sps_log2_ctu_size_minus5;
+    nal_u1_t sps_ptl_dpb_hrd_params_present_flag;
+    struct
+    {
+        nal_u7_t general_profile_idc;
+        nal_u1_t general_tier_flag;
+        nal_u8_t general_level_idc;
+    } profile_tier_level;
+    nal_u1_t sps_gdr_enabled_flag;
+    nal_u1_t sps_ref_pic_resampling_enabled_flag;
+    nal_ue_t sps_pic_width_max_in_luma_samples;
+    nal_ue_t sps_pic_height_max_in_luma_samples;
+    nal_u1_t sps_subpic_info_present_flag;
+    nal_ue_t sps_num_subpics_minus1;
+    nal_ue_t sps_bitdepth_minus8;
+    nal_u1_t sps_entropy_coding_sync_enabled_flag;
+    struct
+    {
+        nal_ue_t dpb_max_dec_pic_buffering_minus1;
+        nal_ue_t dpb_max_num_reorder_pics;
+    } dpb_parameters; /* HighestTid */
+    /* incomplete */
+    bool b_partitioning_parsed; /* up to sps_entropy_coding_sync_enabled_flag */
+    bool b_dpb_parsed;
+};
+
+struct vvc_picture_parameter_set_t
+{
+    nal_u6_t pps_pic_parameter_set_id;
+    nal_u4_t pps_seq_parameter_set_id;
+    nal_u1_t pps_mixed_nalu_types_in_pic_flag;
+    nal_ue_t pps_pic_width_in_luma_samples;
+    nal_ue_t pps_pic_height_in_luma_samples;
+    nal_u1_t pps_conformance_window_flag;
+    struct
+    {
+        nal_ue_t left_offset;
+        nal_ue_t right_offset;
+        nal_ue_t top_offset;
+        nal_ue_t bottom_offset;
+    } conf_win;
+    nal_u1_t pps_no_pic_partition_flag;
+    nal_ue_t pps_num_subpics_minus1;
+    nal_u2_t pps_log2_ctu_size_minus5;
+    unsigned i_num_tile_columns; /* NumTileColumns */
+    unsigned i_num_tile_rows; /* NumTileRows */
+    /* incomplete */
+    bool b_partitioning_parsed; /* up to the tiles layout */
+};
+
+struct vvc_picture_header_t
+{
+    nal_u1_t ph_gdr_or_irap_pic_flag;
+    nal_u1_t ph_non_ref_pic_flag;
+    nal_u1_t ph_gdr_pic_flag;
+    nal_u1_t ph_inter_slice_allowed_flag;
+    nal_u1_t ph_intra_slice_allowed_flag;
+    nal_ue_t ph_pic_parameter_set_id;
+    /* incomplete */
+};
+
+/* Shortcut for retrieving vps/sps/pps id */
+bool vvc_get_xps_id(const uint8_t *p_buf, size_t i_buf, uint8_t *pi_id)
+{
+    if(i_buf < 3)
+        return false;
+    /* No need to lookup convert from emulation for that data */
+    uint8_t i_nal_type = vvc_getNALType(p_buf);
+    bs_t bs;
+    bs_init(&bs, &p_buf[2], i_buf - 2);
+    switch(i_nal_type)
+    {
+        case VVC_NAL_VPS:
+        case VVC_NAL_SPS:
+            *pi_id = bs_read( &bs, 4 ); /* VVC_VPS_ID_MAX == VVC_SPS_ID_MAX */
+            return true;
+        case VVC_NAL_PPS:
+            *pi_id = bs_read( &bs, 6 );
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool vvc_get_aps_id(const uint8_t *p_buf, size_t i_buf,
+                    uint8_t *pi_type, uint8_t *pi_id)
+{
+    if(i_buf < 3)
+        return false;
+    uint8_t i_nal_type = vvc_getNALType(p_buf);
+    if(i_nal_type != VVC_NAL_PREF_APS && i_nal_type != VVC_NAL_SUFF_APS)
+        return false;
+    bs_t bs;
+    bs_init(&bs, &p_buf[2], i_buf - 2);
+    *pi_type = bs_read( &bs, 3 );
+    *pi_id = bs_read( &bs, 5 );
+    return *pi_type <= VVC_APS_TYPE_MAX;
+}
+
+/* Returns the offset of num_of_arrays in a VvcDecoderConfigurationRecord,
+ * skipping the optional VvcPTLRecord, or 0 on error */
+static size_t get_vvcC_arrays_offset( const uint8_t *p_buf, size_t i_buf )
+{
+    size_t i_off = 1;
+    if( (p_buf[0] & 0x01) == 0 ) /* ptl_present_flag */
+        return i_off;
+
+    /* ols_idx, num_sublayers, constant_frame_rate, chroma_format_idc,
+     * bit_depth_minus8 */
+    if( i_buf < 4 )
+        return 0;
+    const uint8_t i_num_sublayers = (p_buf[2] >> 4) & 0x07;
+    i_off += 3;
+
+    /* VvcPTLRecord: num_bytes_constraint_info, profile, tier, level,
+     * then the constraint info */
+    if( i_buf < i_off + 3 )
+        return 0;
+    i_off += 3 + (p_buf[i_off] & 0x3F);
+    if( i_num_sublayers > 1 )
+    {
+        if( i_buf < i_off + 1 )
+            return 0;
+        const uint8_t i_present_flags = p_buf[i_off++];
+        for( uint8_t i = 0; i < i_num_sublayers - 1; i++ )
+            if( i_present_flags & (0x80 >> i) )
+                i_off++; /* sublayer_level_idc */
+    }
+    if( i_buf < i_off + 1 )
+        return 0;
+    i_off += 1 + 4 * p_buf[i_off]; /* ptl_num_sub_profiles */
+
+    /* max_picture_width, max_picture_height, avg_frame_rate */
+    i_off += 6;
+
+    return i_off;
+}
+
+/* Walks the NAL arrays, does check the whole struct integrity,
+ * and writes Annex B NAL to p_out if not NULL.
+ * Returns the Annex B size, or 0 on error */
+static size_t vvcC_to_AnnexB_NAL( const uint8_t *p_buf, size_t i_buf,
+                                  uint8_t *p_out )
+{
+    if( !vvc_isvvcC( p_buf, i_buf ) || vvc_getNALLengthSize( p_buf ) == 3 )
+        return 0;
+
+    const size_t i_off = get_vvcC_arrays_offset( p_buf, i_buf );
+    if( i_off == 0 || i_buf <= i_off )
+        return 0;
+
+    const uint8_t i_num_array = p_buf[i_off];
+    p_buf += i_off + 1; i_buf -= i_off + 1;
+
+    size_t i_total = 0;
+    for( uint8_t i = 0; i < i_num_array; i++ )
+    {
+        if( i_buf < 1 )
+            return 0;
+
+        const uint8_t i_nal_type = p_buf[0] & 0x1F;
+        uint16_t i_num_nalu = 1;
+        p_buf += 1; i_buf -= 1;
+
+        /* num_nalus is implied for decoding capability and operating point */
+        if( i_nal_type != VVC_NAL_DCI && i_nal_type != VVC_NAL_OPI )
+        {
+            if( i_buf < 2 )
+                return 0;
+            i_num_nalu = GetWBE( p_buf );
+            p_buf += 2; i_buf -= 2;
+        }
+
+        for( uint16_t j = 0; j < i_num_nalu; j++ )
+        {
+            if( i_buf < 2 )
+                return 0;
+
+            const uint16_t i_nalu_length = GetWBE( p_buf );
+            if( i_buf < (size_t)i_nalu_length + 2 )
+                return 0;
+
+            if( p_out )
+            {
+                memcpy( &p_out[i_total], annexb_startcode4, 4 );
+                memcpy( &p_out[i_total + 4], &p_buf[2], i_nalu_length );
+            }
+
+            i_total += 4 + i_nalu_length;
+            p_buf += 2 + i_nalu_length;
+            i_buf -= 2 + i_nalu_length;
+        }
+    }
+
+    return i_total;
+}
+
+uint8_t * vvc_vvcC_to_AnnexB_NAL( const uint8_t *p_buf, size_t i_buf,
+                                  size_t *pi_result, uint8_t *pi_nal_length_size )
+{
+    *pi_result = vvcC_to_AnnexB_NAL( p_buf, i_buf, NULL ); /* Does all checks */
+    if( *pi_result == 0 )
+        return NULL;
+
+    if( pi_nal_length_size )
+        *pi_nal_length_size = vvc_getNALLengthSize( p_buf );
+
+    uint8_t *p_ret = malloc( *pi_result );
+    if( !p_ret )
+    {
+        *pi_result = 0;
+        return NULL;
+    }
+
+    vvcC_to_AnnexB_NAL( p_buf, i_buf, p_ret );
+
+    return p_ret;
+}
+
+/* Ceil( Log2( v ) ) */
+static unsigned vvc_ceil_log2( uint32_t v )
+{
+    unsigned i_log2 = 0;
+    while( i_log2 < 32 && (UINT32_C(1) << i_log2) < v )
+        i_log2++;
+    return i_log2;
+}
+
+/* Skips remaining bits up to the next byte boundary,
+ * going through the emulation prevention handler */
+static void vvc_bs_align( bs_t *p_bs )
+{
+    if( !bs_aligned( p_bs ) )
+        bs_skip( p_bs, p_bs->i_left );
+}
+
+static void vvc_skip_general_constraints_info( bs_t *p_bs )
+{
+    if( bs_read1( p_bs ) ) /* gci_present_flag */
+    {
+        bs_skip( p_bs, 71 ); /* constraint flags and idc */
+        const uint8_t i_num_additional_bits = bs_read( p_bs, 8 );
+        bs_skip( p_bs, i_num_additional_bits );
+    }
+    vvc_bs_align( p_bs );
+}
+
+static bool vvc_parse_subpic_info( bs_t *p_bs, vvc_sequence_parameter_set_t *p_sps )
+{
+    p_sps->sps_num_subpics_minus1 = bs_read_ue( p_bs );
+    if( p_sps->sps_num_subpics_minus1 > VVC_SUBPICS_MAX - 1 )
+        return false;
+
+    const uint32_t i_ctb_size = 1U << (p_sps->sps_log2_ctu_size_minus5 + 5);
+    const uint32_t i_width = p_sps->sps_pic_width_max_in_luma_samples;
+    const uint32_t i_height = p_sps->sps_pic_height_max_in_luma_samples;
+    const unsigned i_bits_x = vvc_ceil_log2( (i_width + i_ctb_size - 1) / i_ctb_size );
+    const unsigned i_bits_y = vvc_ceil_log2( (i_height + i_ctb_size - 1) / i_ctb_size );
+    const unsigned i_num_subpics_minus1 = p_sps->sps_num_subpics_minus1;
+
+    if( i_num_subpics_minus1 > 0 )
+    {
+        const bool b_independent = bs_read1( p_bs ); /* sps_independent_subpics_flag */
+        const bool b_same_size = bs_read1( p_bs ); /* sps_subpic_same_size_flag */
+        for( unsigned i = 0; i <= i_num_subpics_minus1; i++ )
+        {
+            if( !b_same_size || i == 0 )
+            {
+                /* sps_subpic_ctu_top_left_x/y, sps_subpic_width/height_minus1 */
+                if( i > 0 && i_width > i_ctb_size )
+                    bs_skip( p_bs, i_bits_x );
+                if( i > 0 && i_height > i_ctb_size )
+                    bs_skip( p_bs, i_bits_y );
+                if( i < i_num_subpics_minus1 && i_width > i_ctb_size )
+                    bs_skip( p_bs, i_bits_x );
+                if( i < i_num_subpics_minus1 && i_height > i_ctb_size )
+                    bs_skip( p_bs, i_bits_y );
+            }
+            /* sps_subpic_treated_as_pic_flag,
+             * sps_loop_filter_across_subpic_enabled_flag */
+            if( !b_independent )
+                bs_skip( p_bs, 2 );
+        }
+    }
+
+    const nal_ue_t i_id_len_minus1 = bs_read_ue( p_bs ); /* sps_subpic_id_len_minus1 */
+    if( i_id_len_minus1 > 15 )
+        return false;
+    if( bs_read1( p_bs ) && /* sps_subpic_id_mapping_explicitly_signalled_flag */
+        bs_read1( p_bs ) ) /* sps_subpic_id_mapping_present_flag */
+        bs_skip( p_bs, (i_id_len_minus1 + 1) * (i_num_subpics_minus1 + 1) );
+
+    return true;
+}
+
+static bool vvc_parse_sequence_parameter_set_rbsp( bs_t *p_bs,
+                                                   vvc_sequence_parameter_set_t *p_sps )
+{
+    if( bs_remain( p_bs ) < 16 )
+        return false;
+
+    p_sps->sps_seq_parameter_set_id = bs_read( p_bs, 4 );
+    p_sps->sps_video_parameter_set_id = bs_read( p_bs, 4 );
+    p_sps->sps_max_sublayers_minus1 = bs_read( p_bs, 3 );
+    if( p_sps->sps_max_sublayers_minus1 > 6 )
+        return false;
+    p_sps->sps_chroma_format_idc = bs_read( p_bs, 2 );
+    p_sps->sps_log2_ctu_size_minus5 = bs_read( p_bs, 2 );
+    p_sps->sps_ptl_dpb_hrd_params_present_flag = bs_read1( p_bs );
+
+    if( p_sps->sps_ptl_dpb_hrd_params_present_flag )
+    {
+        /* profile_tier_level( 1, sps_max_sublayers_minus1 ) */
+        p_sps->profile_tier_level.general_profile_idc = bs_read( p_bs, 7 );
+        p_sps->profile_tier_level.general_tier_flag = bs_read1( p_bs );
+        p_sps->profile_tier_level.general_level_idc = bs_read( p_bs, 8 );
+        /* ptl_frame_only_constraint_flag, ptl_multilayer_enabled_flag */
+        bs_skip( p_bs, 2 );
+        vvc_skip_general_constraints_info( p_bs );
+
+        const unsigned i_max_sublayers_minus1 = p_sps->sps_max_sublayers_minus1;
+        uint8_t i_sublayer_level_present = 0;
+        for( unsigned i = 0; i < i_max_sublayers_minus1; i++ )
+            i_sublayer_level_present |= bs_read1( p_bs ) << i;
+        vvc_bs_align( p_bs ); /* ptl_reserved_zero_bit */
+        for( unsigned i = 0; i < i_max_sublayers_minus1; i++ )
+            if( i_sublayer_level_present & (1 << i) )
+                bs_skip( p_bs, 8 ); /* sublayer_level_idc */
+        const uint8_t i_num_sub_profiles = bs_read( p_bs, 8 );
+        bs_skip( p_bs, 32 * i_num_sub_profiles ); /* general_sub_profile_idc */
+    }
+
+    if( bs_remain( p_bs ) < 1 ) /* late fail */
+        return false;
+
+    /* Partitioning is only informative and is not required
+     * for a valid SPS, as the picture size is also signaled by the PPS */
+    p_sps->sps_gdr_enabled_flag = bs_read1( p_bs );
+    p_sps->sps_ref_pic_resampling_enabled_flag = bs_read1( p_bs );
+    if( p_sps->sps_ref_pic_resampling_enabled_flag )
+        bs_skip( p_bs, 1 ); /* sps_res_change_in_clvs_allowed_flag */
+    p_sps->sps_pic_width_max_in_luma_samples = bs_read_ue( p_bs );
+    p_sps->sps_pic_height_max_in_luma_samples = bs_read_ue( p_bs );
+    if( p_sps->sps_pic_width_max_in_luma_samples == 0 ||
+        p_sps->sps_pic_height_max_in_luma_samples == 0 ||
+        p_sps->sps_pic_width_max_in_luma_samples > UINT16_MAX ||
+        p_sps->sps_pic_height_max_in_luma_samples > UINT16_MAX )
+        return true;
+
+    if( bs_read1( p_bs ) ) /* sps_conformance_window_flag */
+    {
+        for( int i = 0; i < 4; i++ )
+            bs_read_ue( p_bs ); /* sps_conf_win_*_offset */
+    }
+
+    p_sps->sps_subpic_info_present_flag = bs_read1( p_bs );
+    if( p_sps->sps_subpic_info_present_flag &&
+        !vvc_parse_subpic_info( p_bs, p_sps ) )
+        return true;
+
+    p_sps->sps_bitdepth_minus8 = bs_read_ue( p_bs );
+    p_sps->sps_entropy_coding_sync_enabled_flag = bs_read1( p_bs );
+    if( bs_remain( p_bs ) < 1 || p_sps->sps_bitdepth_minus8 > 8 )
+        return true;
+    p_sps->b_partitioning_parsed = true;
+
+    bs_skip( p_bs, 1 ); /* sps_entry_point_offsets_present_flag */
+    bs_skip( p_bs, 4 ); /* sps_log2_max_pic_order_cnt_lsb_minus4 */
+    if( bs_read1( p_bs ) ) /* sps_poc_msb_cycle_flag */
+        bs_read_ue( p_bs ); /* sps_poc_msb_cycle_len_minus1 */
+    const uint8_t i_num_extra_ph_bytes = bs_read( p_bs, 2 );
+    bs_skip( p_bs, 8 * i_num_extra_ph_bytes ); /* sps_extra_ph_bit_present_flag */
+    const uint8_t i_num_extra_sh_bytes = bs_read( p_bs, 2 );
+    bs_skip( p_bs, 8 * i_num_extra_sh_bytes ); /* sps_extra_sh_bit_present_flag */
+
+    if( p_sps->sps_ptl_dpb_hrd_params_present_flag )
+    {
+        /* dpb_parameters( sps_max_sublayers_minus1, sps_sublayer_dpb_params_flag ) */
+        const unsigned i_max_sublayers_minus1 = p_sps->sps_max_sublayers_minus1;
+        bool b_sublayer_dpb_params = false;
+        if( i_max_sublayers_minus1 > 0 )
+            b_sublayer_dpb_params = bs_read1( p_bs );
+        for( unsigned i = b_sublayer_dpb_params ? 0 : i_max_sublayers_minus1;
+             i <= i_max_sublayers_minus1; i++ )
+        {
+            p_sps->dpb_parameters.dpb_max_dec_pic_buffering_minus1 = bs_read_ue( p_bs );
+            p_sps->dpb_parameters.dpb_max_num_reorder_pics = bs_read_ue( p_bs );
+            bs_read_ue( p_bs ); /* dpb_max_latency_increase_plus1 */
+        }
+        p_sps->b_dpb_parsed = bs_remain( p_bs ) > 0 &&
+            p_sps->dpb_parameters.dpb_max_dec_pic_buffering_minus1 < VVC_MAX_DPB_SIZE &&
+            p_sps->dpb_parameters.dpb_max_num_reorder_pics <=
+            p_sps->dpb_parameters.dpb_max_dec_pic_buffering_minus1;
+    }
+
+    /* parsing incomplete */
+
+    return true;
+}
+
+/* Reads the explicit tile sizes, then derives the tiles count with the
+ * last explicit size repeated over the remaining CTBs, or returns 0 */
+static unsigned vvc_count_tiles( bs_t *p_bs, unsigned i_num_exp, unsigned i_ctbs )
+{
+    unsigned i_count = 0;
+    unsigned i_size = 0;
+    for( unsigned i = 0; i < i_num_exp; i++ )
+    {
+        i_size = bs_read_ue( p_bs ) + 1; /* pps_tile_column/row_width_minus1 */
+        if( i_size > i_ctbs )
+            return 0;
+        i_ctbs -= i_size;
+        i_count++;
+    }
+    return i_count + (i_ctbs + i_size - 1) / i_size;
+}
+
+static bool vvc_parse_pic_parameter_set_rbsp( bs_t *p_bs,
+                                              vvc_picture_parameter_set_t *p_pps )
+{
+    if( bs_remain( p_bs ) < 14 )
+        return false;
+
+    p_pps->pps_pic_parameter_set_id = bs_read( p_bs, 6 );
+    p_pps->pps_seq_parameter_set_id = bs_read( p_bs, 4 );
+    p_pps->pps_mixed_nalu_types_in_pic_flag = bs_read1( p_bs );
+    p_pps->pps_pic_width_in_luma_samples = bs_read_ue( p_bs );
+    p_pps->pps_pic_height_in_luma_samples = bs_read_ue( p_bs );
+    if( p_pps->pps_pic_width_in_luma_samples == 0 ||
+        p_pps->pps_pic_height_in_luma_samples == 0 ||
+        p_pps->pps_pic_width_in_luma_samples > UINT16_MAX ||
+        p_pps->pps_pic_height_in_luma_samples > UINT16_MAX )
+        return false;
+
+    p_pps->pps_conformance_window_flag = bs_read1( p_bs );
+    if( p_pps->pps_conformance_window_flag )
+    {
+        p_pps->conf_win.left_offset = bs_read_ue( p_bs );
+        p_pps->conf_win.right_offset = bs_read_ue( p_bs );
+        p_pps->conf_win.top_offset = bs_read_ue( p_bs );
+        p_pps->conf_win.bottom_offset = bs_read_ue( p_bs );
+    }
+
+    if( bs_remain( p_bs ) < 1 ) /* late fail */
+        return false;
+
+    /* Partitioning is only informative, see SPS */
+    if( bs_read1( p_bs ) ) /* pps_scaling_window_explicit_signalling_flag */
+    {
+        for( int i = 0; i < 4; i++ )
+            bs_read_se( p_bs ); /* pps_scaling_win_*_offset */
+    }
+    bs_skip( p_bs, 1 ); /* pps_output_flag_present_flag */
+    p_pps->pps_no_pic_partition_flag = bs_read1( p_bs );
+    if( bs_read1( p_bs ) ) /* pps_subpic_id_mapping_present_flag */
+    {
+        if( !p_pps->pps_no_pic_partition_flag )
+            p_pps->pps_num_subpics_minus1 = bs_read_ue( p_bs );
+        const nal_ue_t i_id_len_minus1 = bs_read_ue( p_bs ); /* pps_subpic_id_len_minus1 */
+        if( p_pps->pps_num_subpics_minus1 > VVC_SUBPICS_MAX - 1 ||
+            i_id_len_minus1 > 15 )
+            return true;
+        bs_skip( p_bs, (i_id_len_minus1 + 1) * (p_pps->pps_num_subpics_minus1 + 1) );
+    }
+
+    p_pps->i_num_tile_columns = 1;
+    p_pps->i_num_tile_rows = 1;
+    if( !p_pps->pps_no_pic_partition_flag )
+    {
+        p_pps->pps_log2_ctu_size_minus5 = bs_read( p_bs, 2 );
+        const unsigned i_ctb_log2 = p_pps->pps_log2_ctu_size_minus5 + 5;
+        const unsigned i_width_ctbs = (p_pps->pps_pic_width_in_luma_samples +
+                                       (1U << i_ctb_log2) - 1) >> i_ctb_log2;
+        const unsigned i_height_ctbs = (p_pps->pps_pic_height_in_luma_samples +
+                                        (1U << i_ctb_log2) - 1) >> i_ctb_log2;
+        const nal_ue_t i_num_exp_columns = bs_read_ue( p_bs ) + 1;
+        const nal_ue_t i_num_exp_rows = bs_read_ue( p_bs ) + 1;
+        if( i_num_exp_columns > i_width_ctbs || i_num_exp_rows > i_height_ctbs )
+            return true;
+        p_pps->i_num_tile_columns = vvc_count_tiles( p_bs, i_num_exp_columns,
+                                                     i_width_ctbs );
+        p_pps->i_num_tile_rows = vvc_count_tiles( p_bs, i_num_exp_rows,
+                                                  i_height_ctbs );
+        if( p_pps->i_num_tile_columns == 0 || p_pps->i_num_tile_rows == 0 )
+            return true;
+    }
+
+    /* parsing incomplete */
+
+    p_pps->b_partitioning_parsed = bs_remain( p_bs ) > 0;
+
+    return true;
+}
+
+static bool vvc_parse_picture_header_structure_rbsp( bs_t *p_bs,
+                                                     vvc_picture_header_t *p_ph )
+{
+    if( bs_remain( p_bs ) < 5 )
+        return false;
+
+    p_ph->ph_gdr_or_irap_pic_flag = bs_read1( p_bs );
+    p_ph->ph_non_ref_pic_flag = bs_read1( p_bs );
+    if( p_ph->ph_gdr_or_irap_pic_flag )
+        p_ph->ph_gdr_pic_flag = bs_read1( p_bs );
+    p_ph->ph_inter_slice_allowed_flag = bs_read1( p_bs );
+    if( p_ph->ph_inter_slice_allowed_flag )
+        p_ph->ph_intra_slice_allowed_flag = bs_read1( p_bs );
+    else
+        p_ph->ph_intra_slice_allowed_flag = 1;
+    p_ph->ph_pic_parameter_set_id = bs_read_ue( p_bs );
+    if( p_ph->ph_pic_parameter_set_id > VVC_PPS_ID_MAX )
+        return false;
+
+    /* parsing incomplete */
+
+    return true;
+}
+
+static void vvc_bs_init( bs_t *p_bs, const uint8_t *p_buf, size_t i_buf,
+                         bool b_escaped, unsigned *pi_bitflow )
+{
+    bs_init( p_bs, p_buf, i_buf );
+    if( b_escaped )
+    {
+        p_bs->p_fwpriv = pi_bitflow;
+        p_bs->pf_forward = hxxx_bsfw_ep3b_to_rbsp;  /* Does the emulated 3bytes conversion to rbsp */
+    }
+}
+
+/* Reads the nal_unit_header */
+static bool vvc_read_nal_unit_header( bs_t *p_bs, uint8_t *pi_nal_type )
+{
+    if( bs_read1( p_bs ) ) /* forbidden_zero_bit */
+        return false;
+    bs_skip( p_bs, 1 ); /* nuh_reserved_zero_bit */
+    uint8_t i_nuh_layer_id = bs_read( p_bs, 6 );
+    *pi_nal_type = bs_read( p_bs, 5 );
+    uint8_t i_temporal_id_plus1 = bs_read( p_bs, 3 );
+    return i_nuh_layer_id <= 55 && i_temporal_id_plus1 != 0;
+}
+
+#define IMPL_vvc_generic_decode( name, vvctype, decode, release ) \
+    vvctype * name( const uint8_t *p_buf, size_t i_buf, bool b_escaped ) \
+    { \
+        vvctype *p_vvctype = calloc(1, sizeof(vvctype)); \
+        if(likely(p_vvctype)) \
+        { \
+            bs_t bs; \
+            unsigned i_bitflow = 0; \
+            uint8_t i_nal_type; \
+            vvc_bs_init( &bs, p_buf, i_buf, b_escaped, &i_bitflow ); \
+            if( !vvc_read_nal_unit_header( &bs, &i_nal_type ) || \
+                !decode( &bs, p_vvctype ) ) \
+            { \
+                release( p_vvctype ); \
+                p_vvctype = NULL; \
+            } \
+        } \
+        return p_vvctype; \
+    }
+
+void vvc_rbsp_release_sps( vvc_sequence_parameter_set_t *p_sps )
+{
+    free( p_sps );
+}
+
+IMPL_vvc_generic_decode( vvc_decode_sps, vvc_sequence_parameter_set_t,
+                         vvc_parse_sequence_parameter_set_rbsp, vvc_rbsp_release_sps )
+
+void vvc_rbsp_release_pps( vvc_picture_parameter_set_t *p_pps )
+{
+    free( p_pps );
+}
+
+IMPL_vvc_generic_decode( vvc_decode_pps, vvc_picture_parameter_set_t,
+                         vvc_parse_pic_parameter_set_rbsp, vvc_rbsp_release_pps )
+
+void vvc_rbsp_release_picture_header( vvc_picture_header_t *p_ph )
+{
+    free( p_ph );
+}
+
+vvc_picture_header_t * vvc_decode_picture_header( const uint8_t *p_buf, size_t i_buf,
+                                                  bool b_escaped )
+{
+    bs_t bs;
+    unsigned i_bitflow = 0;
+    uint8_t i_nal_type;
+
+    vvc_bs_init( &bs, p_buf, i_buf, b_escaped, &i_bitflow );
+    if( !vvc_read_nal_unit_header( &bs, &i_nal_type ) )
+        return NULL;
+
+    if( vvc_isVCL( i_nal_type ) )
+    {
+        /* sh_picture_header_in_slice_header_flag */
+        if( !bs_read1( &bs ) )
+            return NULL;
+    }
+    else if( i_nal_type != VVC_NAL_PH )
+        return NULL;
+
+    vvc_picture_header_t *p_ph = calloc(1, sizeof(*p_ph));
+    if( likely(p_ph) && !vvc_parse_picture_header_structure_rbsp( &bs, p_ph ) )
+    {
+        vvc_rbsp_release_picture_header( p_ph );
+        p_ph = NULL;
+    }
+    return p_ph;
+}
+
+uint8_t vvc_get_sps_vps_id( const vvc_sequence_parameter_set_t *p_sps )
+{
+    return p_sps->sps_video_parameter_set_id;
+}
+
+uint8_t vvc_get_pps_sps_id( const vvc_picture_parameter_set_t *p_pps )
+{
+    return p_pps->pps_seq_parameter_set_id;
+}
+
+uint8_t vvc_get_ph_pps_id( const vvc_picture_header_t *p_ph )
+{
+    return p_ph->ph_pic_parameter_set_id;
+}
+
+bool vvc_get_sps_profile_tier_level( const vvc_sequence_parameter_set_t *p_sps,
+                                     uint8_t *pi_profile, uint8_t *pi_level )
+{
+    if( p_sps->sps_ptl_dpb_hrd_params_present_flag &&
+        p_sps->profile_tier_level.general_profile_idc )
+    {
+        *pi_profile = p_sps->profile_tier_level.general_profile_idc;
+        *pi_level = p_sps->profile_tier_level.general_level_idc;
+        return true;
+    }
+    return false;
+}
+
+bool vvc_get_dpb_size( const vvc_sequence_parameter_set_t *p_sps,
+                       uint8_t *pi_dpb_size, uint8_t *pi_reorder )
+{
+    if( !p_sps->b_dpb_parsed )
+        return false;
+    *pi_dpb_size = p_sps->dpb_parameters.dpb_max_dec_pic_buffering_minus1 + 1;
+    *pi_reorder = p_sps->dpb_parameters.dpb_max_num_reorder_pics;
+    return true;
+}
+
+bool vvc_get_parallelism( const vvc_sequence_parameter_set_t *p_sps,
+                          const vvc_picture_parameter_set_t *p_pps,
+                          unsigned *pi_tiles, unsigned *pi_subpics,
+                          bool *pb_wpp )
+{
+    if( !p_sps->b_partitioning_parsed || !p_pps->b_partitioning_parsed )
+        return false;
+    *pi_tiles = p_pps->i_num_tile_columns * p_pps->i_num_tile_rows;
+    *pi_subpics = p_sps->sps_subpic_info_present_flag ?
+                  p_sps->sps_num_subpics_minus1 + 1 : 1;
+    *pb_wpp = p_sps->sps_entropy_coding_sync_enabled_flag;
+    return true;
+}
+
+bool vvc_get_chroma_format( const vvc_sequence_parameter_set_t *p_sps,
+                            uint8_t *pi_chroma_format )
+{
+    *pi_chroma_format = p_sps->sps_chroma_format_idc;
+    return true;
+}
+
+bool vvc_get_picture_size( const vvc_sequence_parameter_set_t *p_sps,
+                           const vvc_picture_parameter_set_t *p_pps,
+                           unsigned *p_w, unsigned *p_h,
+                           unsigned *p_vw, unsigned *p_vh )
+{
+    *p_w = *p_vw = p_pps->pps_pic_width_in_luma_samples;
+    *p_h = *p_vh = p_pps->pps_pic_height_in_luma_samples;
+    if( p_pps->pps_conformance_window_flag )
+    {
+        unsigned sub_width_c, sub_height_c;
+
+        if( p_sps->sps_chroma_format_idc == 1 )
+        {
+            sub_width_c = 2;
+            sub_height_c = 2;
+        }
+        else if( p_sps->sps_chroma_format_idc == 2 )
+        {
+            sub_width_c = 2;
+            sub_height_c = 1;
+        }
+        else
+        {
+            sub_width_c = 1;
+            sub_height_c = 1;
+        }
+
+        uint64_t crop_w = ((uint64_t)p_pps->conf_win.left_offset +
+                           p_pps->conf_win.right_offset) * sub_width_c;
+        uint64_t crop_h = ((uint64_t)p_pps->conf_win.top_offset +
+                           p_pps->conf_win.bottom_offset) * sub_height_c;
+        if( crop_w >= *p_w || crop_h >= *p_h )
+            return false;
+        *p_vw -= crop_w;
+        *p_vh -= crop_h;
+    }
+    return true;
+}
+
+bool vvc_is_intra_picture( const vvc_picture_header_t *p_ph )
+{
+    return !p_ph->ph_inter_slice_allowed_flag;
+}
+
+bool vvc_is_non_ref_picture( const vvc_picture_header_t *p_ph )
+{
+    return p_ph->ph_non_ref_pic_flag;
+}
+
+#define VVC_DCR_ADD_NALS(type, count, buffers, sizes) \
+for (uint8_t i = 0; i < count; i++) \
+{ \
+    if( i ==0 ) \
+    { \
+        *p++ = (type | (b_completeness ? 0x80 : 0)); \
+        SetWBE( p, count ); p += 2; \
+    } \
+    SetWBE( p, sizes[i]); p += 2; \
+    memcpy( p, buffers[i], sizes[i] ); p += sizes[i];\
+}
+
+#define VVC_DCR_ADD_SIZES(count, sizes) \
+if(count > 0) \
+{\
+    i_total_size += 3;\
+    for(uint8_t i=0; i<count; i++)\
+        i_total_size += 2 + sizes[i];\
+}
+
+/* Generate VvcDecoderConfigurationRecord iso/iec 14496-15 6th edition */
+uint8_t * vvc_create_dcr( const struct vvc_dcr_params *p_params,
+                          uint8_t i_nal_length_size,
+                          bool b_completeness, size_t *pi_size )
+{
+    *pi_size = 0;
+
+    if( i_nal_length_size != 1 && i_nal_length_size != 2 && i_nal_length_size != 4 )
+        return NULL;
+
+    size_t i_total_size = 1+1;
+    VVC_DCR_ADD_SIZES(p_params->i_vps_count, p_params->rgi_vps);
+    VVC_DCR_ADD_SIZES(p_params->i_sps_count, p_params->rgi_sps);
+    VVC_DCR_ADD_SIZES(p_params->i_pps_count, p_params->rgi_pps);
+    VVC_DCR_ADD_SIZES(p_params->i_apspref_count, p_params->rgi_apspref);
+    VVC_DCR_ADD_SIZES(p_params->i_seipref_count, p_params->rgi_seipref);
+
+    uint8_t *p_data = malloc( i_total_size );
+    if( p_data == NULL )
+        return NULL;
+
+    *pi_size = i_total_size;
+    uint8_t *p = p_data;
+
+    /* Don't set the optional VvcPTLRecord (ptl_present_flag = 0), as we
+     * don't parse the SPS general constraints information it must carry */
+    *p++ = 0xF8 | ((i_nal_length_size - 1) << 1);
+    /* total number of arrays */
+    *p++ = !!p_params->i_vps_count + !!p_params->i_sps_count +
+           !!p_params->i_pps_count + !!p_params->i_apspref_count +
+           !!p_params->i_seipref_count;
+
+    /* Write NAL arrays */
+    VVC_DCR_ADD_NALS(VVC_NAL_VPS, p_params->i_vps_count,
+                     p_params->p_vps, p_params->rgi_vps);
+    VVC_DCR_ADD_NALS(VVC_NAL_SPS, p_params->i_sps_count,
+                     p_params->p_sps, p_params->rgi_sps);
+    VVC_DCR_ADD_NALS(VVC_NAL_PPS, p_params->i_pps_count,
+                     p_params->p_pps, p_params->rgi_pps);
+    VVC_DCR_ADD_NALS(VVC_NAL_PREF_APS, p_params->i_apspref_count,
+                     p_params->p_apspref, p_params->rgi_apspref);
+    VVC_DCR_ADD_NALS(VVC_NAL_PREF_SEI, p_params->i_seipref_count,
+                     p_params->p_seipref, p_params->rgi_seipref);
+
+    return p_data;
+}
+
+#undef VVC_DCR_ADD_NALS
+#undef VVC_DCR_ADD_SIZES
@@ -0,0 +1,194 @@
+/*****************************************************************************
+ * vvc_nal.h: VVC/H.266 NAL helpers
+ *****************************************************************************
+ * Copyright © 2020 VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VVC_NAL_H
+# define VVC_NAL_H
+
+# include <vlc_es.h>
+# include <vlc_bits.h>
+
+#define VVC_VPS_ID_MAX 15
+#define VVC_SPS_ID_MAX 15
+#define VVC_PPS_ID_MAX 63
+#define VVC_APS_ID_MAX 31
+#define VVC_APS_TYPE_MAX 2 /* ALF, LMCS, scaling list */
+#define VVC_SUBPICS_MAX 600
+#define VVC_MAX_DPB_SIZE 16
+
+/* NAL types from https://www.itu.int/rec/T-REC-H.266-202008-I */
+enum vvc_nal_unit_type_e
+{
+    VVC_NAL_TRAIL       = 0, /* Trailing */
+    VVC_NAL_STSA        = 1, /* Stepwise Temporal Sublayer Access */
+    VVC_NAL_RADL        = 2, /* Random Access Decodable Leading */
+    VVC_NAL_RASL        = 3, /* Random Access Skipped Leading */
+    VVC_NAL_RSV_VCL4    = 4,
+    VVC_NAL_RSV_VCL6    = 6,
+    /* Key frames */
+    VVC_NAL_IDR_W_RADL  = 7, /* Instantaneous Decoder Refresh with Associated RADL */
+    VVC_NAL_IDR_N_LP    = 8, /* Instantaneous Decoder Refresh */
+    VVC_NAL_CRA         = 9, /* Clean Random Access */
+    VVC_NAL_GDR         = 10, /* Gradual Decoding Refresh */
+    VVC_NAL_RSV_IRAP11  = 11,
+    /* Non VCL NAL */
+    VVC_NAL_OPI         = 12, /* Operating point information */
+    VVC_NAL_DCI         = 13, /* Decoding capability information */
+    VVC_NAL_VPS         = 14,
+    VVC_NAL_SPS         = 15,
+    VVC_NAL_PPS         = 16,
+    VVC_NAL_PREF_APS    = 17, /* Prefix adaptation parameter set */
+    VVC_NAL_SUFF_APS    = 18, /* Suffix adaptation parameter set */
+    VVC_NAL_PH          = 19, /* Picture header */
+    VVC_NAL_AUD         = 20, /* Access unit delimiter */
+    VVC_NAL_EOS         = 21, /* End of sequence */
+    VVC_NAL_EOB         = 22, /* End of bitstream */
+    VVC_NAL_PREF_SEI    = 23, /* Prefix SEI */
+    VVC_NAL_SUFF_SEI    = 24, /* Suffix SEI */
+    VVC_NAL_FD          = 25, /* Filler data */
+    VVC_NAL_RSV_NVCL26  = 26, /* Reserved Non VCL */
+    VVC_NAL_RSV_NVCL27  = 27,
+    VVC_NAL_UNSPEC28    = 28, /* Unspecified (custom) */
+    VVC_NAL_UNSPEC29    = 29,
+    VVC_NAL_UNSPEC30    = 30,
+    VVC_NAL_UNSPEC31    = 31,
+    VVC_NAL_UNKNOWN
+};
+
+static inline uint8_t vvc_getNALType( const uint8_t *p_buf )
+{
+    return p_buf[1] >> 3;
+}
+
+static inline uint8_t vvc_getNALLayer( const uint8_t *p_buf )
+{
+    return p_buf[0] & 0x3F;
+}
+
+static inline uint8_t vvc_getNALTemporalId( const uint8_t *p_buf )
+{
+    const uint8_t i_tid_plus1 = p_buf[1] & 0x07;
+    return i_tid_plus1 ? i_tid_plus1 - 1 : 0;
+}
+
+static inline bool vvc_isVCL( uint8_t i_nal_type )
+{
+    return i_nal_type <= VVC_NAL_RSV_IRAP11;
+}
+
+/* IRAP and GDR pictures, where decoding can start */
+static inline bool vvc_isRAP( uint8_t i_nal_type )
+{
+    return i_nal_type >= VVC_NAL_IDR_W_RADL && i_nal_type <= VVC_NAL_GDR;
+}
+
+#define VVC_MIN_VVCC_SIZE 2
+
+/* checks if data is a VvcDecoderConfigurationRecord, as stored in vvcC
+ * after the FullBox version and flags */
+static inline bool vvc_isvvcC( const uint8_t *p_buf, size_t i_buf )
+{
+    return ( i_buf >= VVC_MIN_VVCC_SIZE &&
+             (p_buf[0] & 0xF8) == 0xF8 ); /* Match reserved bits */
+}
+
+static inline uint8_t vvc_getNALLengthSize( const uint8_t *p_vvcC )
+{
+    return ((p_vvcC[0] >> 1) & 0x03) + 1;
+}
+
+/* NAL decoding */
+typedef struct vvc_sequence_parameter_set_t vvc_sequence_parameter_set_t;
+typedef struct vvc_picture_parameter_set_t vvc_picture_parameter_set_t;
+typedef struct vvc_picture_header_t vvc_picture_header_t;
+
+/* Decodes from three bytes emulation prevented or rbsp stream */
+vvc_sequence_parameter_set_t * vvc_decode_sps( const uint8_t *, size_t, bool );
+vvc_picture_parameter_set_t *  vvc_decode_pps( const uint8_t *, size_t, bool );
+/* Decodes the picture header from a PH NAL, or from a slice NAL when it is
+ * carried in the slice header, returns NULL otherwise */
+vvc_picture_header_t *         vvc_decode_picture_header( const uint8_t *, size_t, bool );
+
+void vvc_rbsp_release_sps( vvc_sequence_parameter_set_t * );
+void vvc_rbsp_release_pps( vvc_picture_parameter_set_t * );
+void vvc_rbsp_release_picture_header( vvc_picture_header_t * );
+
+/* set specific */
+uint8_t vvc_get_sps_vps_id( const vvc_sequence_parameter_set_t * );
+uint8_t vvc_get_pps_sps_id( const vvc_picture_parameter_set_t * );
+uint8_t vvc_get_ph_pps_id( const vvc_picture_header_t * );
+
+bool vvc_get_xps_id( const uint8_t *p_nalbuf, size_t i_nalbuf, uint8_t *pi_id );
+bool vvc_get_aps_id( const uint8_t *p_nalbuf, size_t i_nalbuf,
+                     uint8_t *pi_type, uint8_t *pi_id );
+bool vvc_get_sps_profile_tier_level( const vvc_sequence_parameter_set_t *,
+                                     uint8_t *pi_profile, uint8_t *pi_level );
+bool vvc_get_chroma_format( const vvc_sequence_parameter_set_t *,
+                            uint8_t *pi_chroma_format );
+bool vvc_get_picture_size( const vvc_sequence_parameter_set_t *,
+                           const vvc_picture_parameter_set_t *,
+                           unsigned *p_w, unsigned *p_h,
+                           unsigned *p_vw, unsigned *p_vh );
+/* Max decoded pictures buffering (including the current picture) and
+ * reordering, for the highest temporal sub-layer */
+bool vvc_get_dpb_size( const vvc_sequence_parameter_set_t *,
+                       uint8_t *pi_dpb_size, uint8_t *pi_reorder );
+/* Tiles and subpictures count, and wavefront (entropy coding sync) usage */
+bool vvc_get_parallelism( const vvc_sequence_parameter_set_t *,
+                          const vvc_picture_parameter_set_t *,
+                          unsigned *pi_tiles, unsigned *pi_subpics,
+                          bool *pb_wpp );
+
+/* picture header specific */
+bool vvc_is_intra_picture( const vvc_picture_header_t * );
+bool vvc_is_non_ref_picture( const vvc_picture_header_t * );
+
+/* Decoder Configuration Record */
+#define VVC_DCR_VPS_COUNT (VVC_VPS_ID_MAX + 1)
+#define VVC_DCR_SPS_COUNT (VVC_SPS_ID_MAX + 1)
+#define VVC_DCR_PPS_COUNT (VVC_PPS_ID_MAX + 1)
+#define VVC_DCR_APS_COUNT (16)
+#define VVC_DCR_SEI_COUNT (16)
+
+struct vvc_dcr_params
+{
+    const uint8_t *p_vps[VVC_DCR_VPS_COUNT],
+                  *p_sps[VVC_DCR_SPS_COUNT],
+                  *p_pps[VVC_DCR_PPS_COUNT],
+                  *p_apspref[VVC_DCR_APS_COUNT],
+                  *p_seipref[VVC_DCR_SEI_COUNT];
+    uint16_t rgi_vps[VVC_DCR_VPS_COUNT],
+             rgi_sps[VVC_DCR_SPS_COUNT],
+             rgi_pps[VVC_DCR_PPS_COUNT],
+             rgi_apspref[VVC_DCR_APS_COUNT],
+             rgi_seipref[VVC_DCR_SEI_COUNT];
+    uint8_t i_vps_count, i_sps_count, i_pps_count;
+    uint8_t i_apspref_count, i_seipref_count;
+};
+
+/* Generates a VvcDecoderConfigurationRecord (without the FullBox header)
+ * from the parameter sets NAL, without the startcode */
+uint8_t * vvc_create_dcr( const struct vvc_dcr_params *p_params,
+                          uint8_t i_nal_length_size,
+                          bool b_completeness, size_t *pi_size );
+
+/* Converts VvcDecoderConfigurationRecord to Annex B format */
+uint8_t * vvc_vvcC_to_AnnexB_NAL( const uint8_t *p_buf, size_t i_buf,
+                                  size_t *pi_result, uint8_t *pi_nal_length_size );
+
+#endif /* VVC_NAL_H */
@@ -70,6 +70,7 @@
 #include "platform_fonts.h"
 #include "freetype.h"
 #include "text_layout.h"
+#include "text_cache.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -125,6 +126,10 @@ static const char *const ppsz_sizes_text[] = {
 #define YUVP_TEXT N_("Use YUVP renderer")
 #define YUVP_LONGTEXT N_("This renders the font using \"paletized YUV\". " \
   "This option is only needed if you want to encode into DVB subtitles" )
+#define CACHE_SIZE_TEXT N_("Glyph cache size (kB)")
+#define CACHE_SIZE_LONGTEXT N_("Memory used to keep the recently rendered " \
+  "glyphs and shaped text, so that they are not rendered again when the " \
+  "text is updated. 0 disables the cache." )
 
 static const int pi_color_values[] = {
   0x00000000, 0x00808080, 0x00C0C0C0, 0x00FFFFFF, 0x00800000,
@@ -232,6 +237,8 @@ vlc_module_begin ()
 
     add_bool( "freetype-yuvp", false, YUVP_TEXT,
               YUVP_LONGTEXT, true )
+    add_integer( "freetype-cache-size", 8192, CACHE_SIZE_TEXT,
+                 CACHE_SIZE_LONGTEXT, true )
 
 #ifdef HAVE_FRIBIDI
     add_integer_with_range( "freetype-text-direction", 0, 0, 2, TEXT_DIRECTION_TEXT,
@@ -1367,6 +1374,10 @@ static int Create( vlc_object_t *p_this )
 
     p_sys->i_scale = 100;
 
+    int64_t i_cache_size = var_InheritInteger( p_filter, "freetype-cache-size" );
+    if( i_cache_size > 0 )
+        p_sys->p_cache = TextCacheNew( i_cache_size * 1024 );
+
     /* default style to apply to uncomplete segmeents styles */
     p_sys->p_default_style = text_style_Create( STYLE_FULLY_SET );
     if(unlikely(!p_sys->p_default_style))
@@ -1485,6 +1496,13 @@ static void Destroy( vlc_object_t *p_this )
     DumpDictionary( p_filter, &p_sys->fallback_map, true, -1 );
 #endif
 
+    /* Glyphs, before the faces they belong to */
+    if( p_sys->p_cache )
+    {
+        TextCacheDumpStats( p_this, p_sys->p_cache );
+        TextCacheDelete( p_sys->p_cache );
+    }
+
     /* Text styles */
     text_style_Delete( p_sys->p_default_style );
     text_style_Delete( p_sys->p_forced_style );
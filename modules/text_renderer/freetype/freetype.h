@@ -111,6 +111,9 @@ struct filter_sys_t
     /** Font face cache */
     vlc_dictionary_t  face_map;
 
+    /** Glyph and shaping cache, NULL if disabled */
+    struct text_cache_t *p_cache;
+
     int               i_fallback_counter;
 
     /* Current scaling of the text, default is 100 (%) */
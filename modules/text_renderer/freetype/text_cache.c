@@ -0,0 +1,214 @@
+/*****************************************************************************
+ * text_cache.c : Cache of glyphs and shaped runs
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+
+#include "text_cache.h"
+
+#define TEXT_CACHE_BUCKETS 1024
+
+typedef struct text_cache_entry_t text_cache_entry_t;
+struct text_cache_entry_t
+{
+    text_cache_entry_t *p_hash_next;
+    text_cache_entry_t *p_prev;         /**< more recently used */
+    text_cache_entry_t *p_next;         /**< less recently used */
+    uint32_t            i_hash;
+    int                 i_kind;
+    size_t              i_size;
+    void               *p_value;
+    void              (*pf_free)( void * );
+    size_t              i_key_size;
+    unsigned char       key[];
+};
+
+struct text_cache_t
+{
+    text_cache_entry_t *pp_buckets[TEXT_CACHE_BUCKETS];
+    text_cache_entry_t *p_first;        /**< most recently used */
+    text_cache_entry_t *p_last;         /**< least recently used */
+    size_t              i_size;
+    size_t              i_max_size;
+
+    unsigned            pi_hits[TEXT_CACHE_KINDS];
+    unsigned            pi_misses[TEXT_CACHE_KINDS];
+    unsigned            i_evictions;
+};
+
+static uint32_t Hash( int i_kind, const void *p_key, size_t i_key_size )
+{
+    const unsigned char *p = p_key;
+    uint32_t i_hash = 2166136261u ^ i_kind;
+
+    for( size_t i = 0; i < i_key_size; i++ )
+        i_hash = ( i_hash ^ p[i] ) * 16777619u;
+    return i_hash;
+}
+
+static void Unlink( text_cache_t *p_cache, text_cache_entry_t *p_entry )
+{
+    if( p_entry->p_prev )
+        p_entry->p_prev->p_next = p_entry->p_next;
+    else
+        p_cache->p_first = p_entry->p_next;
+    if( p_entry->p_next )
+        p_entry->p_next->p_prev = p_entry->p_prev;
+    else
+        p_cache->p_last = p_entry->p_prev;
+}
+
+static void LinkFirst( text_cache_t *p_cache, text_cache_entry_t *p_entry )
+{
+    p_entry->p_prev = NULL;
+    p_entry->p_next = p_cache->p_first;
+    if( p_cache->p_first )
+        p_cache->p_first->p_prev = p_entry;
+    else
+        p_cache->p_last = p_entry;
+    p_cache->p_first = p_entry;
+}
+
+static void Evict( text_cache_t *p_cache, text_cache_entry_t *p_entry )
+{
+    text_cache_entry_t **pp =
+        &p_cache->pp_buckets[p_entry->i_hash % TEXT_CACHE_BUCKETS];
+
+    while( *pp != p_entry )
+        pp = &(*pp)->p_hash_next;
+    *pp = p_entry->p_hash_next;
+
+    Unlink( p_cache, p_entry );
+    p_cache->i_size -= p_entry->i_size;
+
+    p_entry->pf_free( p_entry->p_value );
+    free( p_entry );
+}
+
+text_cache_t *TextCacheNew( size_t i_max_size )
+{
+    text_cache_t *p_cache = calloc( 1, sizeof( *p_cache ) );
+    if( !p_cache )
+        return NULL;
+
+    p_cache->i_max_size = i_max_size;
+    return p_cache;
+}
+
+void TextCacheDelete( text_cache_t *p_cache )
+{
+    while( p_cache->p_last )
+        Evict( p_cache, p_cache->p_last );
+    free( p_cache );
+}
+
+void *TextCacheGet( text_cache_t *p_cache, int i_kind,
+                    const void *p_key, size_t i_key_size )
+{
+    const uint32_t i_hash = Hash( i_kind, p_key, i_key_size );
+
+    for( text_cache_entry_t *p_entry =
+            p_cache->pp_buckets[i_hash % TEXT_CACHE_BUCKETS];
+         p_entry; p_entry = p_entry->p_hash_next )
+    {
+        if( p_entry->i_hash != i_hash || p_entry->i_kind != i_kind
+         || p_entry->i_key_size != i_key_size
+         || memcmp( p_entry->key, p_key, i_key_size ) )
+            continue;
+
+        if( p_cache->p_first != p_entry )
+        {
+            Unlink( p_cache, p_entry );
+            LinkFirst( p_cache, p_entry );
+        }
+        p_cache->pi_hits[i_kind]++;
+        return p_entry->p_value;
+    }
+
+    p_cache->pi_misses[i_kind]++;
+    return NULL;
+}
+
+int TextCachePut( text_cache_t *p_cache, int i_kind,
+                  const void *p_key, size_t i_key_size,
+                  void *p_value, size_t i_size, void (*pf_free)( void * ) )
+{
+    i_size += sizeof( text_cache_entry_t ) + i_key_size;
+    if( i_size > p_cache->i_max_size )
+    {
+        pf_free( p_value );
+        return VLC_EGENERIC;
+    }
+
+    text_cache_entry_t *p_entry = malloc( sizeof( *p_entry ) + i_key_size );
+    if( unlikely( !p_entry ) )
+    {
+        pf_free( p_value );
+        return VLC_ENOMEM;
+    }
+
+    while( p_cache->i_size + i_size > p_cache->i_max_size )
+    {
+        Evict( p_cache, p_cache->p_last );
+        p_cache->i_evictions++;
+    }
+
+    p_entry->i_hash = Hash( i_kind, p_key, i_key_size );
+    p_entry->i_kind = i_kind;
+    p_entry->i_size = i_size;
+    p_entry->p_value = p_value;
+    p_entry->pf_free = pf_free;
+    p_entry->i_key_size = i_key_size;
+    memcpy( p_entry->key, p_key, i_key_size );
+
+    text_cache_entry_t **pp_bucket =
+        &p_cache->pp_buckets[p_entry->i_hash % TEXT_CACHE_BUCKETS];
+    p_entry->p_hash_next = *pp_bucket;
+    *pp_bucket = p_entry;
+    LinkFirst( p_cache, p_entry );
+    p_cache->i_size += i_size;
+
+    return VLC_SUCCESS;
+}
+
+void TextCacheDumpStats( vlc_object_t *p_obj, const text_cache_t *p_cache )
+{
+    static const char *const ppsz_kinds[TEXT_CACHE_KINDS] = {
+        "glyph", "bitmap", "shaping",
+    };
+
+    for( int i = 0; i < TEXT_CACHE_KINDS; i++ )
+    {
+        const unsigned i_total = p_cache->pi_hits[i] + p_cache->pi_misses[i];
+
+        if( i_total > 0 )
+            msg_Dbg( p_obj, "%s cache: %u/%u hits (%u%%)", ppsz_kinds[i],
+                     p_cache->pi_hits[i], i_total,
+                     100 * p_cache->pi_hits[i] / i_total );
+    }
+    msg_Dbg( p_obj, "text cache: %zu bytes used, %u evictions",
+             p_cache->i_size, p_cache->i_evictions );
+}
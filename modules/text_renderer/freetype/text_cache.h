@@ -0,0 +1,82 @@
+/*****************************************************************************
+ * text_cache.h : Cache of glyphs and shaped runs
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_FREETYPE_TEXT_CACHE_H
+#define VLC_FREETYPE_TEXT_CACHE_H
+
+/** \ingroup freetype
+ * @{
+ * \file
+ * Least recently used cache of the rendering steps that do not depend on the
+ * position of the text, so that text updated every few frames (karaoke, ...)
+ * does not get shaped and rasterized again.
+ */
+
+enum
+{
+    TEXT_CACHE_GLYPH,       /**< glyphs loaded from a face */
+    TEXT_CACHE_BITMAP,      /**< rasterized glyphs */
+    TEXT_CACHE_SHAPE,       /**< shaped runs */
+    TEXT_CACHE_KINDS
+};
+
+typedef struct text_cache_t text_cache_t;
+
+/**
+ * Creates a cache.
+ *
+ * \param i_max_size maximum size of the cached values, in bytes
+ */
+text_cache_t *TextCacheNew( size_t i_max_size );
+
+/**
+ * Frees all the cached values and the cache itself.
+ */
+void TextCacheDelete( text_cache_t *p_cache );
+
+/**
+ * Looks up a value.
+ *
+ * The key is compared bytewise, so any padding must be zeroed.
+ *
+ * \return the value, valid until the next call to TextCachePut(), or NULL
+ */
+void *TextCacheGet( text_cache_t *p_cache, int i_kind,
+                    const void *p_key, size_t i_key_size );
+
+/**
+ * Stores a value, evicting the least recently used ones if needed.
+ *
+ * The cache owns the value, which is freed with \p pf_free, even on error.
+ *
+ * \param i_size size of the value, in bytes
+ */
+int TextCachePut( text_cache_t *p_cache, int i_kind,
+                  const void *p_key, size_t i_key_size,
+                  void *p_value, size_t i_size, void (*pf_free)( void * ) );
+
+/**
+ * Prints the hit rate of each kind of values.
+ */
+void TextCacheDumpStats( vlc_object_t *p_obj, const text_cache_t *p_cache );
+
+/** @} */
+
+#endif
@@ -64,6 +64,7 @@
 
 #include "freetype.h"
 #include "text_layout.h"
+#include "text_cache.h"
 #include "platform_fonts.h"
 
 #include <stdlib.h>
@@ -93,6 +94,18 @@
 # warning YOU ARE MISSING FONTS FALLBACK. TEXT WILL BE INCORRECT
 #endif
 
+#ifdef HAVE_HARFBUZZ
+/**
+ * Output of HarfBuzz for a run, allocated as a single block
+ */
+typedef struct shaped_run_t
+{
+    unsigned int         i_glyph_count;
+    hb_glyph_info_t     *p_glyph_infos;
+    hb_glyph_position_t *p_glyph_positions;
+} shaped_run_t;
+#endif
+
 /**
  * Within a paragraph, run_desc_t represents a run of characters
  * having the same font face, size, and style, Unicode script
@@ -108,8 +121,7 @@ typedef struct run_desc_t
 #ifdef HAVE_HARFBUZZ
     hb_script_t                 script;
     hb_direction_t              direction;
-    hb_font_t                  *p_hb_font;
-    hb_buffer_t                *p_buffer;
+    shaped_run_t               *p_shaped;
     hb_glyph_info_t            *p_glyph_infos;
     hb_glyph_position_t        *p_glyph_positions;
     unsigned int                i_glyph_count;
@@ -117,11 +129,27 @@ typedef struct run_desc_t
 
 } run_desc_t;
 
+/**
+ * Key of the cached glyphs. The origin and the outline flag are only used
+ * for rasterized glyphs, and are zero for loaded glyphs.
+ */
+typedef struct glyph_key_t
+{
+    FT_Face  p_face;          /**< the face also determines the size */
+    FT_Fixed i_radius;        /**< outline stroker radius, -1 if none */
+    FT_Pos   i_x;             /**< subpixel origin, 26.6 values */
+    FT_Pos   i_y;
+    FT_UInt  i_index;
+    int      i_style_flags;   /**< STYLE_BOLD and STYLE_ITALIC */
+    int      b_outline;       /**< rasterized outline rather than glyph */
+} glyph_key_t;
+
 /**
  * Glyph bitmaps. Advance and offset are 26.6 values
  */
 typedef struct glyph_bitmaps_t
 {
+    glyph_key_t key;
     FT_Glyph p_glyph;
     FT_Glyph p_outline;
     FT_Glyph p_shadow;
@@ -659,6 +687,136 @@ static int ItemizeParagraph( filter_t *p_filter, paragraph_t *p_paragraph )
 }
 
 #ifdef HAVE_HARFBUZZ
+static shaped_run_t *NewShapedRun( unsigned int i_glyph_count,
+                                   const hb_glyph_info_t *p_infos,
+                                   const hb_glyph_position_t *p_positions )
+{
+    shaped_run_t *p_shaped =
+        malloc( sizeof( *p_shaped ) + i_glyph_count
+                * ( sizeof( *p_infos ) + sizeof( *p_positions ) ) );
+    if( !p_shaped )
+        return NULL;
+
+    p_shaped->i_glyph_count = i_glyph_count;
+    p_shaped->p_glyph_infos = (hb_glyph_info_t *) &p_shaped[1];
+    p_shaped->p_glyph_positions =
+        (hb_glyph_position_t *) &p_shaped->p_glyph_infos[i_glyph_count];
+    if( i_glyph_count > 0 )
+    {
+        memcpy( p_shaped->p_glyph_infos, p_infos,
+                i_glyph_count * sizeof( *p_infos ) );
+        memcpy( p_shaped->p_glyph_positions, p_positions,
+                i_glyph_count * sizeof( *p_positions ) );
+    }
+    return p_shaped;
+}
+
+static size_t ShapedRunSize( const shaped_run_t *p_shaped )
+{
+    return sizeof( *p_shaped ) + p_shaped->i_glyph_count
+           * ( sizeof( hb_glyph_info_t ) + sizeof( hb_glyph_position_t ) );
+}
+
+/**
+ * Shape a run with HarfBuzz, or copy the result of a previous shaping of the
+ * same text with the same face, script and direction from the cache.
+ */
+static shaped_run_t *ShapeRun( filter_t *p_filter,
+                               const paragraph_t *p_paragraph,
+                               const run_desc_t *p_run )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const uni_char_t *p_text =
+        p_paragraph->p_code_points + p_run->i_start_offset;
+    const int i_length = p_run->i_end_offset - p_run->i_start_offset;
+
+    /* The face also determines the size */
+    struct
+    {
+        FT_Face         p_face;
+        hb_script_t     script;
+        hb_direction_t  direction;
+    } header;
+    const size_t i_key_size = sizeof( header ) + i_length * sizeof( *p_text );
+    uint8_t *p_key = NULL;
+
+    if( p_sys->p_cache )
+    {
+        p_key = malloc( i_key_size );
+        if( p_key )
+        {
+            memset( &header, 0, sizeof( header ) );
+            header.p_face = p_run->p_face;
+            header.script = p_run->script;
+            header.direction = p_run->direction;
+            memcpy( p_key, &header, sizeof( header ) );
+            memcpy( p_key + sizeof( header ), p_text,
+                    i_length * sizeof( *p_text ) );
+
+            const shaped_run_t *p_cached =
+                TextCacheGet( p_sys->p_cache, TEXT_CACHE_SHAPE,
+                              p_key, i_key_size );
+            if( p_cached )
+            {
+                free( p_key );
+                return NewShapedRun( p_cached->i_glyph_count,
+                                     p_cached->p_glyph_infos,
+                                     p_cached->p_glyph_positions );
+            }
+        }
+    }
+
+    shaped_run_t *p_shaped = NULL;
+    hb_buffer_t *p_buffer = NULL;
+    hb_font_t *p_hb_font = hb_ft_font_create( p_run->p_face, 0 );
+    if( !p_hb_font )
+    {
+        msg_Err( p_filter, "ShapeRun(): hb_ft_font_create() error" );
+        goto end;
+    }
+
+    p_buffer = hb_buffer_create();
+    if( !p_buffer )
+    {
+        msg_Err( p_filter, "ShapeRun(): hb_buffer_create() error" );
+        goto end;
+    }
+
+    hb_buffer_set_direction( p_buffer, p_run->direction );
+    hb_buffer_set_script( p_buffer, p_run->script );
+#ifdef __OS2__
+    hb_buffer_add_utf16( p_buffer, p_text, i_length, 0, i_length );
+#else
+    hb_buffer_add_utf32( p_buffer, p_text, i_length, 0, i_length );
+#endif
+    hb_shape( p_hb_font, p_buffer, 0, 0 );
+
+    unsigned int i_glyph_count;
+    const hb_glyph_info_t *p_infos =
+        hb_buffer_get_glyph_infos( p_buffer, &i_glyph_count );
+    const hb_glyph_position_t *p_positions =
+        hb_buffer_get_glyph_positions( p_buffer, &i_glyph_count );
+
+    p_shaped = NewShapedRun( i_glyph_count, p_infos, p_positions );
+
+    if( p_shaped && p_key )
+    {
+        shaped_run_t *p_cached =
+            NewShapedRun( i_glyph_count, p_infos, p_positions );
+        if( p_cached )
+            TextCachePut( p_sys->p_cache, TEXT_CACHE_SHAPE, p_key, i_key_size,
+                          p_cached, ShapedRunSize( p_cached ), free );
+    }
+
+end:
+    if( p_buffer )
+        hb_buffer_destroy( p_buffer );
+    if( p_hb_font )
+        hb_font_destroy( p_hb_font );
+    free( p_key );
+    return p_shaped;
+}
+
 /**
  * Shape an itemized paragraph using HarfBuzz.
  * This is where the glyphs of complex scripts get their positions
@@ -697,55 +855,23 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
          * loaded in AddRunWithFallback(), except for runs of codepoints
          * for which no font could be found.
          */
-        FT_Face p_face = 0;
         if( !p_run->p_face )
         {
-            p_face = SelectAndLoadFace( p_filter, p_style, 0 );
-            if( !p_face )
+            p_run->p_face = SelectAndLoadFace( p_filter, p_style, 0 );
+            if( !p_run->p_face )
             {
-                p_face = p_sys->p_face;
-                p_style = p_sys->p_default_style;
-                p_run->p_style = p_style;
+                p_run->p_face = p_sys->p_face;
+                p_run->p_style = p_sys->p_default_style;
             }
-            p_run->p_face = p_face;
         }
-        else
-            p_face = p_run->p_face;
 
-        p_run->p_hb_font = hb_ft_font_create( p_face, 0 );
-        if( !p_run->p_hb_font )
-        {
-            msg_Err( p_filter,
-                     "ShapeParagraphHarfBuzz(): hb_ft_font_create() error" );
+        p_run->p_shaped = ShapeRun( p_filter, p_paragraph, p_run );
+        if( !p_run->p_shaped )
             goto error;
-        }
 
-        p_run->p_buffer = hb_buffer_create();
-        if( !p_run->p_buffer )
-        {
-            msg_Err( p_filter,
-                     "ShapeParagraphHarfBuzz(): hb_buffer_create() error" );
-            goto error;
-        }
-
-        hb_buffer_set_direction( p_run->p_buffer, p_run->direction );
-        hb_buffer_set_script( p_run->p_buffer, p_run->script );
-#ifdef __OS2__
-        hb_buffer_add_utf16( p_run->p_buffer,
-                             p_paragraph->p_code_points + p_run->i_start_offset,
-                             p_run->i_end_offset - p_run->i_start_offset, 0,
-                             p_run->i_end_offset - p_run->i_start_offset );
-#else
-        hb_buffer_add_utf32( p_run->p_buffer,
-                             p_paragraph->p_code_points + p_run->i_start_offset,
-                             p_run->i_end_offset - p_run->i_start_offset, 0,
-                             p_run->i_end_offset - p_run->i_start_offset );
-#endif
-        hb_shape( p_run->p_hb_font, p_run->p_buffer, 0, 0 );
-        p_run->p_glyph_infos =
-            hb_buffer_get_glyph_infos( p_run->p_buffer, &p_run->i_glyph_count );
-        p_run->p_glyph_positions =
-            hb_buffer_get_glyph_positions( p_run->p_buffer, &p_run->i_glyph_count );
+        p_run->p_glyph_infos = p_run->p_shaped->p_glyph_infos;
+        p_run->p_glyph_positions = p_run->p_shaped->p_glyph_positions;
+        p_run->i_glyph_count = p_run->p_shaped->i_glyph_count;
 
         if( p_run->i_glyph_count <= 0 )
         {
@@ -816,10 +942,7 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
     }
 
     for( int i = 0; i < p_paragraph->i_runs_count; ++i )
-    {
-        hb_font_destroy( p_paragraph->p_runs[ i ].p_hb_font );
-        hb_buffer_destroy( p_paragraph->p_runs[ i ].p_buffer );
-    }
+        free( p_paragraph->p_runs[ i ].p_shaped );
     FreeParagraph( *p_old_paragraph );
     *p_old_paragraph = p_new_paragraph;
 
@@ -828,10 +951,8 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
 error:
     for( int i = 0; i < p_paragraph->i_runs_count; ++i )
     {
-        if( p_paragraph->p_runs[ i ].p_hb_font )
-            hb_font_destroy( p_paragraph->p_runs[ i ].p_hb_font );
-        if( p_paragraph->p_runs[ i ].p_buffer )
-            hb_buffer_destroy( p_paragraph->p_runs[ i ].p_buffer );
+        free( p_paragraph->p_runs[ i ].p_shaped );
+        p_paragraph->p_runs[ i ].p_shaped = NULL;
     }
 
     if( p_new_paragraph )
@@ -931,6 +1052,184 @@ static int ZeroNsmAdvance( paragraph_t *p_paragraph )
 #endif
 #endif
 
+static void FreeGlyph( void *p_glyph )
+{
+    FT_Done_Glyph( (FT_Glyph) p_glyph );
+}
+
+static size_t GlyphSize( FT_Glyph glyph )
+{
+    if( glyph->format == FT_GLYPH_FORMAT_BITMAP )
+    {
+        const FT_Bitmap *p_bitmap = &((FT_BitmapGlyph) glyph)->bitmap;
+        return sizeof( FT_BitmapGlyphRec )
+             + (size_t) abs( p_bitmap->pitch ) * p_bitmap->rows;
+    }
+    if( glyph->format == FT_GLYPH_FORMAT_OUTLINE )
+    {
+        const FT_Outline *p_outline = &((FT_OutlineGlyph) glyph)->outline;
+        return sizeof( FT_OutlineGlyphRec )
+             + p_outline->n_points * ( sizeof( FT_Vector ) + 1 )
+             + p_outline->n_contours * sizeof( short );
+    }
+    return sizeof( FT_GlyphRec );
+}
+
+typedef struct
+{
+    FT_Glyph  p_glyph;
+    FT_Glyph  p_outline;
+    FT_Vector advance;
+} cached_glyph_t;
+
+static void FreeCachedGlyph( void *p_value )
+{
+    cached_glyph_t *p_cached = p_value;
+
+    FT_Done_Glyph( p_cached->p_glyph );
+    if( p_cached->p_outline )
+        FT_Done_Glyph( p_cached->p_outline );
+    free( p_cached );
+}
+
+/**
+ * Load a glyph, synthesize its style and stroke its outline, or copy them
+ * from the cache.
+ */
+static int LoadGlyph( filter_t *p_filter, const glyph_key_t *p_key,
+                      FT_Glyph *pp_glyph, FT_Glyph *pp_outline,
+                      FT_Vector *p_advance )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    FT_Face p_face = p_key->p_face;
+
+    *pp_outline = NULL;
+
+    if( p_sys->p_cache )
+    {
+        const cached_glyph_t *p_cached =
+            TextCacheGet( p_sys->p_cache, TEXT_CACHE_GLYPH,
+                          p_key, sizeof( *p_key ) );
+        if( p_cached )
+        {
+            if( FT_Glyph_Copy( p_cached->p_glyph, pp_glyph ) )
+                return VLC_ENOMEM;
+            if( p_cached->p_outline
+             && FT_Glyph_Copy( p_cached->p_outline, pp_outline ) )
+                *pp_outline = NULL;
+            *p_advance = p_cached->advance;
+            return VLC_SUCCESS;
+        }
+    }
+
+    if( FT_Load_Glyph( p_face, p_key->i_index,
+                       FT_LOAD_NO_BITMAP | FT_LOAD_DEFAULT )
+     && FT_Load_Glyph( p_face, p_key->i_index, FT_LOAD_DEFAULT ) )
+        return VLC_EGENERIC;
+
+    if( ( p_key->i_style_flags & STYLE_BOLD )
+          && !( p_face->style_flags & FT_STYLE_FLAG_BOLD ) )
+        FT_GlyphSlot_Embolden( p_face->glyph );
+    if( ( p_key->i_style_flags & STYLE_ITALIC )
+          && !( p_face->style_flags & FT_STYLE_FLAG_ITALIC ) )
+        FT_GlyphSlot_Oblique( p_face->glyph );
+
+    if( FT_Get_Glyph( p_face->glyph, pp_glyph ) )
+        return VLC_EGENERIC;
+
+    if( p_key->i_radius >= 0 )
+    {
+        *pp_outline = *pp_glyph;
+        if( FT_Glyph_StrokeBorder( pp_outline, p_sys->p_stroker, 0, 0 ) )
+            *pp_outline = NULL;
+    }
+
+    *p_advance = p_face->glyph->advance;
+
+    if( p_sys->p_cache )
+    {
+        cached_glyph_t *p_cached = malloc( sizeof( *p_cached ) );
+        if( !p_cached )
+            return VLC_SUCCESS;
+
+        p_cached->p_outline = NULL;
+        p_cached->advance = *p_advance;
+        if( FT_Glyph_Copy( *pp_glyph, &p_cached->p_glyph ) )
+        {
+            free( p_cached );
+            return VLC_SUCCESS;
+        }
+        if( *pp_outline && FT_Glyph_Copy( *pp_outline, &p_cached->p_outline ) )
+        {
+            FreeCachedGlyph( p_cached );
+            return VLC_SUCCESS;
+        }
+
+        size_t i_size = sizeof( *p_cached ) + GlyphSize( p_cached->p_glyph );
+        if( p_cached->p_outline )
+            i_size += GlyphSize( p_cached->p_outline );
+        TextCachePut( p_sys->p_cache, TEXT_CACHE_GLYPH, p_key, sizeof( *p_key ),
+                      p_cached, i_size, FreeCachedGlyph );
+    }
+    return VLC_SUCCESS;
+}
+
+/**
+ * Rasterize a glyph at the pen position, like FT_Glyph_To_Bitmap().
+ *
+ * Moving the pen by whole pixels only moves the bitmap, so the bitmaps are
+ * cached for the subpixel part of the pen position.
+ */
+static FT_Error RenderGlyph( filter_t *p_filter, const glyph_key_t *p_key,
+                             bool b_outline, FT_Glyph *pp_glyph,
+                             const FT_Vector *p_pen, bool b_destroy )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    FT_Glyph glyph = *pp_glyph;
+
+    /* FT_Glyph_To_Bitmap() ignores the origin of bitmap glyphs */
+    if( !p_sys->p_cache || glyph->format != FT_GLYPH_FORMAT_OUTLINE )
+        return FT_Glyph_To_Bitmap( pp_glyph, FT_RENDER_MODE_NORMAL,
+                                   (FT_Vector *) p_pen, b_destroy );
+
+    glyph_key_t key;
+    memcpy( &key, p_key, sizeof( key ) ); /* with the zeroed padding */
+    key.i_x = p_pen->x & 63;
+    key.i_y = p_pen->y & 63;
+    key.b_outline = b_outline;
+
+    FT_Glyph bitmap = TextCacheGet( p_sys->p_cache, TEXT_CACHE_BITMAP,
+                                    &key, sizeof( key ) );
+    FT_Glyph copy;
+    FT_Error i_error;
+
+    if( bitmap )
+        i_error = FT_Glyph_Copy( bitmap, &copy );
+    else
+    {
+        FT_Vector origin = { .x = key.i_x, .y = key.i_y };
+
+        copy = glyph;
+        i_error = FT_Glyph_To_Bitmap( &copy, FT_RENDER_MODE_NORMAL,
+                                      &origin, 0 );
+        if( !i_error && !FT_Glyph_Copy( copy, &bitmap ) )
+            TextCachePut( p_sys->p_cache, TEXT_CACHE_BITMAP,
+                          &key, sizeof( key ), bitmap,
+                          GlyphSize( bitmap ), FreeGlyph );
+    }
+    if( i_error )
+        return i_error;
+
+    FT_BitmapGlyph p_bitmap = (FT_BitmapGlyph) copy;
+    p_bitmap->left += ( p_pen->x - key.i_x ) / 64;
+    p_bitmap->top  += ( p_pen->y - key.i_y ) / 64;
+
+    if( b_destroy )
+        FT_Done_Glyph( glyph );
+    *pp_glyph = copy;
+    return 0;
+}
+
 /**
  * Load the glyphs of a paragraph. When shaping with HarfBuzz the glyph indices
  * have already been determined at this point, as well as the advance values.
@@ -973,12 +1272,13 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
         else
             p_face = p_run->p_face;
 
+        FT_Fixed i_radius = -1;
         if( p_sys->p_stroker && (p_style->i_style_flags & STYLE_OUTLINE) )
         {
             double f_outline_thickness =
                 var_InheritInteger( p_filter, "freetype-outline-thickness" ) / 100.0;
             f_outline_thickness = VLC_CLIP( f_outline_thickness, 0.0, 0.5 );
-            int i_radius = ( i_live_size << 6 ) * f_outline_thickness;
+            i_radius = ( i_live_size << 6 ) * f_outline_thickness;
             FT_Stroker_Set( p_sys->p_stroker,
                             i_radius,
                             FT_STROKER_LINECAP_ROUND,
@@ -1035,39 +1335,29 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
                     SKIP_GLYPH( p_bitmaps )
             }
 
-            if( FT_Load_Glyph( p_face, i_glyph_index,
-                               FT_LOAD_NO_BITMAP | FT_LOAD_DEFAULT )
-             && FT_Load_Glyph( p_face, i_glyph_index, FT_LOAD_DEFAULT ) )
-                SKIP_GLYPH( p_bitmaps )
-
-            if( ( p_style->i_style_flags & STYLE_BOLD )
-                  && !( p_face->style_flags & FT_STYLE_FLAG_BOLD ) )
-                FT_GlyphSlot_Embolden( p_face->glyph );
-            if( ( p_style->i_style_flags & STYLE_ITALIC )
-                  && !( p_face->style_flags & FT_STYLE_FLAG_ITALIC ) )
-                FT_GlyphSlot_Oblique( p_face->glyph );
-
-            if( FT_Get_Glyph( p_face->glyph, &p_bitmaps->p_glyph ) )
+            glyph_key_t *p_key = &p_bitmaps->key;
+            memset( p_key, 0, sizeof( *p_key ) );
+            p_key->p_face = p_face;
+            p_key->i_radius = i_radius;
+            p_key->i_index = i_glyph_index;
+            p_key->i_style_flags = p_style->i_style_flags
+                                 & ( STYLE_BOLD | STYLE_ITALIC );
+
+            FT_Vector advance;
+            if( LoadGlyph( p_filter, p_key, &p_bitmaps->p_glyph,
+                           &p_bitmaps->p_outline, &advance ) )
                 SKIP_GLYPH( p_bitmaps )
 
 #undef SKIP_GLYPH
 
-            if( p_filter->p_sys->p_stroker && (p_style->i_style_flags & STYLE_OUTLINE) )
-            {
-                p_bitmaps->p_outline = p_bitmaps->p_glyph;
-                if( FT_Glyph_StrokeBorder( &p_bitmaps->p_outline,
-                                           p_filter->p_sys->p_stroker, 0, 0 ) )
-                    p_bitmaps->p_outline = 0;
-            }
-
             if( p_style->i_shadow_alpha != STYLE_ALPHA_TRANSPARENT )
                 p_bitmaps->p_shadow = p_bitmaps->p_outline ?
                                       p_bitmaps->p_outline : p_bitmaps->p_glyph;
 
             if( b_overwrite_advance )
             {
-                p_bitmaps->i_x_advance = p_face->glyph->advance.x;
-                p_bitmaps->i_y_advance = p_face->glyph->advance.y;
+                p_bitmaps->i_x_advance = advance.x;
+                p_bitmaps->i_y_advance = advance.y;
             }
 
             unsigned i_x_advance = FT_FLOOR( abs( p_bitmaps->i_x_advance ) );
@@ -1172,8 +1462,9 @@ static int LayoutLine( filter_t *p_filter,
 
         if( p_bitmaps->p_shadow )
         {
-            if( FT_Glyph_To_Bitmap( &p_bitmaps->p_shadow, FT_RENDER_MODE_NORMAL,
-                                    &pen_shadow, 0 ) )
+            if( RenderGlyph( p_filter, &p_bitmaps->key,
+                             p_bitmaps->p_shadow == p_bitmaps->p_outline,
+                             &p_bitmaps->p_shadow, &pen_shadow, false ) )
                 p_bitmaps->p_shadow = 0;
             else
                 FT_Glyph_Get_CBox( p_bitmaps->p_shadow, ft_glyph_bbox_pixels,
@@ -1181,8 +1472,8 @@ static int LayoutLine( filter_t *p_filter,
         }
         if( p_bitmaps->p_glyph )
         {
-            if( FT_Glyph_To_Bitmap( &p_bitmaps->p_glyph, FT_RENDER_MODE_NORMAL,
-                                    &pen_new, 1 ) )
+            if( RenderGlyph( p_filter, &p_bitmaps->key, false,
+                             &p_bitmaps->p_glyph, &pen_new, true ) )
             {
                 FT_Done_Glyph( p_bitmaps->p_glyph );
                 if( p_bitmaps->p_outline )
@@ -1198,8 +1489,8 @@ static int LayoutLine( filter_t *p_filter,
         }
         if( p_bitmaps->p_outline )
         {
-            if( FT_Glyph_To_Bitmap( &p_bitmaps->p_outline, FT_RENDER_MODE_NORMAL,
-                                    &pen_new, 1 ) )
+            if( RenderGlyph( p_filter, &p_bitmaps->key, true,
+                             &p_bitmaps->p_outline, &pen_new, true ) )
             {
                 FT_Done_Glyph( p_bitmaps->p_outline );
                 p_bitmaps->p_outline = 0;
@@ -34,6 +34,9 @@
 #include <vlc_picture.h>
 #include <vlc_cpu.h>
 #include <assert.h>
+#if defined(__ARM_NEON)
+# include <arm_neon.h>
+#endif
 
 #include "copy.h"
 static void CopyPlane(uint8_t *dst, size_t dst_pitch,
@@ -131,6 +134,8 @@ void CopyCleanCache(copy_cache_t *cache)
 # define vlc_CPU_SSSE3() (0)
 # undef vlc_CPU_SSE2
 # define vlc_CPU_SSE2() (0)
+# undef vlc_CPU_AVX2
+# define vlc_CPU_AVX2() (0)
 #endif
 
 /* Optimized copy from "Uncacheable Speculative Write Combining" memory
@@ -611,8 +616,119 @@ static void SSE_Copy420_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
     asm volatile ("emms");
 }
 #undef COPY64
+
+/* Narrow 8 bits samples stored in 16 bits words (low byte first) */
+VLC_SSE
+static void SSE_NarrowPlane16To8(uint8_t *dst, size_t dst_pitch,
+                                 const uint8_t *src, size_t src_pitch,
+                                 unsigned width, unsigned height)
+{
+    static const uint16_t mask[8] = {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    };
+
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+
+        for (; x + 31 < width; x += 32) {
+            asm volatile (
+                "movdqu   (%[mask]), %%xmm7\n"
+                "movdqu  0(%[src]), %%xmm0\n"
+                "movdqu 16(%[src]), %%xmm1\n"
+                "movdqu 32(%[src]), %%xmm2\n"
+                "movdqu 48(%[src]), %%xmm3\n"
+                "pand     %%xmm7, %%xmm0\n"
+                "pand     %%xmm7, %%xmm1\n"
+                "pand     %%xmm7, %%xmm2\n"
+                "pand     %%xmm7, %%xmm3\n"
+                "packuswb %%xmm1, %%xmm0\n"
+                "packuswb %%xmm3, %%xmm2\n"
+                "movdqu   %%xmm0,  0(%[dst])\n"
+                "movdqu   %%xmm2, 16(%[dst])\n"
+                : : [dst]"r"(&dst[x]), [src]"r"(&src[2*x]), [mask]"r"(mask)
+                : "memory", "xmm0", "xmm1", "xmm2", "xmm3", "xmm7");
+        }
+        for (; x < width; x++)
+            dst[x] = src[2*x];
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+}
+
+#ifdef CAN_COMPILE_AVX2
+static void AVX2_NarrowPlane16To8(uint8_t *dst, size_t dst_pitch,
+                                  const uint8_t *src, size_t src_pitch,
+                                  unsigned width, unsigned height)
+{
+    static const uint16_t mask[16] = {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    };
+
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+
+        for (; x + 63 < width; x += 64) {
+            /* vpackuswb works on each 128 bits lane, vpermq restores the
+             * order of the 64 bits blocks */
+            asm volatile (
+                "vmovdqu  (%[mask]), %%ymm7\n"
+                "vpand    0(%[src]), %%ymm7, %%ymm0\n"
+                "vpand   32(%[src]), %%ymm7, %%ymm1\n"
+                "vpand   64(%[src]), %%ymm7, %%ymm2\n"
+                "vpand   96(%[src]), %%ymm7, %%ymm3\n"
+                "vpackuswb %%ymm1, %%ymm0, %%ymm0\n"
+                "vpackuswb %%ymm3, %%ymm2, %%ymm2\n"
+                "vpermq  $0xd8, %%ymm0, %%ymm0\n"
+                "vpermq  $0xd8, %%ymm2, %%ymm2\n"
+                "vmovdqu  %%ymm0,  0(%[dst])\n"
+                "vmovdqu  %%ymm2, 32(%[dst])\n"
+                : : [dst]"r"(&dst[x]), [src]"r"(&src[2*x]), [mask]"r"(mask)
+                : "memory", "xmm0", "xmm1", "xmm2", "xmm3", "xmm7");
+        }
+        for (; x < width; x++)
+            dst[x] = src[2*x];
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+    asm volatile ("vzeroupper");
+}
+#endif /* CAN_COMPILE_AVX2 */
 #endif /* CAN_COMPILE_SSE2 */
 
+#if defined(__ARM_NEON) && !defined(COPY_TEST_NOOPTIM)
+static void NEON_NarrowPlane16To8(uint8_t *dst, size_t dst_pitch,
+                                  const uint8_t *src, size_t src_pitch,
+                                  unsigned width, unsigned height)
+{
+    for (unsigned y = 0; y < height; y++) {
+        unsigned x = 0;
+
+        for (; x + 15 < width; x += 16) {
+            /* de-interleave the low and high bytes */
+            uint8x16x2_t words = vld2q_u8(&src[2*x]);
+            vst1q_u8(&dst[x], words.val[0]);
+        }
+        for (; x < width; x++)
+            dst[x] = src[2*x];
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+}
+#endif
+
+static void NarrowPlane16To8(uint8_t *dst, size_t dst_pitch,
+                             const uint8_t *src, size_t src_pitch,
+                             unsigned width, unsigned height)
+{
+    for (unsigned y = 0; y < height; y++) {
+        for (unsigned x = 0; x < width; x++)
+            dst[x] = src[2*x];
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+}
+
 static void CopyPlane(uint8_t *dst, size_t dst_pitch,
                       const uint8_t *src, size_t src_pitch,
                       unsigned height, int bitshift)
@@ -940,6 +1056,55 @@ void Copy420_P_to_P(picture_t *dst, const uint8_t *src[static 3],
                src[2], src_pitch[2], (height+1) / 2, 0);
 }
 
+void Copy16To8_P_to_P(picture_t *dst, const uint8_t *src[],
+                      const size_t src_pitch[], unsigned width,
+                      unsigned height, unsigned slice, unsigned slice_count)
+{
+    assert(dst);
+    assert(width); assert(height);
+    assert(slice < slice_count);
+
+    const vlc_chroma_description_t *dsc =
+        vlc_fourcc_GetChromaDescription(dst->format.i_chroma);
+    assert(dsc && dsc->pixel_size == 1);
+
+    void (*narrow)(uint8_t *, size_t, const uint8_t *, size_t,
+                   unsigned, unsigned) = NarrowPlane16To8;
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        narrow = AVX2_NarrowPlane16To8;
+    else
+#endif
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2())
+        narrow = SSE_NarrowPlane16To8;
+#endif
+#if defined(__ARM_NEON) && !defined(COPY_TEST_NOOPTIM)
+    narrow = NEON_NarrowPlane16To8;
+#endif
+
+    for (int i = 0; i < dst->i_planes; i++)
+    {
+        ASSERT_PLANE(i);
+        unsigned plane_width  = (width * dsc->p[i].w.num
+                                 + dsc->p[i].w.den - 1) / dsc->p[i].w.den;
+        unsigned plane_height = (height * dsc->p[i].h.num
+                                 + dsc->p[i].h.den - 1) / dsc->p[i].h.den;
+        plane_width  = __MIN(plane_width, (unsigned)dst->p[i].i_pitch);
+        plane_height = __MIN(plane_height, (unsigned)dst->p[i].i_lines);
+
+        /* */
+        const unsigned y0 = plane_height * slice / slice_count;
+        const unsigned y1 = plane_height * (slice + 1) / slice_count;
+        if (y0 == y1)
+            continue;
+
+        narrow(&dst->p[i].p_pixels[y0 * dst->p[i].i_pitch], dst->p[i].i_pitch,
+               &src[i][y0 * src_pitch[i]], src_pitch[i],
+               plane_width, y1 - y0);
+    }
+}
+
 void picture_SwapUV(picture_t *picture)
 {
     assert(picture->i_planes == 3);
@@ -1158,6 +1323,93 @@ static picture_t *pic_new_unaligned(const video_format_t *fmt)
     return picture_NewFromResource(fmt, &rsc);
 }
 
+static void test_narrow(vlc_fourcc_t chroma, const struct test_size *size,
+                        unsigned slice_count)
+{
+    const vlc_chroma_description_t *dsc = vlc_fourcc_GetChromaDescription(chroma);
+    assert(dsc);
+
+    video_format_t fmt;
+    video_format_Init(&fmt, 0);
+    video_format_Setup(&fmt, chroma, size->i_width, size->i_height,
+                       size->i_visible_width, size->i_visible_height, 1, 1);
+    picture_t *dst = picture_NewFromFormat(&fmt);
+    picture_t *ref = picture_NewFromFormat(&fmt);
+    assert(dst && ref);
+
+    fprintf(stderr, "testing: %u x %u (vis: %u x %u) %4.4s 16 -> 8 bits (%u slices)\n",
+            size->i_width, size->i_height,
+            size->i_visible_width, size->i_visible_height,
+            (const char *) &chroma, slice_count);
+
+    uint8_t *src[3] = { NULL, NULL, NULL };
+    size_t src_pitch[3] = { 0, 0, 0 };
+    for (unsigned i = 0; i < dsc->plane_count; i++)
+    {
+        /* Odd pitches and random high bytes */
+        const unsigned lines = dst->p[i].i_lines;
+        src_pitch[i] = dst->p[i].i_pitch * 2 + 6;
+        src[i] = malloc(src_pitch[i] * lines);
+        assert(src[i]);
+        for (size_t b = 0; b < src_pitch[i] * lines; b++)
+            src[i][b] = rand();
+
+        const unsigned width = (size->i_visible_width * dsc->p[i].w.num
+                                + dsc->p[i].w.den - 1) / dsc->p[i].w.den;
+        const unsigned height = (size->i_visible_height * dsc->p[i].h.num
+                                 + dsc->p[i].h.den - 1) / dsc->p[i].h.den;
+        NarrowPlane16To8(ref->p[i].p_pixels, ref->p[i].i_pitch,
+                         src[i], src_pitch[i], width, height);
+    }
+
+    for (unsigned slice = 0; slice < slice_count; slice++)
+        Copy16To8_P_to_P(dst, (const uint8_t **) src, src_pitch,
+                         size->i_visible_width, size->i_visible_height,
+                         slice, slice_count);
+
+    for (unsigned i = 0; i < dsc->plane_count; i++)
+    {
+        const unsigned width = (size->i_visible_width * dsc->p[i].w.num
+                                + dsc->p[i].w.den - 1) / dsc->p[i].w.den;
+        const unsigned height = (size->i_visible_height * dsc->p[i].h.num
+                                 + dsc->p[i].h.den - 1) / dsc->p[i].h.den;
+        for (unsigned y = 0; y < height; y++)
+            assert(!memcmp(&dst->p[i].p_pixels[y * dst->p[i].i_pitch],
+                           &ref->p[i].p_pixels[y * ref->p[i].i_pitch], width));
+        free(src[i]);
+    }
+    picture_Release(ref);
+    picture_Release(dst);
+}
+
+static void bench_narrow(void)
+{
+    const unsigned width = 1920, height = 1080, count = 50;
+    const size_t src_pitch = width * 2, dst_pitch = width;
+    uint8_t *src = malloc(src_pitch * height);
+    picture_t *dst = picture_New(VLC_CODEC_GREY, width, height, 1, 1);
+    assert(src && dst);
+    memset(src, 0x42, src_pitch * height);
+
+    mtime_t start = mdate();
+    for (unsigned i = 0; i < count; i++)
+        NarrowPlane16To8(dst->p[0].p_pixels, dst_pitch, src, src_pitch,
+                         width, height);
+    const mtime_t scalar = mdate() - start;
+
+    start = mdate();
+    for (unsigned i = 0; i < count; i++)
+        Copy16To8_P_to_P(dst, (const uint8_t *[]) { src }, &src_pitch,
+                         width, height, 0, 1);
+    const mtime_t optimized = mdate() - start;
+
+    fprintf(stderr, "bench: %ux%u 16 -> 8 bits: scalar %"PRId64" us, "
+            "optimized %"PRId64" us per plane\n", width, height,
+            scalar / count, optimized / count);
+    picture_Release(dst);
+    free(src);
+}
+
 int main(void)
 {
     alarm(10);
@@ -1234,6 +1486,17 @@ int main(void)
             CopyCleanCache(&cache);
         }
     }
+
+    static const vlc_fourcc_t narrow_chromas[] = {
+        VLC_CODEC_GREY, VLC_CODEC_I420, VLC_CODEC_I422, VLC_CODEC_I444,
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(narrow_chromas); ++i)
+        for (size_t j = 0; j < NB_SIZES; ++j)
+        {
+            test_narrow(narrow_chromas[i], &sizes[j], 1);
+            test_narrow(narrow_chromas[i], &sizes[j], 3);
+        }
+    bench_narrow();
     return 0;
 }
 
@@ -78,6 +78,19 @@ void CopyFromI420_10ToP010(picture_t *dst, const uint8_t *src[static 3],
                            const size_t src_pitch[static 3],
                            unsigned height, const copy_cache_t *cache);
 
+/**
+ * Copy planes of 8 bits samples stored in 16 bits words (low byte first) to
+ * a planar 8 bits picture (GREY, I420, I422, I444...).
+ *
+ * width and height are the dimensions of the luma plane, the chroma planes
+ * dimensions are deduced from the dst chroma. Only the rows of the slice
+ * number slice out of slice_count are copied, so that the copy can be split
+ * across threads.
+ */
+void Copy16To8_P_to_P(picture_t *dst, const uint8_t *src[],
+                      const size_t src_pitch[], unsigned width,
+                      unsigned height, unsigned slice, unsigned slice_count);
+
 /**
  * Swap UV planes of a Tri Planars picture.
  *
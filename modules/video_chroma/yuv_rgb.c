@@ -0,0 +1,202 @@
+/*****************************************************************************
+ * yuv_rgb.c : Vectorized YUV 4:2:0 to RGB 32 bits conversions
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_cpu.h>
+
+#include "yuv_rgb_simd.h"
+
+static int  Create ( vlc_object_t * );
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+vlc_module_begin ()
+    set_description( N_("SSE4.1 and AVX2 I420,YV12,NV12,I0AL,P010 to "
+                        "RV32,RGBA,BGRA conversions") )
+    set_capability( "video converter", 200 )
+    set_callbacks( Create, NULL )
+vlc_module_end ()
+
+struct filter_sys_t
+{
+    yuv_rgb_coefs_t coefs;
+    yuv_rgb_row_t   pf_row;
+    bool            b_semiplanar;
+    bool            b_swap_uv;
+};
+
+/*****************************************************************************
+ * YUV 4:2:0 to RGB 32 bits
+ *****************************************************************************/
+static void YUV_RGB( filter_t *p_filter, picture_t *p_src, picture_t *p_dst )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const plane_t *p_y = &p_src->p[Y_PLANE];
+    const plane_t *p_u = &p_src->p[p_sys->b_swap_uv ? V_PLANE : U_PLANE];
+    const plane_t *p_v = p_sys->b_semiplanar ? p_u
+                       : &p_src->p[p_sys->b_swap_uv ? U_PLANE : V_PLANE];
+    const plane_t *p_rgb = &p_dst->p[0];
+    const unsigned i_width = p_src->format.i_x_offset
+                           + p_src->format.i_visible_width;
+    const unsigned i_height = p_src->format.i_y_offset
+                            + p_src->format.i_visible_height;
+
+    p_dst->format.i_x_offset = p_src->format.i_x_offset;
+    p_dst->format.i_y_offset = p_src->format.i_y_offset;
+
+    for( unsigned y = 0; y < i_height; y++ )
+        p_sys->pf_row( &p_rgb->p_pixels[y * p_rgb->i_pitch],
+                       &p_y->p_pixels[y * p_y->i_pitch],
+                       &p_u->p_pixels[y / 2 * p_u->i_pitch],
+                       &p_v->p_pixels[y / 2 * p_v->i_pitch],
+                       i_width, &p_sys->coefs );
+}
+
+VIDEO_FILTER_WRAPPER( YUV_RGB )
+
+/*****************************************************************************
+ * Create: allocate a chroma function
+ *****************************************************************************
+ * This function allocates and initializes a chroma function
+ *****************************************************************************/
+static int Create( vlc_object_t *p_this )
+{
+    filter_t *p_filter = (filter_t *)p_this;
+    const video_format_t *p_fmt_in = &p_filter->fmt_in.video;
+    const video_format_t *p_fmt_out = &p_filter->fmt_out.video;
+
+    /* resizing not supported */
+    if( p_fmt_in->i_x_offset + p_fmt_in->i_visible_width !=
+            p_fmt_out->i_x_offset + p_fmt_out->i_visible_width
+       || p_fmt_in->i_y_offset + p_fmt_in->i_visible_height !=
+            p_fmt_out->i_y_offset + p_fmt_out->i_visible_height
+       || p_fmt_in->orientation != p_fmt_out->orientation )
+        return VLC_EGENERIC;
+
+    bool b_bgr;
+
+    switch( p_fmt_out->i_chroma )
+    {
+        case VLC_CODEC_RGB32:
+            /* Native (little) endian masks, the default ones being B, G, R,
+             * X in memory */
+            if( ( p_fmt_out->i_rmask == 0x00ff0000
+               && p_fmt_out->i_gmask == 0x0000ff00
+               && p_fmt_out->i_bmask == 0x000000ff )
+             || ( p_fmt_out->i_rmask == 0
+               && p_fmt_out->i_gmask == 0
+               && p_fmt_out->i_bmask == 0 ) )
+                b_bgr = true;
+            else
+            if( p_fmt_out->i_rmask == 0x000000ff
+             && p_fmt_out->i_gmask == 0x0000ff00
+             && p_fmt_out->i_bmask == 0x00ff0000 )
+                b_bgr = false;
+            else
+                return VLC_EGENERIC;
+            break;
+        case VLC_CODEC_RGBA:
+            b_bgr = false;
+            break;
+        case VLC_CODEC_BGRA:
+            b_bgr = true;
+            break;
+        default:
+            return VLC_EGENERIC;
+    }
+
+    bool b_full_range = p_fmt_in->b_color_range_full;
+    bool b_semiplanar = false, b_swap_uv = false;
+    unsigned i_bits = 8, i_shift = 0;
+    yuv_rgb_row_t pf_row;
+
+    switch( p_fmt_in->i_chroma )
+    {
+#define ROW(f) ( vlc_CPU_AVX2() ? f ## _avx2 : f ## _sse4_1 )
+#if defined(HAVE_YUV_RGB_SSE4_1) && defined(HAVE_YUV_RGB_AVX2)
+        case VLC_CODEC_J420:
+            b_full_range = true;
+            /* fall through */
+        case VLC_CODEC_YV12:
+            b_swap_uv = p_fmt_in->i_chroma == VLC_CODEC_YV12;
+            /* fall through */
+        case VLC_CODEC_I420:
+            pf_row = ROW( yuv_rgb_i420 );
+            break;
+        case VLC_CODEC_NV12:
+            pf_row = ROW( yuv_rgb_nv12 );
+            b_semiplanar = true;
+            break;
+        case VLC_CODEC_I420_10L:
+            pf_row = ROW( yuv_rgb_i420_16 );
+            i_bits = 10;
+            break;
+        case VLC_CODEC_P010:
+            pf_row = ROW( yuv_rgb_p010 );
+            b_semiplanar = true;
+            i_bits = 10;
+            i_shift = 6;
+            break;
+#endif
+#undef ROW
+        default:
+            return VLC_EGENERIC;
+    }
+
+    if( !vlc_CPU_SSE4_1() )
+        return VLC_EGENERIC;
+
+    filter_sys_t *p_sys = vlc_obj_malloc( p_this, sizeof( *p_sys ) );
+    if( unlikely( !p_sys ) )
+        return VLC_ENOMEM;
+
+    video_color_space_t space = p_fmt_in->space;
+    if( space == COLOR_SPACE_UNDEF )
+        space = p_fmt_in->i_visible_height > 576 ? COLOR_SPACE_BT709
+                                                 : COLOR_SPACE_BT601;
+
+    yuv_rgb_SetupCoefs( &p_sys->coefs, space, b_full_range, i_bits, i_shift,
+                        b_bgr );
+    p_sys->pf_row = pf_row;
+    p_sys->b_semiplanar = b_semiplanar;
+    p_sys->b_swap_uv = b_swap_uv;
+
+    msg_Dbg( p_filter, "%4.4s to %4.4s using %s, space %d, %s range",
+             (const char *)&p_fmt_in->i_chroma,
+             (const char *)&p_fmt_out->i_chroma,
+             vlc_CPU_AVX2() ? "AVX2" : "SSE4.1", space,
+             b_full_range ? "full" : "limited" );
+
+    p_filter->p_sys = p_sys;
+    p_filter->pf_video_filter = YUV_RGB_Filter;
+    return VLC_SUCCESS;
+}
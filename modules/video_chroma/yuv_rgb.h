@@ -0,0 +1,183 @@
+/*****************************************************************************
+ * yuv_rgb.h: YUV 4:2:0 to RGB conversion functions
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_YUV_RGB_H
+#define VLC_YUV_RGB_H 1
+
+#include <math.h>
+
+#include <vlc_es.h>
+
+/* All the samples are first brought to 10 bits, then converted with 14-bit
+ * fixed point coefficients. The vectorized routines compute exactly the same
+ * thing in 16-bit (products in 32-bit) lanes, so that all the versions give
+ * the same pictures. */
+#define YUV_RGB_BITS 14
+
+typedef struct
+{
+    int16_t i_y_offset;     /**< black level, on 10 bits */
+    int16_t i_y;            /**< luma gain */
+    int16_t i_crv, i_cgu, i_cgv, i_cbu;
+    uint8_t i_shift;        /**< right shift of the 16-bit samples */
+    bool    b_bgr;          /**< B, G, R, A byte order instead of R, G, B, A */
+} yuv_rgb_coefs_t;
+
+/**
+ * Converts one line of pixels.
+ *
+ * \param u the U plane, or the interleaved UV plane of semiplanar chromas
+ * \param v the V plane, unused by semiplanar chromas
+ */
+typedef void (*yuv_rgb_row_t)(uint8_t *dst, const uint8_t *y,
+                              const uint8_t *u, const uint8_t *v,
+                              unsigned width, const yuv_rgb_coefs_t *c);
+
+static inline void yuv_rgb_SetupCoefs(yuv_rgb_coefs_t *c,
+                                      video_color_space_t space,
+                                      bool b_full_range, unsigned i_bits,
+                                      unsigned i_shift, bool b_bgr)
+{
+    double kr, kb;
+
+    switch (space)
+    {
+        case COLOR_SPACE_BT2020:
+            kr = 0.2627, kb = 0.0593;
+            break;
+        case COLOR_SPACE_BT709:
+            kr = 0.2126, kb = 0.0722;
+            break;
+        default:
+            kr = 0.299, kb = 0.114;
+            break;
+    }
+
+    const double kg = 1. - kr - kb;
+    double y_gain, c_gain;
+
+    if (b_full_range)
+    {   /* 8-bit samples are shifted to 0-1020, 10-bit ones are 0-1023 */
+        y_gain = c_gain = 255. / (i_bits > 8 ? 1023. : 1020.);
+        c->i_y_offset = 0;
+    }
+    else
+    {
+        y_gain = 255. / (219 << 2);
+        c_gain = 255. / (224 << 2);
+        c->i_y_offset = 16 << 2;
+    }
+
+    const double one = 1 << YUV_RGB_BITS;
+
+    c->i_y = lround(y_gain * one);
+    c->i_crv = lround(2. * (1. - kr) * c_gain * one);
+    c->i_cbu = lround(2. * (1. - kb) * c_gain * one);
+    c->i_cgu = lround(2. * kb * (1. - kb) / kg * c_gain * one);
+    c->i_cgv = lround(2. * kr * (1. - kr) / kg * c_gain * one);
+    c->i_shift = i_shift;
+    c->b_bgr = b_bgr;
+}
+
+static inline uint8_t yuv_rgb_clip(int v)
+{
+    return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+static inline void yuv_rgb_pixel(uint8_t *dst, int y, int u, int v,
+                                 const yuv_rgb_coefs_t *c)
+{
+    const int round = 1 << (YUV_RGB_BITS - 1);
+
+    y = (y - c->i_y_offset) * c->i_y;
+    u -= 512;
+    v -= 512;
+
+    const int r = (y + v * c->i_crv + round) >> YUV_RGB_BITS;
+    const int g = (y - u * c->i_cgu - v * c->i_cgv + round) >> YUV_RGB_BITS;
+    const int b = (y + u * c->i_cbu + round) >> YUV_RGB_BITS;
+
+    dst[c->b_bgr ? 2 : 0] = yuv_rgb_clip(r);
+    dst[1] = yuv_rgb_clip(g);
+    dst[c->b_bgr ? 0 : 2] = yuv_rgb_clip(b);
+    dst[3] = 0xFF;
+}
+
+static inline unsigned yuv_rgb_sample16(const uint8_t *p, unsigned i,
+                                        const yuv_rgb_coefs_t *c)
+{
+    const unsigned v = ((const uint16_t *)p)[i] >> c->i_shift;
+
+    return v < 1023 ? v : 1023;
+}
+
+/* Converts the pixels from x to the end of the line: the vectorized routines
+ * use it for the last pixels. */
+static inline void yuv_rgb_row_c(uint8_t *dst, const uint8_t *y,
+                                 const uint8_t *u, const uint8_t *v,
+                                 unsigned x, unsigned width,
+                                 const yuv_rgb_coefs_t *c,
+                                 bool b_16bit, bool b_semiplanar)
+{
+    for (; x < width; x++)
+    {
+        const unsigned cu = b_semiplanar ? x & ~1u : x / 2;
+        const unsigned cv = b_semiplanar ? x | 1u : x / 2;
+        const uint8_t *pv = b_semiplanar ? u : v;
+
+        if (b_16bit)
+            yuv_rgb_pixel(&dst[4 * x], yuv_rgb_sample16(y, x, c),
+                          yuv_rgb_sample16(u, cu, c),
+                          yuv_rgb_sample16(pv, cv, c), c);
+        else
+            yuv_rgb_pixel(&dst[4 * x], y[x] << 2, u[cu] << 2, pv[cv] << 2,
+                          c);
+    }
+}
+
+static inline void yuv_rgb_i420_c(uint8_t *dst, const uint8_t *y,
+                                  const uint8_t *u, const uint8_t *v,
+                                  unsigned width, const yuv_rgb_coefs_t *c)
+{
+    yuv_rgb_row_c(dst, y, u, v, 0, width, c, false, false);
+}
+
+static inline void yuv_rgb_nv12_c(uint8_t *dst, const uint8_t *y,
+                                  const uint8_t *uv, const uint8_t *v,
+                                  unsigned width, const yuv_rgb_coefs_t *c)
+{
+    yuv_rgb_row_c(dst, y, uv, v, 0, width, c, false, true);
+}
+
+static inline void yuv_rgb_i420_16_c(uint8_t *dst, const uint8_t *y,
+                                     const uint8_t *u, const uint8_t *v,
+                                     unsigned width, const yuv_rgb_coefs_t *c)
+{
+    yuv_rgb_row_c(dst, y, u, v, 0, width, c, true, false);
+}
+
+static inline void yuv_rgb_p010_c(uint8_t *dst, const uint8_t *y,
+                                  const uint8_t *uv, const uint8_t *v,
+                                  unsigned width, const yuv_rgb_coefs_t *c)
+{
+    yuv_rgb_row_c(dst, y, uv, v, 0, width, c, true, true);
+}
+
+#endif
@@ -0,0 +1,182 @@
+/*****************************************************************************
+ * yuv_rgb_simd.h: Vectorized YUV 4:2:0 to RGB conversion functions
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_YUV_RGB_SIMD_H
+#define VLC_YUV_RGB_SIMD_H 1
+
+#include <string.h>
+
+#include "yuv_rgb.h"
+
+#if defined(CAN_COMPILE_SSE4_1) || defined(CAN_COMPILE_AVX2)
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+
+#ifdef CAN_COMPILE_SSE4_1
+// ================= SSE4.1 =================
+#define HAVE_YUV_RGB_SSE4_1
+#define VLC_TARGET __attribute__((__target__("sse4.1")))
+#define RENAME(a) a ## _sse4_1
+
+VLC_TARGET
+static inline __m128i yuv_rgb_load32_sse4_1(const uint8_t *p)
+{
+    int32_t v;
+
+    memcpy(&v, p, sizeof (v));
+    return _mm_cvtsi32_si128(v);
+}
+
+#define VEC __m128i
+#define STEP 8
+#define V_LOAD_WIDEN8(p) _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(p)))
+#define V_LOAD_C8(p) _mm_cvtepu8_epi32(yuv_rgb_load32_sse4_1(p))
+#define V_LOAD16(p) _mm_loadu_si128((const __m128i *)(p))
+#define V_LOAD_C16(p) _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)(p)))
+#define V_STORE_PIXELS(p, lo, hi) do { \
+    _mm_storeu_si128((__m128i *)(p), lo); \
+    _mm_storeu_si128((__m128i *)(p) + 1, hi); \
+} while (0)
+#define V_SET16 _mm_set1_epi16
+#define V_SET32 _mm_set1_epi32
+#define V_AND _mm_and_si128
+#define V_OR _mm_or_si128
+#define V_SUB16 _mm_sub_epi16
+#define V_ADD32 _mm_add_epi32
+#define V_MIN16 _mm_min_epu16
+#define V_SLLI16 _mm_slli_epi16
+#define V_SRL16 _mm_srl_epi16
+#define V_SLLI32 _mm_slli_epi32
+#define V_SRLI32 _mm_srli_epi32
+#define V_SRAI32 _mm_srai_epi32
+#define V_MADD _mm_madd_epi16
+#define V_PACKS32 _mm_packs_epi32
+#define V_PACKUS16 _mm_packus_epi16
+#define V_UNPACKLO8 _mm_unpacklo_epi8
+#define V_UNPACKLO16 _mm_unpacklo_epi16
+#define V_UNPACKHI16 _mm_unpackhi_epi16
+#include "yuv_rgb_template.h"
+#undef V_UNPACKHI16
+#undef V_UNPACKLO16
+#undef V_UNPACKLO8
+#undef V_PACKUS16
+#undef V_PACKS32
+#undef V_MADD
+#undef V_SRAI32
+#undef V_SRLI32
+#undef V_SLLI32
+#undef V_SRL16
+#undef V_SLLI16
+#undef V_MIN16
+#undef V_ADD32
+#undef V_SUB16
+#undef V_OR
+#undef V_AND
+#undef V_SET32
+#undef V_SET16
+#undef V_STORE_PIXELS
+#undef V_LOAD_C16
+#undef V_LOAD16
+#undef V_LOAD_C8
+#undef V_LOAD_WIDEN8
+#undef STEP
+#undef VEC
+#undef RENAME
+#undef VLC_TARGET
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+// ================= AVX2 =================
+#define HAVE_YUV_RGB_AVX2
+#define VLC_TARGET __attribute__((__target__("avx2")))
+#define RENAME(a) a ## _avx2
+
+/* Packing and unpacking work within 128-bit lanes: the first lane ends up
+ * with pixels 0-3 and 4-7, the second one with pixels 8-11 and 12-15. */
+VLC_TARGET
+static inline void yuv_rgb_store_avx2(uint8_t *p, __m256i lo, __m256i hi)
+{
+    _mm256_storeu_si256((__m256i *)p, _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i *)p + 1,
+                        _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+#define VEC __m256i
+#define STEP 16
+#define V_LOAD_WIDEN8(p) \
+    _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(p)))
+#define V_LOAD_C8(p) \
+    _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(p)))
+#define V_LOAD16(p) _mm256_loadu_si256((const __m256i *)(p))
+#define V_LOAD_C16(p) \
+    _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(p)))
+#define V_STORE_PIXELS yuv_rgb_store_avx2
+#define V_SET16 _mm256_set1_epi16
+#define V_SET32 _mm256_set1_epi32
+#define V_AND _mm256_and_si256
+#define V_OR _mm256_or_si256
+#define V_SUB16 _mm256_sub_epi16
+#define V_ADD32 _mm256_add_epi32
+#define V_MIN16 _mm256_min_epu16
+#define V_SLLI16 _mm256_slli_epi16
+#define V_SRL16 _mm256_srl_epi16
+#define V_SLLI32 _mm256_slli_epi32
+#define V_SRLI32 _mm256_srli_epi32
+#define V_SRAI32 _mm256_srai_epi32
+#define V_MADD _mm256_madd_epi16
+#define V_PACKS32 _mm256_packs_epi32
+#define V_PACKUS16 _mm256_packus_epi16
+#define V_UNPACKLO8 _mm256_unpacklo_epi8
+#define V_UNPACKLO16 _mm256_unpacklo_epi16
+#define V_UNPACKHI16 _mm256_unpackhi_epi16
+#include "yuv_rgb_template.h"
+#undef V_UNPACKHI16
+#undef V_UNPACKLO16
+#undef V_UNPACKLO8
+#undef V_PACKUS16
+#undef V_PACKS32
+#undef V_MADD
+#undef V_SRAI32
+#undef V_SRLI32
+#undef V_SLLI32
+#undef V_SRL16
+#undef V_SLLI16
+#undef V_MIN16
+#undef V_ADD32
+#undef V_SUB16
+#undef V_OR
+#undef V_AND
+#undef V_SET32
+#undef V_SET16
+#undef V_STORE_PIXELS
+#undef V_LOAD_C16
+#undef V_LOAD16
+#undef V_LOAD_C8
+#undef V_LOAD_WIDEN8
+#undef STEP
+#undef VEC
+#undef RENAME
+#undef VLC_TARGET
+#endif
+
+#endif
+#endif
+
+#endif
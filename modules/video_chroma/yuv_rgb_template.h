@@ -0,0 +1,171 @@
+/*****************************************************************************
+ * yuv_rgb_template.h: Vectorized YUV 4:2:0 to RGB conversion template
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Included by yuv_rgb_simd.h, once per instruction set. STEP pixels are
+ * converted at a time, each sample in a 16-bit lane. The chroma loaders give
+ * one sample per 32-bit lane, which V_DUP spreads over both halves. */
+
+VLC_TARGET
+static inline VEC RENAME(yuv_rgb_pair)(int16_t lo, int16_t hi)
+{
+    return V_SET32((uint16_t)lo | ((uint32_t)(uint16_t)hi << 16));
+}
+
+VLC_TARGET
+static inline VEC RENAME(yuv_rgb_dup)(VEC d)
+{
+    return V_OR(d, V_SLLI32(d, 16));
+}
+
+VLC_TARGET
+static inline void RENAME(yuv_rgb_convert)(uint8_t *dst, VEC y, VEC u, VEC v,
+                                           const yuv_rgb_coefs_t *c)
+{
+    const VEC round = V_SET32(1 << (YUV_RGB_BITS - 1));
+    const VEC kr = RENAME(yuv_rgb_pair)(c->i_y, c->i_crv);
+    const VEC kgu = RENAME(yuv_rgb_pair)(c->i_y, -c->i_cgu);
+    const VEC kgv = RENAME(yuv_rgb_pair)(-c->i_cgv, 1 << (YUV_RGB_BITS - 1));
+    const VEC kb = RENAME(yuv_rgb_pair)(c->i_y, c->i_cbu);
+    const VEC one = V_SET16(1);
+
+    y = V_SUB16(y, V_SET16(c->i_y_offset));
+    u = V_SUB16(u, V_SET16(512));
+    v = V_SUB16(v, V_SET16(512));
+
+    const VEC yv_lo = V_UNPACKLO16(y, v), yv_hi = V_UNPACKHI16(y, v);
+    const VEC yu_lo = V_UNPACKLO16(y, u), yu_hi = V_UNPACKHI16(y, u);
+    const VEC v1_lo = V_UNPACKLO16(v, one), v1_hi = V_UNPACKHI16(v, one);
+
+    VEC r = V_PACKS32(
+        V_SRAI32(V_ADD32(V_MADD(yv_lo, kr), round), YUV_RGB_BITS),
+        V_SRAI32(V_ADD32(V_MADD(yv_hi, kr), round), YUV_RGB_BITS));
+    VEC g = V_PACKS32(
+        V_SRAI32(V_ADD32(V_MADD(yu_lo, kgu), V_MADD(v1_lo, kgv)),
+                 YUV_RGB_BITS),
+        V_SRAI32(V_ADD32(V_MADD(yu_hi, kgu), V_MADD(v1_hi, kgv)),
+                 YUV_RGB_BITS));
+    VEC b = V_PACKS32(
+        V_SRAI32(V_ADD32(V_MADD(yu_lo, kb), round), YUV_RGB_BITS),
+        V_SRAI32(V_ADD32(V_MADD(yu_hi, kb), round), YUV_RGB_BITS));
+
+    if (c->b_bgr)
+    {
+        VEC t = r;
+        r = b;
+        b = t;
+    }
+
+    /* Only the low half of each 128-bit lane of the bytes is used */
+    r = V_PACKUS16(r, r);
+    g = V_PACKUS16(g, g);
+    b = V_PACKUS16(b, b);
+
+    const VEC rg = V_UNPACKLO8(r, g);
+    const VEC ba = V_UNPACKLO8(b, V_SET16(-1));
+
+    V_STORE_PIXELS(dst, V_UNPACKLO16(rg, ba), V_UNPACKHI16(rg, ba));
+}
+
+VLC_TARGET
+static void RENAME(yuv_rgb_i420)(uint8_t *dst, const uint8_t *py,
+                                 const uint8_t *pu, const uint8_t *pv,
+                                 unsigned width, const yuv_rgb_coefs_t *c)
+{
+    unsigned x = 0;
+
+    for (; x + STEP <= width; x += STEP)
+    {
+        VEC y = V_SLLI16(V_LOAD_WIDEN8(py + x), 2);
+        VEC u = V_SLLI16(RENAME(yuv_rgb_dup)(V_LOAD_C8(pu + x / 2)), 2);
+        VEC v = V_SLLI16(RENAME(yuv_rgb_dup)(V_LOAD_C8(pv + x / 2)), 2);
+
+        RENAME(yuv_rgb_convert)(dst + 4 * x, y, u, v, c);
+    }
+    yuv_rgb_row_c(dst, py, pu, pv, x, width, c, false, false);
+}
+
+VLC_TARGET
+static void RENAME(yuv_rgb_nv12)(uint8_t *dst, const uint8_t *py,
+                                 const uint8_t *puv, const uint8_t *pv,
+                                 unsigned width, const yuv_rgb_coefs_t *c)
+{
+    const VEC mask = V_SET32(0xFFFF);
+    unsigned x = 0;
+
+    for (; x + STEP <= width; x += STEP)
+    {
+        VEC y = V_SLLI16(V_LOAD_WIDEN8(py + x), 2);
+        VEC uv = V_SLLI16(V_LOAD_WIDEN8(puv + x), 2);
+        VEC u = RENAME(yuv_rgb_dup)(V_AND(uv, mask));
+        VEC v = RENAME(yuv_rgb_dup)(V_SRLI32(uv, 16));
+
+        RENAME(yuv_rgb_convert)(dst + 4 * x, y, u, v, c);
+    }
+    yuv_rgb_row_c(dst, py, puv, pv, x, width, c, false, true);
+}
+
+VLC_TARGET
+static void RENAME(yuv_rgb_i420_16)(uint8_t *dst, const uint8_t *py,
+                                    const uint8_t *pu, const uint8_t *pv,
+                                    unsigned width, const yuv_rgb_coefs_t *c)
+{
+    const __m128i shift = _mm_cvtsi32_si128(c->i_shift);
+    const VEC max = V_SET16(1023);
+    unsigned x = 0;
+
+    for (; x + STEP <= width; x += STEP)
+    {
+        VEC y = V_LOAD16((const uint16_t *)py + x);
+        VEC u = RENAME(yuv_rgb_dup)(V_LOAD_C16((const uint16_t *)pu + x / 2));
+        VEC v = RENAME(yuv_rgb_dup)(V_LOAD_C16((const uint16_t *)pv + x / 2));
+
+        y = V_MIN16(V_SRL16(y, shift), max);
+        u = V_MIN16(V_SRL16(u, shift), max);
+        v = V_MIN16(V_SRL16(v, shift), max);
+        RENAME(yuv_rgb_convert)(dst + 4 * x, y, u, v, c);
+    }
+    yuv_rgb_row_c(dst, py, pu, pv, x, width, c, true, false);
+}
+
+VLC_TARGET
+static void RENAME(yuv_rgb_p010)(uint8_t *dst, const uint8_t *py,
+                                 const uint8_t *puv, const uint8_t *pv,
+                                 unsigned width, const yuv_rgb_coefs_t *c)
+{
+    const __m128i shift = _mm_cvtsi32_si128(c->i_shift);
+    const VEC max = V_SET16(1023);
+    const VEC mask = V_SET32(0xFFFF);
+    unsigned x = 0;
+
+    for (; x + STEP <= width; x += STEP)
+    {
+        VEC y = V_LOAD16((const uint16_t *)py + x);
+        VEC uv = V_LOAD16((const uint16_t *)puv + x);
+
+        y = V_MIN16(V_SRL16(y, shift), max);
+        uv = V_MIN16(V_SRL16(uv, shift), max);
+
+        VEC u = RENAME(yuv_rgb_dup)(V_AND(uv, mask));
+        VEC v = RENAME(yuv_rgb_dup)(V_SRLI32(uv, 16));
+
+        RENAME(yuv_rgb_convert)(dst + 4 * x, y, u, v, c);
+    }
+    yuv_rgb_row_c(dst, py, puv, pv, x, width, c, true, true);
+}
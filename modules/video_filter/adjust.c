@@ -49,6 +49,8 @@ static int  Create    ( vlc_object_t * );
 static void Destroy   ( vlc_object_t * );
 
 static picture_t *FilterPlanar( filter_t *, picture_t * );
+static void FilterPlanarSlice( filter_t *, picture_t *, const picture_t *,
+                               unsigned, unsigned );
 static picture_t *FilterPacked( filter_t *, picture_t * );
 static int AdjustCallback( vlc_object_t *p_this, char const *psz_var,
                            vlc_value_t oldval, vlc_value_t newval,
@@ -123,6 +125,12 @@ struct filter_sys_t
                                int, int );
     int (*pf_process_sat_hue_clip)( picture_t *, picture_t *, int, int,
                                     int, int, int );
+
+    /* Parameters of the planar picture being filtered */
+    bool b_16bit;
+    int pi_luma[1024]; /* the full range will only be used for 10-bit */
+    int i_sin, i_cos, i_sat, i_x, i_y;
+    bool b_sat_clip;
 };
 
 /*****************************************************************************
@@ -152,6 +160,7 @@ static int Create( vlc_object_t *p_this )
         CASE_PLANAR_YUV
             /* Planar YUV */
             p_filter->pf_video_filter = FilterPlanar;
+            p_filter->pf_video_slice = FilterPlanarSlice;
             p_sys->pf_process_sat_hue_clip = planar_sat_hue_clip_C;
             p_sys->pf_process_sat_hue = planar_sat_hue_C;
             break;
@@ -160,6 +169,7 @@ static int Create( vlc_object_t *p_this )
         CASE_PLANAR_YUV9
             /* Planar YUV 9-bit or 10-bit */
             p_filter->pf_video_filter = FilterPlanar;
+            p_filter->pf_video_slice = FilterPlanarSlice;
             p_sys->pf_process_sat_hue_clip = planar_sat_hue_clip_C_16;
             p_sys->pf_process_sat_hue = planar_sat_hue_C_16;
             break;
@@ -230,13 +240,12 @@ static void Destroy( vlc_object_t *p_this )
  *****************************************************************************/
 static picture_t *FilterPlanar( filter_t *p_filter, picture_t *p_pic )
 {
-    /* The full range will only be used for 10-bit */
-    int pi_luma[1024];
     int pi_gamma[1024];
 
     picture_t *p_outpic;
 
     filter_sys_t *p_sys = p_filter->p_sys;
+    int *pi_luma = p_sys->pi_luma;
 
     if( !p_pic ) return NULL;
 
@@ -316,6 +325,55 @@ static picture_t *FilterPlanar( filter_t *p_filter, picture_t *p_pic )
         i_sat = 0;
     }
 
+    /*
+     * Prepare the U and V planes
+     */
+
+    p_sys->b_16bit = b_16bit;
+    p_sys->i_sat = i_sat;
+    p_sys->i_sin = sinf(f_hue) * f_max;
+    p_sys->i_cos = cosf(f_hue) * f_max;
+
+    /* pow(2, (bpp * 2) - 1) */
+    p_sys->i_x = ( cosf(f_hue) + sinf(f_hue) ) * f_range * i_mid;
+    p_sys->i_y = ( cosf(f_hue) - sinf(f_hue) ) * f_range * i_mid;
+    p_sys->b_sat_clip = i_sat > i_range;
+
+    filter_SliceVideo( p_filter, p_outpic, p_pic );
+
+    return CopyInfoAndRelease( p_outpic, p_pic );
+}
+
+/* Restricts the planes of a picture to a band of lines */
+static void PictureBand( picture_t *p_band, const picture_t *p_pic,
+                         const picture_t *p_ref,
+                         unsigned i_first, unsigned i_lines )
+{
+    *p_band = *p_pic;
+    for( int i = 0; i < p_pic->i_planes; i++ )
+    {
+        unsigned i_line = i_first, i_count = i_lines;
+
+        filter_SlicePlane( p_ref, i, &i_line, &i_count );
+        p_band->p[i].p_pixels += i_line * p_band->p[i].i_pitch;
+        p_band->p[i].i_lines = i_count;
+        p_band->p[i].i_visible_lines = i_count;
+    }
+}
+
+static void FilterPlanarSlice( filter_t *p_filter, picture_t *p_outpic_full,
+                               const picture_t *p_pic_full,
+                               unsigned i_first, unsigned i_lines )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const int *pi_luma = p_sys->pi_luma;
+    const bool b_16bit = p_sys->b_16bit;
+    picture_t pic, outpic;
+    picture_t *p_pic = &pic, *p_outpic = &outpic;
+
+    PictureBand( p_pic, p_pic_full, p_outpic_full, i_first, i_lines );
+    PictureBand( p_outpic, p_outpic_full, p_outpic_full, i_first, i_lines );
+
     /*
      * Do the Y plane
      */
@@ -396,29 +454,22 @@ static picture_t *FilterPlanar( filter_t *p_filter, picture_t *p_pic )
      * Do the U and V planes
      */
 
-    int i_sin = sinf(f_hue) * f_max;
-    int i_cos = cosf(f_hue) * f_max;
-
-    /* pow(2, (bpp * 2) - 1) */
-    int i_x = ( cosf(f_hue) + sinf(f_hue) ) * f_range * i_mid;
-    int i_y = ( cosf(f_hue) - sinf(f_hue) ) * f_range * i_mid;
-
-    if ( i_sat > i_range )
+    if ( p_sys->b_sat_clip )
     {
         /* Currently no errors are implemented in the function, if any are added
          * check them here */
-        p_sys->pf_process_sat_hue_clip( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                        i_x, i_y );
+        p_sys->pf_process_sat_hue_clip( p_pic, p_outpic, p_sys->i_sin,
+                                        p_sys->i_cos, p_sys->i_sat,
+                                        p_sys->i_x, p_sys->i_y );
     }
     else
     {
         /* Currently no errors are implemented in the function, if any are added
          * check them here */
-        p_sys->pf_process_sat_hue( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                        i_x, i_y );
+        p_sys->pf_process_sat_hue( p_pic, p_outpic, p_sys->i_sin,
+                                   p_sys->i_cos, p_sys->i_sat,
+                                   p_sys->i_x, p_sys->i_y );
     }
-
-    return CopyInfoAndRelease( p_outpic, p_pic );
 }
 
 /*****************************************************************************
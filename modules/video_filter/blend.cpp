@@ -32,7 +32,9 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
 #include "filter_picture.h"
+#include "blend_simd.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -40,9 +42,16 @@
 static int  Open (vlc_object_t *);
 static void Close(vlc_object_t *);
 
+#define SIMD_TEXT N_("Vectorized blending")
+#define SIMD_LONGTEXT N_("Use the SIMD blending routines for the most " \
+                         "common chromas, if the CPU supports them.")
+
 vlc_module_begin()
     set_description(N_("Video pictures blending"))
+    set_category(CAT_VIDEO)
+    set_subcategory(SUBCAT_VIDEO_SUBPIC)
     set_capability("video blending", 100)
+    add_bool("blend-simd", true, SIMD_TEXT, SIMD_LONGTEXT, true)
     set_callbacks(Open, Close)
 vlc_module_end()
 
@@ -140,7 +149,6 @@ public:
         if (has_alpha)
             data[3] += picture->p[3].i_pitch;
     }
-private:
     pixel *getPointer(unsigned plane, unsigned dx) const
     {
         if (plane == 1 || plane == 2)
@@ -148,6 +156,7 @@ private:
         else
             return (pixel*)&data[plane][(x + dx) /  1 * sizeof(pixel)];
     }
+private:
     uint8_t *data[4];
 };
 
@@ -186,7 +195,6 @@ public:
         if ((y % 2) == 0)
             data[1] += picture->p[1].i_pitch;
     }
-private:
     uint8_t *getPointer(unsigned plane, unsigned dx) const
     {
         if (plane == 0)
@@ -194,6 +202,7 @@ private:
         else
             return &data[plane][(x + dx) / 2 * 2];
     }
+private:
     uint8_t *data[2];
 };
 
@@ -332,11 +341,17 @@ public:
         y++;
         data += picture->p[0].i_pitch;
     }
-private:
     uint8_t *getPointer(unsigned dx) const
     {
         return &data[(x + dx) * bytes];
     }
+    void getOffsets(unsigned *r, unsigned *g, unsigned *b) const
+    {
+        *r = offset_r;
+        *g = offset_g;
+        *b = offset_b;
+    }
+private:
     unsigned offset_r;
     unsigned offset_g;
     unsigned offset_b;
@@ -519,6 +534,27 @@ private:
     G g;
 };
 
+template <class TDst, class TSrc, class TConvert>
+void BlendPixels(TDst &dst, const TSrc &src, TConvert &convert,
+                 unsigned from, unsigned to, int alpha)
+{
+    for (unsigned x = from; x < to; x++) {
+        CPixel spx;
+
+        src.get(&spx, x);
+        convert(spx);
+
+        unsigned a = div255(alpha * spx.a);
+        if (a <= 0)
+            continue;
+
+        if (dst.isFull(x))
+            dst.merge(x, spx, a, true);
+        else
+            dst.merge(x, spx, a, false);
+    }
+}
+
 template <class TDst, class TSrc, class TConvert>
 void Blend(const CPicture &dst_data, const CPicture &src_data,
            unsigned width, unsigned height, int alpha)
@@ -528,26 +564,168 @@ void Blend(const CPicture &dst_data, const CPicture &src_data,
     TConvert convert(dst_data.getFormat(), src_data.getFormat());
 
     for (unsigned y = 0; y < height; y++) {
-        for (unsigned x = 0; x < width; x++) {
-            CPixel spx;
+        BlendPixels(dst, src, convert, 0, width, alpha);
+        src.nextLine();
+        dst.nextLine();
+    }
+}
 
-            src.get(&spx, x);
-            convert(spx);
+#ifdef HAVE_BLEND_SIMD
+/* Blends the middle of the lines with vector code (TRow), and the pixels
+ * that it leaves with the generic code. */
+template <class TDst, class TSrc, class TConvert, class TRow>
+void BlendRows(const CPicture &dst_data, const CPicture &src_data,
+               unsigned width, unsigned height, int alpha)
+{
+    TSrc src(src_data);
+    TDst dst(dst_data);
+    TConvert convert(dst_data.getFormat(), src_data.getFormat());
+    TRow row(dst);
 
-            unsigned a = div255(alpha * spx.a);
-            if (a <= 0)
-                continue;
+    for (unsigned y = 0; y < height; y++) {
+        /* Start the vector code on a pixel with chroma, if the line has any */
+        unsigned x = !dst.isFull(0) && dst.isFull(1);
 
-            if (dst.isFull(x))
-                dst.merge(x, spx, a, true);
-            else
-                dst.merge(x, spx, a, false);
-        }
+        BlendPixels(dst, src, convert, 0, x, alpha);
+        x += row(dst, src, x, width - x, alpha, dst.isFull(x));
+        BlendPixels(dst, src, convert, x, width, alpha);
         src.nextLine();
         dst.nextLine();
     }
 }
 
+typedef unsigned (*blend_yuva_420_t)(uint8_t *, uint8_t *, uint8_t *,
+                                     const uint8_t *const [4],
+                                     unsigned, unsigned, bool);
+typedef unsigned (*blend_yuva_nv12_t)(uint8_t *, uint8_t *,
+                                      const uint8_t *const [4],
+                                      unsigned, unsigned, bool);
+typedef unsigned (*blend_yuva_420_10_t)(uint16_t *, uint16_t *, uint16_t *,
+                                        const uint8_t *const [4],
+                                        unsigned, unsigned, bool);
+typedef unsigned (*blend_rgba_rgb32_t)(uint8_t *, const uint8_t *,
+                                       unsigned, unsigned, const uint8_t [32]);
+
+/* Best kernel for the CPU, or NULL */
+#ifdef HAVE_BLEND_AVX2
+# define SIMD_AVX2(f) vlc_CPU_AVX2() ? f ## _avx2 :
+#else
+# define SIMD_AVX2(f)
+#endif
+#ifdef HAVE_BLEND_SSE4_1
+# define SIMD_SSE4_1(f) vlc_CPU_SSE4_1() ? f ## _sse4_1 :
+#else
+# define SIMD_SSE4_1(f)
+#endif
+#define SIMD_KERNEL(f) (SIMD_AVX2(f) SIMD_SSE4_1(f) NULL)
+
+static void getPlanes(const uint8_t *planes[4],
+                      const CPictureYUVA &src, unsigned x)
+{
+    for (unsigned i = 0; i < 4; i++)
+        planes[i] = src.getPointer(i, x);
+}
+
+struct rowYuvaTo420 {
+    template <class TDst>
+    rowYuvaTo420(const TDst &) : kernel(SIMD_KERNEL(blend_yuva_420)) {}
+    template <class TDst>
+    unsigned operator()(TDst &dst, const CPictureYUVA &src, unsigned x,
+                        unsigned count, int alpha, bool chroma) const
+    {
+        const uint8_t *planes[4];
+
+        if (!kernel)
+            return 0;
+        getPlanes(planes, src, x);
+        return kernel(dst.getPointer(0, x), dst.getPointer(1, x),
+                      dst.getPointer(2, x), planes, count, alpha, chroma);
+    }
+private:
+    blend_yuva_420_t kernel;
+};
+
+template <bool swap_uv>
+struct rowYuvaToSemiPlanar {
+    rowYuvaToSemiPlanar(const CPictureYUVSemiPlanar<swap_uv> &)
+        : kernel(SIMD_KERNEL(blend_yuva_nv12)) {}
+    unsigned operator()(CPictureYUVSemiPlanar<swap_uv> &dst,
+                        const CPictureYUVA &src, unsigned x,
+                        unsigned count, int alpha, bool chroma) const
+    {
+        const uint8_t *planes[4];
+
+        if (!kernel)
+            return 0;
+        getPlanes(planes, src, x);
+        if (swap_uv) {
+            const uint8_t *u = planes[1];
+            planes[1] = planes[2];
+            planes[2] = u;
+        }
+        return kernel(dst.getPointer(0, x), dst.getPointer(1, x),
+                      planes, count, alpha, chroma);
+    }
+private:
+    blend_yuva_nv12_t kernel;
+};
+
+struct rowYuvaTo420_10 {
+    rowYuvaTo420_10(const CPictureI420_16 &)
+        : kernel(SIMD_KERNEL(blend_yuva_420_10)) {}
+    unsigned operator()(CPictureI420_16 &dst, const CPictureYUVA &src,
+                        unsigned x, unsigned count, int alpha,
+                        bool chroma) const
+    {
+        const uint8_t *planes[4];
+
+        if (!kernel)
+            return 0;
+        getPlanes(planes, src, x);
+        return kernel(dst.getPointer(0, x), dst.getPointer(1, x),
+                      dst.getPointer(2, x), planes, count, alpha, chroma);
+    }
+private:
+    blend_yuva_420_10_t kernel;
+};
+
+struct rowRgbaToRgb32 {
+    rowRgbaToRgb32(const CPictureRGB32 &dst)
+        : kernel(SIMD_KERNEL(blend_rgba_rgb32))
+    {
+        unsigned offset[3];
+
+        dst.getOffsets(&offset[0], &offset[1], &offset[2]);
+        memset(shuffle, 0xFF, sizeof(shuffle));
+        for (unsigned i = 0; i < 3; i++) {
+            if (offset[i] >= 4 || shuffle[offset[i]] != 0xFF) {
+                kernel = NULL; /* not a byte per component */
+                return;
+            }
+            for (unsigned p = 0; p < 16; p += 4) {
+                shuffle[p + offset[i]] = p + i;
+                shuffle[16 + p + offset[i]] = p + 3;
+            }
+        }
+    }
+    unsigned operator()(CPictureRGB32 &dst, const CPictureRGBA &src,
+                        unsigned x, unsigned count, int alpha, bool) const
+    {
+        if (!kernel)
+            return 0;
+        return kernel(dst.getPointer(x), src.getPointer(x), count, alpha,
+                      shuffle);
+    }
+private:
+    blend_rgba_rgb32_t kernel;
+    uint8_t shuffle[32];
+};
+
+#undef SIMD_KERNEL
+#undef SIMD_SSE4_1
+#undef SIMD_AVX2
+#endif
+
 typedef void (*blend_function_t)(const CPicture &dst_data, const CPicture &src_data,
                                  unsigned width, unsigned height, int alpha);
 
@@ -623,6 +801,35 @@ static const struct {
 #undef YUV
 };
 
+#ifdef HAVE_BLEND_SIMD
+static const struct {
+    vlc_fourcc_t     dst;
+    vlc_fourcc_t     src;
+    blend_function_t blend;
+} fast_blends[] = {
+#define YUVA(csp, picture, cvt, row) \
+    { csp, VLC_CODEC_YUVA, \
+      BlendRows<picture, CPictureYUVA, compose<cvt, convertNone>, row> }
+
+    YUVA(VLC_CODEC_YV12,     CPictureYV12,    convertNone, rowYuvaTo420),
+    YUVA(VLC_CODEC_J420,     CPictureI420_8,  convertNone, rowYuvaTo420),
+    YUVA(VLC_CODEC_I420,     CPictureI420_8,  convertNone, rowYuvaTo420),
+    YUVA(VLC_CODEC_NV12,     CPictureNV12,    convertNone,
+         rowYuvaToSemiPlanar<false>),
+    YUVA(VLC_CODEC_NV21,     CPictureNV21,    convertNone,
+         rowYuvaToSemiPlanar<true>),
+#ifndef WORDS_BIGENDIAN
+    YUVA(VLC_CODEC_I420_10L, CPictureI420_16, convert8To10Bits,
+         rowYuvaTo420_10),
+#endif
+    { VLC_CODEC_RGB32, VLC_CODEC_RGBA,
+      BlendRows<CPictureRGB32, CPictureRGBA,
+                compose<convertNone, convertNone>, rowRgbaToRgb32> },
+
+#undef YUVA
+};
+#endif
+
 struct filter_sys_t {
     filter_sys_t() : blend(NULL)
     {
@@ -675,6 +882,14 @@ static int Open(vlc_object_t *object)
         if (blends[i].src == src && blends[i].dst == dst)
             sys->blend = blends[i].blend;
     }
+#ifdef HAVE_BLEND_SIMD
+    if (var_InheritBool(filter, "blend-simd")) {
+        for (size_t i = 0; i < sizeof(fast_blends) / sizeof(*fast_blends); i++) {
+            if (fast_blends[i].src == src && fast_blends[i].dst == dst)
+                sys->blend = fast_blends[i].blend;
+        }
+    }
+#endif
 
     if (!sys->blend) {
        msg_Err(filter, "no matching alpha blending routine (chroma: %4.4s -> %4.4s)",
@@ -0,0 +1,196 @@
+/*****************************************************************************
+ * blend_simd.h: Vectorized blending functions
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_BLEND_SIMD_H
+#define VLC_BLEND_SIMD_H 1
+
+#if defined(CAN_COMPILE_SSE4_1) || defined(CAN_COMPILE_AVX2)
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+
+#ifdef CAN_COMPILE_SSE4_1
+// ================= SSE4.1 =================
+#define HAVE_BLEND_SSE4_1
+#define VLC_TARGET __attribute__((__target__("sse4.1")))
+#define RENAME(a) a ## _sse4_1
+
+VLC_TARGET
+static inline __m128i blend_merge_wide_sse4_1(__m128i d, __m128i s, __m128i a)
+{
+    const __m128i f = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(d, s),
+                                _mm_unpacklo_epi16(f, a));
+    __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(d, s),
+                                _mm_unpackhi_epi16(f, a));
+
+    lo = _mm_add_epi32(_mm_add_epi32(lo, _mm_srli_epi32(lo, 8)),
+                       _mm_set1_epi32(1));
+    hi = _mm_add_epi32(_mm_add_epi32(hi, _mm_srli_epi32(hi, 8)),
+                       _mm_set1_epi32(1));
+    return _mm_packus_epi32(_mm_srli_epi32(lo, 8), _mm_srli_epi32(hi, 8));
+}
+
+#define VEC __m128i
+#define BVEC __m128i
+#define STEP 8
+#define B_LOAD(p) _mm_loadl_epi64((const __m128i *)(p))
+#define B_SHUFFLE _mm_shuffle_epi8
+#define V_WIDEN _mm_cvtepu8_epi16
+#define V_LOAD8(p) V_WIDEN(B_LOAD(p))
+#define V_STORE8(p, v) \
+    _mm_storel_epi64((__m128i *)(p), _mm_packus_epi16(v, v))
+#define V_LOAD16(p) _mm_loadu_si128((const __m128i *)(p))
+#define V_STORE16(p, v) _mm_storeu_si128((__m128i *)(p), v)
+#define V_LOAD_EVEN8(p) \
+    _mm_and_si128(_mm_loadu_si128((const __m128i *)(p)), _mm_set1_epi16(0xFF))
+#define V_LOAD_UV(p, u, v) do { \
+    __m128i uv_ = _mm_loadu_si128((const __m128i *)(p)); \
+    u = _mm_and_si128(uv_, _mm_set1_epi16(0xFF)); \
+    v = _mm_srli_epi16(uv_, 8); \
+} while (0)
+#define V_STORE_UV(p, u, v) \
+    _mm_storeu_si128((__m128i *)(p), _mm_or_si128(u, _mm_slli_epi16(v, 8)))
+#define V_ADD _mm_add_epi16
+#define V_SUB _mm_sub_epi16
+#define V_MUL _mm_mullo_epi16
+#define V_SHL _mm_slli_epi16
+#define V_SHR _mm_srli_epi16
+#define V_SET1 _mm_set1_epi16
+#define V_MERGE_WIDE blend_merge_wide_sse4_1
+#define V_SELECT_ZERO(a, d, m) \
+    _mm_blendv_epi8(m, d, _mm_cmpeq_epi16(a, _mm_setzero_si128()))
+#include "blend_template.h"
+#undef V_SELECT_ZERO
+#undef V_MERGE_WIDE
+#undef V_SET1
+#undef V_SHR
+#undef V_SHL
+#undef V_MUL
+#undef V_SUB
+#undef V_ADD
+#undef V_STORE_UV
+#undef V_LOAD_UV
+#undef V_LOAD_EVEN8
+#undef V_STORE16
+#undef V_LOAD16
+#undef V_STORE8
+#undef V_LOAD8
+#undef V_WIDEN
+#undef B_SHUFFLE
+#undef B_LOAD
+#undef STEP
+#undef BVEC
+#undef VEC
+#undef RENAME
+#undef VLC_TARGET
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+// ================= AVX2 =================
+#define HAVE_BLEND_AVX2
+#define VLC_TARGET __attribute__((__target__("avx2")))
+#define RENAME(a) a ## _avx2
+
+VLC_TARGET
+static inline __m256i blend_merge_wide_avx2(__m256i d, __m256i s, __m256i a)
+{
+    /* Unpacking and packing both work within 128-bit lanes, so the pixels
+     * end up in their original order. */
+    const __m256i f = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+    __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(d, s),
+                                   _mm256_unpacklo_epi16(f, a));
+    __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(d, s),
+                                   _mm256_unpackhi_epi16(f, a));
+
+    lo = _mm256_add_epi32(_mm256_add_epi32(lo, _mm256_srli_epi32(lo, 8)),
+                          _mm256_set1_epi32(1));
+    hi = _mm256_add_epi32(_mm256_add_epi32(hi, _mm256_srli_epi32(hi, 8)),
+                          _mm256_set1_epi32(1));
+    return _mm256_packus_epi32(_mm256_srli_epi32(lo, 8),
+                               _mm256_srli_epi32(hi, 8));
+}
+
+#define VEC __m256i
+#define BVEC __m128i
+#define STEP 16
+#define B_LOAD(p) _mm_loadu_si128((const __m128i *)(p))
+#define B_SHUFFLE _mm_shuffle_epi8
+#define V_WIDEN _mm256_cvtepu8_epi16
+#define V_LOAD8(p) V_WIDEN(B_LOAD(p))
+#define V_STORE8(p, v) \
+    _mm_storeu_si128((__m128i *)(p), \
+                     _mm_packus_epi16(_mm256_castsi256_si128(v), \
+                                      _mm256_extracti128_si256(v, 1)))
+#define V_LOAD16(p) _mm256_loadu_si256((const __m256i *)(p))
+#define V_STORE16(p, v) _mm256_storeu_si256((__m256i *)(p), v)
+#define V_LOAD_EVEN8(p) \
+    _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(p)), \
+                     _mm256_set1_epi16(0xFF))
+#define V_LOAD_UV(p, u, v) do { \
+    __m256i uv_ = _mm256_loadu_si256((const __m256i *)(p)); \
+    u = _mm256_and_si256(uv_, _mm256_set1_epi16(0xFF)); \
+    v = _mm256_srli_epi16(uv_, 8); \
+} while (0)
+#define V_STORE_UV(p, u, v) \
+    _mm256_storeu_si256((__m256i *)(p), \
+                        _mm256_or_si256(u, _mm256_slli_epi16(v, 8)))
+#define V_ADD _mm256_add_epi16
+#define V_SUB _mm256_sub_epi16
+#define V_MUL _mm256_mullo_epi16
+#define V_SHL _mm256_slli_epi16
+#define V_SHR _mm256_srli_epi16
+#define V_SET1 _mm256_set1_epi16
+#define V_MERGE_WIDE blend_merge_wide_avx2
+#define V_SELECT_ZERO(a, d, m) \
+    _mm256_blendv_epi8(m, d, _mm256_cmpeq_epi16(a, _mm256_setzero_si256()))
+#include "blend_template.h"
+#undef V_SELECT_ZERO
+#undef V_MERGE_WIDE
+#undef V_SET1
+#undef V_SHR
+#undef V_SHL
+#undef V_MUL
+#undef V_SUB
+#undef V_ADD
+#undef V_STORE_UV
+#undef V_LOAD_UV
+#undef V_LOAD_EVEN8
+#undef V_STORE16
+#undef V_LOAD16
+#undef V_STORE8
+#undef V_LOAD8
+#undef V_WIDEN
+#undef B_SHUFFLE
+#undef B_LOAD
+#undef STEP
+#undef BVEC
+#undef VEC
+#undef RENAME
+#undef VLC_TARGET
+#endif
+
+#endif
+#endif
+
+#if defined(HAVE_BLEND_SSE4_1) || defined(HAVE_BLEND_AVX2)
+# define HAVE_BLEND_SIMD
+#endif
+
+#endif
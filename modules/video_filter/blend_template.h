@@ -0,0 +1,195 @@
+/*****************************************************************************
+ * blend_template.h: Vectorized blending of YUVA and RGBA pictures
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Vector versions of the div255() and merge() functions of blend.cpp, with
+ * 8-bit pixels in 16-bit lanes, so that the output is bit-exact with the
+ * generic code. Each function blends the longest multiple of 2 * STEP pixels
+ * (STEP / 2 pixels for RGB) of a line, and returns that number of pixels.
+ * The caller blends the remaining pixels. The first pixel must have chroma
+ * samples when chroma is true.
+ *
+ * The includer defines:
+ *  - RENAME(a), VLC_TARGET,
+ *  - VEC, the vector type with STEP 16-bit lanes, and BVEC, the vector type
+ *    with (at least) STEP 8-bit lanes,
+ *  - B_LOAD(p) to load STEP bytes, B_SHUFFLE(b, m) to shuffle bytes (out of
+ *    range indices give zero) and V_WIDEN(b) to convert bytes to lanes,
+ *  - V_LOAD8(p), V_STORE8(p, v) to convert 8-bit pixels from/to lanes,
+ *  - V_LOAD16(p), V_STORE16(p, v) for 16-bit pixels,
+ *  - V_LOAD_EVEN8(p) to load the even bytes of 2 * STEP bytes,
+ *  - V_LOAD_UV(p, u, v), V_STORE_UV(p, u, v) for interleaved bytes,
+ *  - V_ADD, V_SUB, V_MUL, V_SHL, V_SHR, V_SET1,
+ *  - V_MERGE_WIDE(d, s, a), merge() with 32-bit intermediates,
+ *  - V_SELECT_ZERO(a, d, m), (a == 0) ? d : m. */
+
+VLC_TARGET
+static inline VEC RENAME(div255)(VEC v)
+{
+    return V_SHR(V_ADD(V_ADD(v, V_SHR(v, 8)), V_SET1(1)), 8);
+}
+
+VLC_TARGET
+static inline VEC RENAME(merge)(VEC dst, VEC src, VEC a)
+{
+    return RENAME(div255)(V_ADD(V_MUL(V_SUB(V_SET1(255), a), dst),
+                                V_MUL(src, a)));
+}
+
+/* Same as convertBits<10, 8>: p * 1023 / 255 = 4 * p + p / 85 */
+VLC_TARGET
+static inline VEC RENAME(convert10)(VEC p)
+{
+    return V_ADD(V_SHL(p, 2), V_SHR(V_MUL(p, V_SET1(193)), 14));
+}
+
+/* YUVA to 8-bit planar 4:2:0 */
+VLC_TARGET
+static unsigned RENAME(blend_yuva_420)(uint8_t *dy, uint8_t *du, uint8_t *dv,
+                                       const uint8_t *const src[4],
+                                       unsigned count, unsigned alpha,
+                                       bool chroma)
+{
+    const VEC global = V_SET1(alpha);
+    unsigned x;
+
+    for (x = 0; x + 2 * STEP <= count; x += 2 * STEP)
+    {
+        for (unsigned i = x; i < x + 2 * STEP; i += STEP)
+        {
+            VEC a = RENAME(div255)(V_MUL(global, V_LOAD8(&src[3][i])));
+
+            V_STORE8(&dy[i], RENAME(merge)(V_LOAD8(&dy[i]),
+                                           V_LOAD8(&src[0][i]), a));
+        }
+
+        if (chroma)
+        {   /* Only the even pixels have chroma samples */
+            VEC a = RENAME(div255)(V_MUL(global, V_LOAD_EVEN8(&src[3][x])));
+
+            V_STORE8(&du[x / 2], RENAME(merge)(V_LOAD8(&du[x / 2]),
+                                               V_LOAD_EVEN8(&src[1][x]), a));
+            V_STORE8(&dv[x / 2], RENAME(merge)(V_LOAD8(&dv[x / 2]),
+                                               V_LOAD_EVEN8(&src[2][x]), a));
+        }
+    }
+    return x;
+}
+
+/* YUVA to 8-bit semi-planar 4:2:0: src[1] is the chroma plane stored first */
+VLC_TARGET
+static unsigned RENAME(blend_yuva_nv12)(uint8_t *dy, uint8_t *duv,
+                                        const uint8_t *const src[4],
+                                        unsigned count, unsigned alpha,
+                                        bool chroma)
+{
+    const VEC global = V_SET1(alpha);
+    unsigned x;
+
+    for (x = 0; x + 2 * STEP <= count; x += 2 * STEP)
+    {
+        for (unsigned i = x; i < x + 2 * STEP; i += STEP)
+        {
+            VEC a = RENAME(div255)(V_MUL(global, V_LOAD8(&src[3][i])));
+
+            V_STORE8(&dy[i], RENAME(merge)(V_LOAD8(&dy[i]),
+                                           V_LOAD8(&src[0][i]), a));
+        }
+
+        if (chroma)
+        {
+            VEC a = RENAME(div255)(V_MUL(global, V_LOAD_EVEN8(&src[3][x])));
+            VEC u, v;
+
+            V_LOAD_UV(&duv[x], u, v);
+            u = RENAME(merge)(u, V_LOAD_EVEN8(&src[1][x]), a);
+            v = RENAME(merge)(v, V_LOAD_EVEN8(&src[2][x]), a);
+            V_STORE_UV(&duv[x], u, v);
+        }
+    }
+    return x;
+}
+
+/* YUVA to 10-bit planar 4:2:0. Unlike with 8 bits, merge() with a null alpha
+ * is not the identity, so the transparent pixels are left untouched. */
+VLC_TARGET
+static unsigned RENAME(blend_yuva_420_10)(uint16_t *dy, uint16_t *du,
+                                          uint16_t *dv,
+                                          const uint8_t *const src[4],
+                                          unsigned count, unsigned alpha,
+                                          bool chroma)
+{
+    const VEC global = V_SET1(alpha);
+    unsigned x;
+
+    for (x = 0; x + 2 * STEP <= count; x += 2 * STEP)
+    {
+        for (unsigned i = x; i < x + 2 * STEP; i += STEP)
+        {
+            VEC a = RENAME(div255)(V_MUL(global, V_LOAD8(&src[3][i])));
+            VEC d = V_LOAD16(&dy[i]);
+            VEC s = RENAME(convert10)(V_LOAD8(&src[0][i]));
+
+            V_STORE16(&dy[i], V_SELECT_ZERO(a, d, V_MERGE_WIDE(d, s, a)));
+        }
+
+        if (chroma)
+        {
+            VEC a = RENAME(div255)(V_MUL(global, V_LOAD_EVEN8(&src[3][x])));
+            VEC d, s;
+
+            d = V_LOAD16(&du[x / 2]);
+            s = RENAME(convert10)(V_LOAD_EVEN8(&src[1][x]));
+            V_STORE16(&du[x / 2], V_SELECT_ZERO(a, d, V_MERGE_WIDE(d, s, a)));
+            d = V_LOAD16(&dv[x / 2]);
+            s = RENAME(convert10)(V_LOAD_EVEN8(&src[2][x]));
+            V_STORE16(&dv[x / 2], V_SELECT_ZERO(a, d, V_MERGE_WIDE(d, s, a)));
+        }
+    }
+    return x;
+}
+
+/* RGBA to 32-bit RGB. The shuffle table holds, for each byte of 4 pixels of
+ * the destination, the index of the source byte with its color (16 bytes)
+ * then with its alpha (16 bytes). Indices 0xFF leave the byte untouched. */
+VLC_TARGET
+static unsigned RENAME(blend_rgba_rgb32)(uint8_t *dst, const uint8_t *src,
+                                         unsigned count, unsigned alpha,
+                                         const uint8_t shuffle[32])
+{
+    const VEC global = V_SET1(alpha);
+    const BVEC color = B_LOAD(&shuffle[0]);
+    const BVEC opacity = B_LOAD(&shuffle[16]);
+    unsigned x;
+
+    /* STEP bytes per vector, hence STEP / 4 pixels */
+    for (x = 0; x + STEP / 2 <= count; x += STEP / 2)
+    {
+        for (unsigned i = 4 * x; i < 4 * x + 2 * STEP; i += STEP)
+        {
+            BVEC b = B_LOAD(&src[i]);
+            VEC a = RENAME(div255)(V_MUL(global,
+                                         V_WIDEN(B_SHUFFLE(b, opacity))));
+
+            V_STORE8(&dst[i], RENAME(merge)(V_LOAD8(&dst[i]),
+                                            V_WIDEN(B_SHUFFLE(b, color)), a));
+        }
+    }
+    return x;
+}
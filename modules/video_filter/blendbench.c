@@ -56,14 +56,22 @@ static picture_t *Filter( filter_t *, picture_t * );
 #define ALPHA_TEXT N_("Alpha of the blended image")
 #define ALPHA_LONGTEXT N_("Alpha with which the blend image is blended")
 
+#define COMPARE_TEXT N_("Compare with the generic code")
+#define COMPARE_LONGTEXT N_("Also blend without the vectorized routines, " \
+                            "and check that both give the same pictures")
+
 #define BASE_IMAGE_TEXT N_("Image to be blended onto")
-#define BASE_IMAGE_LONGTEXT N_("The image which will be used to blend onto")
+#define BASE_IMAGE_LONGTEXT N_("The image which will be used to blend onto. " \
+                               "If none, a 1920x1080 picture of random " \
+                               "pixels is used.")
 
 #define BASE_CHROMA_TEXT N_("Chroma for the base image")
 #define BASE_CHROMA_LONGTEXT N_("Chroma which the base image will be loaded in")
 
 #define BLEND_IMAGE_TEXT N_("Image which will be blended")
-#define BLEND_IMAGE_LONGTEXT N_("The image blended onto the base image")
+#define BLEND_IMAGE_LONGTEXT N_("The image blended onto the base image. " \
+                                "If none, a 1920x1080 picture of random " \
+                                "pixels is used.")
 
 #define BLEND_CHROMA_TEXT N_("Chroma for the blend image")
 #define BLEND_CHROMA_LONGTEXT N_("Chroma which the blend image will be loaded" \
@@ -83,6 +91,8 @@ vlc_module_begin ()
               LOOPS_LONGTEXT, false )
     add_integer_with_range( CFG_PREFIX "alpha", 128, 0, 255, ALPHA_TEXT,
               ALPHA_LONGTEXT, false )
+    add_bool( CFG_PREFIX "compare", true, COMPARE_TEXT, COMPARE_LONGTEXT,
+              false )
 
     set_section( N_("Base image"), NULL )
     add_loadfile( CFG_PREFIX "base-image", NULL, BASE_IMAGE_TEXT,
@@ -100,7 +110,7 @@ vlc_module_begin ()
 vlc_module_end ()
 
 static const char *const ppsz_filter_options[] = {
-    "loops", "alpha", "base-image", "base-chroma", "blend-image",
+    "loops", "alpha", "compare", "base-image", "base-chroma", "blend-image",
     "blend-chroma", NULL
 };
 
@@ -110,6 +120,7 @@ static const char *const ppsz_filter_options[] = {
 struct filter_sys_t
 {
     bool b_done;
+    bool b_compare;
     int i_loops, i_alpha;
 
     picture_t *p_base_image;
@@ -119,6 +130,53 @@ struct filter_sys_t
     vlc_fourcc_t i_blend_chroma;
 };
 
+/* Fills a picture with pseudo-random pixels, always the same ones, with
+ * plenty of fully transparent and opaque pixels in the alpha plane. */
+static picture_t *blendbench_NewImage( vlc_fourcc_t i_chroma )
+{
+    const vlc_chroma_description_t *p_dsc =
+        vlc_fourcc_GetChromaDescription( i_chroma );
+    video_format_t fmt;
+    uint32_t i_seed = 1;
+
+    if( p_dsc == NULL )
+        return NULL;
+
+    video_format_Init( &fmt, 0 );
+    video_format_Setup( &fmt, i_chroma, 1920, 1080, 1920, 1080, 1, 1 );
+    picture_t *p_pic = picture_NewFromFormat( &fmt );
+    if( p_pic == NULL )
+        return NULL;
+
+    for( int i_plane = 0; i_plane < p_pic->i_planes; i_plane++ )
+    {
+        plane_t *p = &p_pic->p[i_plane];
+        const bool b_alpha = i_plane == A_PLANE && p_pic->i_planes == 4;
+
+        for( int y = 0; y < p->i_lines; y++ )
+        {
+            uint8_t *p_line = &p->p_pixels[y * p->i_pitch];
+
+            for( int x = 0; x < p->i_pitch / (int)p_dsc->pixel_size; x++ )
+            {
+                unsigned i_value;
+
+                i_seed = i_seed * 1103515245 + 12345;
+                i_value = i_seed >> 16;
+                if( b_alpha && (i_value & 0x300) != 0x300 )
+                    i_value = (i_value & 0x300) ? 0xFF : 0;
+
+                if( p_dsc->pixel_size == 2 )
+                    ((uint16_t *)p_line)[x] =
+                        i_value & ((1 << p_dsc->pixel_bits) - 1);
+                else
+                    p_line[x] = i_value;
+            }
+        }
+    }
+    return p_pic;
+}
+
 static int blendbench_LoadImage( vlc_object_t *p_this, picture_t **pp_pic,
                                  vlc_fourcc_t i_chroma, char *psz_file, const char *psz_name )
 {
@@ -128,6 +186,17 @@ static int blendbench_LoadImage( vlc_object_t *p_this, picture_t **pp_pic,
     memset( &fmt_in, 0, sizeof(video_format_t) );
     memset( &fmt_out, 0, sizeof(video_format_t) );
 
+    if( psz_file == NULL || *psz_file == '\0' )
+    {
+        *pp_pic = blendbench_NewImage( i_chroma );
+        if( *pp_pic == NULL )
+        {
+            msg_Err( p_this, "Unable to create %s image", psz_name );
+            return VLC_EGENERIC;
+        }
+        return VLC_SUCCESS;
+    }
+
     fmt_out.i_chroma = i_chroma;
     p_image = image_HandlerCreate( p_this );
     *pp_pic = image_ReadUrl( p_image, psz_file, &fmt_in, &fmt_out );
@@ -175,6 +244,7 @@ static int Create( vlc_object_t *p_this )
                                                   CFG_PREFIX "loops" );
     p_sys->i_alpha = var_CreateGetIntegerCommand( p_filter,
                                                   CFG_PREFIX "alpha" );
+    p_sys->b_compare = var_CreateGetBool( p_filter, CFG_PREFIX "compare" );
 
     psz_temp = var_CreateGetStringCommand( p_filter, CFG_PREFIX "base-chroma" );
     p_sys->i_base_chroma = !psz_temp || strlen( psz_temp ) != 4 ? 0 :
@@ -224,32 +294,37 @@ static void Destroy( vlc_object_t *p_this )
     picture_Release( p_sys->p_blend_image );
 }
 
-/*****************************************************************************
- * Render: displays previously rendered output
- *****************************************************************************/
-static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+static filter_t *blendbench_NewBlend( filter_t *p_filter, bool b_simd )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    filter_t *p_blend;
-
-    if( p_sys->b_done )
-        return p_pic;
+    filter_t *p_blend = vlc_object_create( p_filter, sizeof(filter_t) );
 
-    p_blend = vlc_object_create( p_filter, sizeof(filter_t) );
     if( !p_blend )
-    {
-        picture_Release( p_pic );
         return NULL;
-    }
+
     p_blend->fmt_out.video = p_sys->p_base_image->format;
     p_blend->fmt_in.video = p_sys->p_blend_image->format;
+    var_Create( p_blend, "blend-simd", VLC_VAR_BOOL );
+    var_SetBool( p_blend, "blend-simd", b_simd );
     p_blend->p_module = module_need( p_blend, "video blending", NULL, false );
     if( !p_blend->p_module )
     {
-        picture_Release( p_pic );
         vlc_object_release( p_blend );
         return NULL;
     }
+    return p_blend;
+}
+
+static void blendbench_DeleteBlend( filter_t *p_blend )
+{
+    module_unneed( p_blend, p_blend->p_module );
+    vlc_object_release( p_blend );
+}
+
+static mtime_t blendbench_Run( filter_t *p_filter, filter_t *p_blend,
+                               const char *psz_name )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
 
     mtime_t time = mdate();
     for( int i_iter = 0; i_iter < p_sys->i_loops; ++i_iter )
@@ -259,18 +334,91 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
                                  0, 0, p_sys->i_alpha );
     }
     time = mdate() - time;
+    if( time <= 0 )
+        time = 1;
 
-    msg_Info( p_filter, "Blended %d images in %f sec", p_sys->i_loops,
-              time / 1000000.0f );
-    msg_Info( p_filter, "Speed is: %f images/second, %f pixels/second",
-              (float) p_sys->i_loops / time * 1000000,
+    msg_Info( p_filter, "%s: blended %d images in %f sec", psz_name,
+              p_sys->i_loops, time / 1000000.0f );
+    msg_Info( p_filter, "%s: speed is: %f images/second, %f pixels/second",
+              psz_name, (float) p_sys->i_loops / time * 1000000,
               (float) p_sys->i_loops / time * 1000000 *
                   p_sys->p_blend_image->p[Y_PLANE].i_visible_pitch *
                   p_sys->p_blend_image->p[Y_PLANE].i_visible_lines );
+    return time;
+}
 
-    module_unneed( p_blend, p_blend->p_module );
+/* Blends once with both routines onto copies of the base image, and checks
+ * that the results are the same. */
+static bool blendbench_Compare( filter_t *p_filter, filter_t *p_simd,
+                                filter_t *p_generic )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    picture_t *p_base = p_sys->p_base_image;
+    picture_t *p_ref = picture_NewFromFormat( &p_base->format );
+    picture_t *p_out = picture_NewFromFormat( &p_base->format );
+    bool b_same = true;
+
+    if( p_ref == NULL || p_out == NULL )
+        goto out;
+
+    picture_CopyPixels( p_ref, p_base );
+    picture_CopyPixels( p_out, p_base );
+    p_generic->pf_video_blend( p_generic, p_ref, p_sys->p_blend_image,
+                               0, 0, p_sys->i_alpha );
+    p_simd->pf_video_blend( p_simd, p_out, p_sys->p_blend_image,
+                            0, 0, p_sys->i_alpha );
+
+    for( int i = 0; i < p_ref->i_planes && b_same; i++ )
+        for( int y = 0; y < p_ref->p[i].i_visible_lines && b_same; y++ )
+            b_same = !memcmp( &p_ref->p[i].p_pixels[y * p_ref->p[i].i_pitch],
+                              &p_out->p[i].p_pixels[y * p_out->p[i].i_pitch],
+                              p_ref->p[i].i_visible_pitch );
+out:
+    if( p_out )
+        picture_Release( p_out );
+    if( p_ref )
+        picture_Release( p_ref );
+    return b_same;
+}
 
-    vlc_object_release( p_blend );
+/*****************************************************************************
+ * Render: displays previously rendered output
+ *****************************************************************************/
+static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    filter_t *p_blend, *p_generic = NULL;
+
+    if( p_sys->b_done )
+        return p_pic;
+
+    p_blend = blendbench_NewBlend( p_filter, true );
+    if( p_blend && p_sys->b_compare )
+        p_generic = blendbench_NewBlend( p_filter, false );
+    if( !p_blend || (p_sys->b_compare && !p_generic) )
+    {
+        if( p_blend )
+            blendbench_DeleteBlend( p_blend );
+        picture_Release( p_pic );
+        return NULL;
+    }
+
+    mtime_t time = blendbench_Run( p_filter, p_blend, "default" );
+
+    if( p_generic )
+    {
+        mtime_t time_generic = blendbench_Run( p_filter, p_generic,
+                                               "generic" );
+
+        msg_Info( p_filter, "Speed-up over the generic code: %.2fx",
+                  (double)time_generic / time );
+        if( !blendbench_Compare( p_filter, p_blend, p_generic ) )
+            msg_Err( p_filter, "Pictures blended with and without the "
+                     "vectorized routines differ" );
+        blendbench_DeleteBlend( p_generic );
+    }
+
+    blendbench_DeleteBlend( p_blend );
 
     p_sys->b_done = true;
     return p_pic;
@@ -43,6 +43,8 @@ static int  OpenFilter ( vlc_object_t * );
 static void CloseFilter( vlc_object_t * );
 
 static picture_t *Filter( filter_t *, picture_t * );
+static void FilterSlice( filter_t *, picture_t *, const picture_t *,
+                         unsigned, unsigned );
 
 #define CROPTOP_TEXT N_( "Pixels to crop from top" )
 #define CROPTOP_LONGTEXT N_( \
@@ -187,6 +189,7 @@ static int OpenFilter( vlc_object_t *p_this )
         + p_sys->i_paddleft + p_sys->i_paddright;
 
     p_filter->pf_video_filter = Filter;
+    p_filter->pf_video_slice = FilterSlice;
 
     msg_Dbg( p_filter, "Crop: Top: %d, Bottom: %d, Left: %d, Right: %d",
              p_sys->i_croptop, p_sys->i_cropbottom, p_sys->i_cropleft,
@@ -213,35 +216,24 @@ static void CloseFilter( vlc_object_t *p_this )
 }
 
 /****************************************************************************
- * Filter: the whole thing
+ * FilterSlice: crop and padd a band of lines
  ****************************************************************************/
-static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+static void FilterSlice( filter_t *p_filter, picture_t *p_outpic,
+                         const picture_t *p_pic,
+                         unsigned i_first, unsigned i_lines )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    picture_t *p_outpic;
     int i_width, i_height, i_xcrop, i_ycrop,
         i_outwidth, i_outheight, i_xpadd, i_ypadd;
 
     const int p_padd_color[] = { 0x00, 0x80, 0x80, 0xff };
 
-    if( !p_pic ) return NULL;
-
-    /* Request output picture */
-    p_outpic = filter_NewPicture( p_filter );
-    if( !p_outpic )
-    {
-        picture_Release( p_pic );
-        return NULL;
-    }
-
     for( int i_plane = 0; i_plane < p_pic->i_planes; i_plane++ )
     /* p_pic and p_outpic have the same chroma/number of planes but that's
      * about it. */
     {
-        plane_t *p_plane = p_pic->p+i_plane;
+        const plane_t *p_plane = p_pic->p+i_plane;
         plane_t *p_outplane = p_outpic->p+i_plane;
-        uint8_t *p_in = p_plane->p_pixels;
-        uint8_t *p_out = p_outplane->p_pixels;
         int i_pixel_pitch = p_plane->i_pixel_pitch;
         int i_padd_color = i_plane > 3 ? p_padd_color[0]
                                        : p_padd_color[i_plane];
@@ -271,20 +263,26 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
         i_ypadd =     ( p_sys->i_paddtop * p_outplane->i_visible_lines )
                        / p_outpic->p->i_visible_lines;
 
-        /* Crop the top */
-        p_in += i_ycrop * p_plane->i_pitch;
+        unsigned i_line = i_first, i_count = i_lines;
+        filter_SlicePlane( p_outpic, i_plane, &i_line, &i_count );
 
-        /* Padd on the top */
-        memset( p_out, i_padd_color, i_ypadd * p_outplane->i_pitch );
-        p_out += i_ypadd * p_outplane->i_pitch;
-
-        for( int i_line = 0; i_line < i_height; i_line++ )
+        for( int i_out = i_line;
+             i_out < (int)(i_line + i_count) && i_out < i_outheight; i_out++ )
         {
-            uint8_t *p_in_next = p_in + p_plane->i_pitch;
-            uint8_t *p_out_next = p_out + p_outplane->i_pitch;
+            uint8_t *p_out = p_outplane->p_pixels
+                           + i_out * p_outplane->i_pitch;
+
+            /* Padd on the top and on the bottom */
+            if( i_out < i_ypadd || i_out >= i_ypadd + i_height )
+            {
+                memset( p_out, i_padd_color, p_outplane->i_pitch );
+                continue;
+            }
 
-            /* Crop on the left */
-            p_in += i_xcrop * i_pixel_pitch;
+            /* Crop on the top and on the left */
+            const uint8_t *p_in = p_plane->p_pixels
+                + ( i_ycrop + i_out - i_ypadd ) * p_plane->i_pitch
+                + i_xcrop * i_pixel_pitch;
 
             /* Padd on the left */
             memset( p_out, i_padd_color, i_xpadd * i_pixel_pitch );
@@ -293,21 +291,32 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
             /* Copy the image and crop on the right */
             memcpy( p_out, p_in, i_width * i_pixel_pitch );
             p_out += i_width * i_pixel_pitch;
-            p_in += i_width * i_pixel_pitch;
 
             /* Padd on the right */
             memset( p_out, i_padd_color,
                         ( i_outwidth - i_xpadd - i_width ) * i_pixel_pitch );
-
-            /* Got to begining of the next line */
-            p_in = p_in_next;
-            p_out = p_out_next;
         }
+    }
+}
 
-        /* Padd on the bottom */
-        memset( p_out, i_padd_color,
-                 ( i_outheight - i_ypadd - i_height ) * p_outplane->i_pitch );
+/****************************************************************************
+ * Filter: the whole thing
+ ****************************************************************************/
+static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+{
+    picture_t *p_outpic;
+
+    if( !p_pic ) return NULL;
+
+    /* Request output picture */
+    p_outpic = filter_NewPicture( p_filter );
+    if( !p_outpic )
+    {
+        picture_Release( p_pic );
+        return NULL;
     }
 
+    filter_SliceVideo( p_filter, p_outpic, p_pic );
+
     return CopyInfoAndRelease( p_outpic, p_pic );
 }
@@ -112,7 +112,16 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
         /* */
         void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
                        int w, int prefs, int mrefs, int parity, int mode);
-
+        void (*filter16)(uint16_t *dst, uint16_t *prev, uint16_t *cur,
+                         uint16_t *next, int w, int prefs, int mrefs,
+                         int parity, int mode);
+        const unsigned pixel_size = p_sys->chroma->pixel_size;
+
+#if defined(HAVE_YADIF_AVX2)
+        if( vlc_CPU_AVX2() )
+            filter = yadif_filter_line_avx2;
+        else
+#endif
 /* android clang build for x86 fails as not enough registers are available */
 #if !defined(__ANDROID__)
 # if defined(HAVE_YADIF_SSSE3)
@@ -133,8 +142,17 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
 #endif
             filter = yadif_filter_line_c;
 
-        if( p_sys->chroma->pixel_size == 2 )
-            filter = yadif_filter_line_c_16bit;
+#if defined(HAVE_YADIF_16BIT_AVX2)
+        if( vlc_CPU_AVX2() )
+            filter16 = yadif_filter_line_16bit_avx2;
+        else
+#endif
+#if defined(HAVE_YADIF_16BIT_SSE4_1)
+        if( vlc_CPU_SSE4_1() )
+            filter16 = yadif_filter_line_16bit_sse4_1;
+        else
+#endif
+            filter16 = yadif_filter_line_c_16bit;
 
         for( int n = 0; n < p_dst->i_planes; n++ )
         {
@@ -157,15 +175,21 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
                     mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
 
                     assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
-                    filter( &dstp->p_pixels[y * dstp->i_pitch],
-                            &prevp->p_pixels[y * prevp->i_pitch],
-                            &curp->p_pixels[y * curp->i_pitch],
-                            &nextp->p_pixels[y * nextp->i_pitch],
-                            dstp->i_visible_pitch,
-                            y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
-                            y  - 1  ?  -curp->i_pitch : curp->i_pitch,
-                            yadif_parity,
-                            mode );
+                    uint8_t *dst  = &dstp->p_pixels[y * dstp->i_pitch];
+                    uint8_t *prev = &prevp->p_pixels[y * prevp->i_pitch];
+                    uint8_t *cur  = &curp->p_pixels[y * curp->i_pitch];
+                    uint8_t *next = &nextp->p_pixels[y * nextp->i_pitch];
+                    int prefs = y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch;
+                    int mrefs = y  - 1  ?  -curp->i_pitch : curp->i_pitch;
+
+                    if( pixel_size == 2 )
+                        filter16( (uint16_t *)dst, (uint16_t *)prev,
+                                  (uint16_t *)cur, (uint16_t *)next,
+                                  dstp->i_visible_pitch / 2, prefs, mrefs,
+                                  yadif_parity, mode );
+                    else
+                        filter( dst, prev, cur, next, dstp->i_visible_pitch,
+                                prefs, mrefs, yadif_parity, mode );
                 }
 
                 /* We duplicate the first and last lines */
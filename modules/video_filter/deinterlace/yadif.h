@@ -147,3 +147,131 @@ static void yadif_filter_line_c_16bit(uint16_t *dst, uint16_t *prev, uint16_t *c
     prefs /= 2;
     FILTER
 }
+
+#if defined(CAN_COMPILE_SSE4_1) || defined(CAN_COMPILE_AVX2)
+#if defined(__GNUC__) || defined(__clang__)
+#include <immintrin.h>
+
+#define C_FILTER yadif_filter_line_c_16bit
+#define pixel_t uint16_t
+
+#ifdef CAN_COMPILE_SSE4_1
+// ============== SSE4.1 16-bit ==============
+#define HAVE_YADIF_16BIT_SSE4_1
+#define VLC_TARGET __attribute__((__target__("sse4.1")))
+#define RENAME(a) a ## _16bit_sse4_1
+#define VEC __m128i
+#define STEP 4
+#define V_LOAD(p) _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)(p)))
+#define V_STORE(p, v) \
+    _mm_storel_epi64((__m128i *)(p), _mm_packus_epi32(v, v))
+#define V_ADD _mm_add_epi32
+#define V_SUB _mm_sub_epi32
+#define V_ABS _mm_abs_epi32
+#define V_MAX _mm_max_epi32
+#define V_MIN _mm_min_epi32
+#define V_CMPGT _mm_cmpgt_epi32
+#define V_HALF(v) _mm_srai_epi32(v, 1)
+#define V_AND _mm_and_si128
+#define V_BLEND _mm_blendv_epi8
+#define V_SET1 _mm_set1_epi32
+#include "yadif_x86_template.h"
+#undef V_SET1
+#undef V_BLEND
+#undef V_AND
+#undef V_HALF
+#undef V_CMPGT
+#undef V_MIN
+#undef V_MAX
+#undef V_ABS
+#undef V_SUB
+#undef V_ADD
+#undef V_STORE
+#undef V_LOAD
+#undef STEP
+#undef VEC
+#undef RENAME
+#undef VLC_TARGET
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+// =============== AVX2 16-bit ===============
+#define HAVE_YADIF_16BIT_AVX2
+#define VLC_TARGET __attribute__((__target__("avx2")))
+#define RENAME(a) a ## _16bit_avx2
+#define VEC __m256i
+#define STEP 8
+#define V_LOAD(p) \
+    _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(p)))
+#define V_STORE(p, v) \
+    _mm_storeu_si128((__m128i *)(p), _mm256_castsi256_si128( \
+        _mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), 0x08)))
+#define V_ADD _mm256_add_epi32
+#define V_SUB _mm256_sub_epi32
+#define V_ABS _mm256_abs_epi32
+#define V_MAX _mm256_max_epi32
+#define V_MIN _mm256_min_epi32
+#define V_CMPGT _mm256_cmpgt_epi32
+#define V_HALF(v) _mm256_srai_epi32(v, 1)
+#define V_AND _mm256_and_si256
+#define V_BLEND _mm256_blendv_epi8
+#define V_SET1 _mm256_set1_epi32
+#include "yadif_x86_template.h"
+#undef V_SET1
+#undef V_CMPGT
+#undef V_MIN
+#undef V_MAX
+#undef V_ABS
+#undef V_SUB
+#undef V_ADD
+#undef V_HALF
+#undef V_STORE
+#undef V_LOAD
+#undef STEP
+#undef RENAME
+
+#undef C_FILTER
+#undef pixel_t
+#define C_FILTER yadif_filter_line_c
+#define pixel_t uint8_t
+
+// ================ AVX2 8-bit ================
+#define HAVE_YADIF_AVX2
+#define RENAME(a) a ## _avx2
+#define STEP 16
+#define V_LOAD(p) \
+    _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(p)))
+#define V_STORE(p, v) \
+    _mm_storeu_si128((__m128i *)(p), _mm256_castsi256_si128( \
+        _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0x08)))
+#define V_ADD _mm256_add_epi16
+#define V_SUB _mm256_sub_epi16
+#define V_ABS _mm256_abs_epi16
+#define V_MAX _mm256_max_epi16
+#define V_MIN _mm256_min_epi16
+#define V_CMPGT _mm256_cmpgt_epi16
+#define V_HALF(v) _mm256_srai_epi16(v, 1)
+#define V_SET1 _mm256_set1_epi16
+#include "yadif_x86_template.h"
+#undef V_SET1
+#undef V_HALF
+#undef V_CMPGT
+#undef V_MIN
+#undef V_MAX
+#undef V_ABS
+#undef V_SUB
+#undef V_ADD
+#undef V_STORE
+#undef V_LOAD
+#undef STEP
+#undef RENAME
+#undef V_BLEND
+#undef V_AND
+#undef VEC
+#undef VLC_TARGET
+#endif
+
+#undef pixel_t
+#undef C_FILTER
+#endif
+#endif
@@ -0,0 +1,126 @@
+/*****************************************************************************
+ * yadif_x86_template.h: Yadif line filter with x86 intrinsics
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Vector version of the FILTER macro from yadif.h, with the same arithmetic
+ * on wider lanes (16-bit lanes for 8-bit pixels, 32-bit lanes for 16-bit
+ * pixels), so that the output is bit-exact with the C code.
+ *
+ * The includer defines:
+ *  - RENAME(a), VLC_TARGET,
+ *  - pixel_t, the pixel type, and C_FILTER, the C function for the tail,
+ *  - VEC, the vector type, and STEP, the pixels per vector,
+ *  - V_LOAD(p), V_STORE(p, v) to convert pixels from/to lanes,
+ *  - V_ADD, V_SUB, V_ABS, V_MAX, V_MIN, V_CMPGT, V_HALF (>> 1),
+ *    V_AND, V_BLEND(a, b, mask), V_SET1. */
+
+#define L(off) V_LOAD(&cur[x + (off)])
+
+/* Score and prediction of CHECK(j) */
+#define V_SCORE(j) \
+    V_ADD(V_ADD(V_ABS(V_SUB(L(mrefs - 1 + (j)), L(prefs - 1 - (j)))), \
+                V_ABS(V_SUB(L(mrefs + (j)), L(prefs - (j))))), \
+          V_ABS(V_SUB(L(mrefs + 1 + (j)), L(prefs + 1 - (j)))))
+#define V_PRED(j) V_HALF(V_ADD(L(mrefs + (j)), L(prefs - (j))))
+
+VLC_TARGET
+static void RENAME(yadif_filter_line)(pixel_t *dst, pixel_t *prev,
+                                      pixel_t *cur, pixel_t *next, int w,
+                                      int prefs, int mrefs, int parity,
+                                      int mode)
+{
+    pixel_t *prev2 = parity ? prev : cur;
+    pixel_t *next2 = parity ? cur  : next;
+    const int prefs_bytes = prefs, mrefs_bytes = mrefs;
+    const VEC one = V_SET1(1);
+    const VEC zero = V_SET1(0);
+    int x;
+
+    prefs /= (int)sizeof (pixel_t);
+    mrefs /= (int)sizeof (pixel_t);
+
+    for (x = 0; x + STEP <= w; x += STEP)
+    {
+        VEC c = L(mrefs);
+        VEC e = L(prefs);
+        VEC p2 = V_LOAD(&prev2[x]);
+        VEC n2 = V_LOAD(&next2[x]);
+        VEC d = V_HALF(V_ADD(p2, n2));
+        VEC temporal_diff0 = V_ABS(V_SUB(p2, n2));
+        VEC temporal_diff1 = V_HALF(V_ADD(
+            V_ABS(V_SUB(V_LOAD(&prev[x + mrefs]), c)),
+            V_ABS(V_SUB(V_LOAD(&prev[x + prefs]), e))));
+        VEC temporal_diff2 = V_HALF(V_ADD(
+            V_ABS(V_SUB(V_LOAD(&next[x + mrefs]), c)),
+            V_ABS(V_SUB(V_LOAD(&next[x + prefs]), e))));
+        VEC diff = V_MAX(V_MAX(V_HALF(temporal_diff0), temporal_diff1),
+                         temporal_diff2);
+        VEC spatial_pred = V_HALF(V_ADD(c, e));
+        VEC spatial_score = V_SUB(V_ADD(V_ADD(
+            V_ABS(V_SUB(L(mrefs - 1), L(prefs - 1))), V_ABS(V_SUB(c, e))),
+            V_ABS(V_SUB(L(mrefs + 1), L(prefs + 1)))), one);
+        VEC score, mask, mask2;
+
+        /* CHECK(-1) CHECK(-2): the second check only applies to the lanes
+         * where the first one succeeded. Likewise for CHECK(1) CHECK(2). */
+        score = V_SCORE(-1);
+        mask = V_CMPGT(spatial_score, score);
+        spatial_score = V_BLEND(spatial_score, score, mask);
+        spatial_pred = V_BLEND(spatial_pred, V_PRED(-1), mask);
+        score = V_SCORE(-2);
+        mask2 = V_AND(mask, V_CMPGT(spatial_score, score));
+        spatial_score = V_BLEND(spatial_score, score, mask2);
+        spatial_pred = V_BLEND(spatial_pred, V_PRED(-2), mask2);
+
+        score = V_SCORE(1);
+        mask = V_CMPGT(spatial_score, score);
+        spatial_score = V_BLEND(spatial_score, score, mask);
+        spatial_pred = V_BLEND(spatial_pred, V_PRED(1), mask);
+        score = V_SCORE(2);
+        mask2 = V_AND(mask, V_CMPGT(spatial_score, score));
+        spatial_pred = V_BLEND(spatial_pred, V_PRED(2), mask2);
+
+        if (mode < 2)
+        {
+            VEC b = V_HALF(V_ADD(V_LOAD(&prev2[x + 2 * mrefs]),
+                                 V_LOAD(&next2[x + 2 * mrefs])));
+            VEC f = V_HALF(V_ADD(V_LOAD(&prev2[x + 2 * prefs]),
+                                 V_LOAD(&next2[x + 2 * prefs])));
+            VEC de = V_SUB(d, e), dc = V_SUB(d, c);
+            VEC bc = V_SUB(b, c), fe = V_SUB(f, e);
+            VEC max = V_MAX(V_MAX(de, dc), V_MIN(bc, fe));
+            VEC min = V_MIN(V_MIN(de, dc), V_MAX(bc, fe));
+
+            diff = V_MAX(V_MAX(diff, min), V_SUB(zero, max));
+        }
+
+        /* diff is never negative, so clamping is the same as the C code */
+        spatial_pred = V_MAX(V_MIN(spatial_pred, V_ADD(d, diff)),
+                             V_SUB(d, diff));
+        V_STORE(&dst[x], spatial_pred);
+    }
+
+    if (x < w)
+        C_FILTER(dst + x, prev + x, cur + x, next + x, w - x,
+                 prefs_bytes, mrefs_bytes, parity, mode);
+}
+
+#undef V_PRED
+#undef V_SCORE
+#undef L
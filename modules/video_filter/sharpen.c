@@ -55,6 +55,8 @@ static int  Create    ( vlc_object_t * );
 static void Destroy   ( vlc_object_t * );
 
 static picture_t *Filter( filter_t *, picture_t * );
+static void FilterSlice( filter_t *, picture_t *, const picture_t *,
+                         unsigned, unsigned );
 static int SharpenCallback( vlc_object_t *, char const *,
                             vlc_value_t, vlc_value_t, void * );
 
@@ -92,6 +94,7 @@ static const char *const ppsz_filter_options[] = {
 struct filter_sys_t
 {
     atomic_int sigma;
+    int frame_sigma; /* strength for the picture being filtered */
 };
 
 /*****************************************************************************
@@ -119,6 +122,7 @@ static int Create( vlc_object_t *p_this )
         return VLC_ENOMEM;
 
     p_filter->pf_video_filter = Filter;
+    p_filter->pf_video_slice = FilterSlice;
 
     config_ChainParse( p_filter, FILTER_PREFIX, ppsz_filter_options,
                    p_filter->p_cfg );
@@ -159,24 +163,30 @@ static void Destroy( vlc_object_t *p_this )
 #define IS_YUV_420_10BITS(fmt) (fmt == VLC_CODEC_I420_10L ||    \
                                 fmt == VLC_CODEC_I420_10B)
 
-#define SHARPEN_FRAME(maxval, data_t)                                   \
+#define SHARPEN_LINES(maxval, data_t)                                   \
     do                                                                  \
     {                                                                   \
         assert((maxval) >= 0);                                          \
-        data_t *restrict p_src = (data_t *)p_pic->p[Y_PLANE].p_pixels;  \
+        const data_t *restrict p_src =                                  \
+            (const data_t *)p_pic->p[Y_PLANE].p_pixels;                 \
         data_t *restrict p_out = (data_t *)p_outpic->p[Y_PLANE].p_pixels; \
         const unsigned data_sz = sizeof(data_t);                        \
-        const int i_src_line_len = p_outpic->p[Y_PLANE].i_pitch / data_sz; \
-        const int i_out_line_len = p_pic->p[Y_PLANE].i_pitch / data_sz; \
-        const int sigma = atomic_load(&p_filter->p_sys->sigma);         \
+        const int i_src_line_len = p_pic->p[Y_PLANE].i_pitch / data_sz; \
+        const int i_out_line_len = p_outpic->p[Y_PLANE].i_pitch / data_sz; \
+        const unsigned i_width = i_visible_pitch / data_sz;             \
                                                                         \
-        memcpy(p_out, p_src, i_visible_pitch);                          \
-                                                                        \
-        for( unsigned i = 1; i < i_visible_lines - 1; i++ )             \
+        for( unsigned i = i_first; i < i_first + i_lines; i++ )         \
         {                                                               \
+            if( i == 0 || i == i_visible_lines - 1 )                    \
+            {                                                           \
+                memcpy(&p_out[i * i_out_line_len],                      \
+                       &p_src[i * i_src_line_len], i_visible_pitch);    \
+                continue;                                               \
+            }                                                           \
+                                                                        \
             p_out[i * i_out_line_len] = p_src[i * i_src_line_len];      \
                                                                         \
-            for( unsigned j = data_sz; j < i_visible_pitch - 1; j++ )   \
+            for( unsigned j = 1; j < i_width - 1; j++ )                 \
             {                                                           \
                 const int line_idx_1 = (i - 1) * i_src_line_len;        \
                 const int line_idx_2 = i * i_src_line_len;              \
@@ -196,22 +206,46 @@ static void Destroy( vlc_object_t *p_this )
                 p_out[i * i_out_line_len + j] =                         \
                     VLC_CLIP( p_src[line_idx_2 + j] + pix, 0, maxval);  \
             }                                                           \
-            p_out[i * i_out_line_len + i_visible_pitch / data_sz - 1] = \
-                p_src[i * i_src_line_len + i_visible_pitch / data_sz - 1];  \
+            p_out[i * i_out_line_len + i_width - 1] =                   \
+                p_src[i * i_src_line_len + i_width - 1];                \
         }                                                               \
-        memcpy(&p_out[(i_visible_lines - 1) * i_out_line_len],          \
-               &p_src[(i_visible_lines - 1) * i_src_line_len],          \
-               i_visible_pitch);                                        \
     } while (0)
 
-static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+/* Sharpens a band of the luma plane, and copies the chroma planes */
+static void FilterSlice( filter_t *p_filter, picture_t *p_outpic,
+                         const picture_t *p_pic,
+                         unsigned i_first, unsigned i_lines )
 {
-    picture_t *p_outpic;
     const int v1 = -1;
     const int v2 = 3; /* 2^3 = 8 */
+    const int sigma = p_filter->p_sys->frame_sigma;
     const unsigned i_visible_lines = p_pic->p[Y_PLANE].i_visible_lines;
     const unsigned i_visible_pitch = p_pic->p[Y_PLANE].i_visible_pitch;
 
+    if (!IS_YUV_420_10BITS(p_pic->format.i_chroma))
+        SHARPEN_LINES(255, uint8_t);
+    else
+        SHARPEN_LINES(1023, uint16_t);
+
+    for( int i_plane = U_PLANE; i_plane <= V_PLANE; i_plane++ )
+    {
+        const plane_t *p_in = &p_pic->p[i_plane];
+        plane_t *p_out = &p_outpic->p[i_plane];
+        const unsigned i_pitch = __MIN( p_in->i_visible_pitch,
+                                        p_out->i_visible_pitch );
+        unsigned i_line = i_first, i_count = i_lines;
+
+        filter_SlicePlane( p_outpic, i_plane, &i_line, &i_count );
+        for( ; i_count > 0; i_line++, i_count-- )
+            memcpy( &p_out->p_pixels[i_line * p_out->i_pitch],
+                    &p_in->p_pixels[i_line * p_in->i_pitch], i_pitch );
+    }
+}
+
+static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+{
+    picture_t *p_outpic;
+
     p_outpic = filter_NewPicture( p_filter );
     if( !p_outpic )
     {
@@ -219,13 +253,8 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
         return NULL;
     }
 
-    if (!IS_YUV_420_10BITS(p_pic->format.i_chroma))
-        SHARPEN_FRAME(255, uint8_t);
-    else
-        SHARPEN_FRAME(1023, uint16_t);
-
-    plane_CopyPixels( &p_outpic->p[U_PLANE], &p_pic->p[U_PLANE] );
-    plane_CopyPixels( &p_outpic->p[V_PLANE], &p_pic->p[V_PLANE] );
+    p_filter->p_sys->frame_sigma = atomic_load(&p_filter->p_sys->sigma);
+    filter_SliceVideo( p_filter, p_outpic, p_pic );
 
     return CopyInfoAndRelease( p_outpic, p_pic );
 }
@@ -91,6 +91,12 @@ typedef struct {
 
     float    tex_width;
     float    tex_height;
+
+    /* Picture uploaded to the texture; the pictures of the rendered
+     * subpictures are never modified, so it does not need to be uploaded
+     * again as long as the region shows the same one */
+    picture_t *picture;
+    size_t   pixels_offset;
 } gl_region_t;
 
 struct prgm
@@ -1028,6 +1034,8 @@ void vout_display_opengl_Delete(vout_display_opengl_t *vgl)
     {
         if (vgl->region[i].texture)
             vgl->vt.DeleteTextures(1, &vgl->region[i].texture);
+        if (vgl->region[i].picture)
+            picture_Release(vgl->region[i].picture);
     }
     free(vgl->region);
     GL_ASSERT_NOERROR();
@@ -1208,22 +1216,45 @@ int vout_display_opengl_Prepare(vout_display_opengl_t *vgl,
             glr->right  =  2.0 * (r->i_x + r->fmt.i_visible_width ) / subpicture->i_original_picture_width  - 1.0;
             glr->bottom = -2.0 * (r->i_y + r->fmt.i_visible_height) / subpicture->i_original_picture_height + 1.0;
 
+            const size_t pixels_offset =
+                r->fmt.i_y_offset * r->p_picture->p->i_pitch +
+                r->fmt.i_x_offset * r->p_picture->p->i_pixel_pitch;
+
             glr->texture = 0;
-            /* Try to recycle the textures allocated by the previous
+            glr->picture = NULL;
+            glr->pixels_offset = pixels_offset;
+
+            /* Reuse the texture of the previous call to this function that
+               already holds this picture, if any. */
+            for (int j = 0; j < last_count; j++) {
+                if (last[j].texture &&
+                    last[j].picture == r->p_picture &&
+                    last[j].pixels_offset == pixels_offset &&
+                    last[j].width  == glr->width &&
+                    last[j].height == glr->height) {
+                    glr->texture = last[j].texture;
+                    glr->picture = last[j].picture;
+                    memset(&last[j], 0, sizeof(last[j]));
+                    break;
+                }
+            }
+            if (glr->picture)
+                continue;
+
+            /* Otherwise try to recycle the textures allocated by the previous
                call to this function. */
             for (int j = 0; j < last_count; j++) {
                 if (last[j].texture &&
                     last[j].width  == glr->width &&
                     last[j].height == glr->height) {
                     glr->texture = last[j].texture;
+                    if (last[j].picture)
+                        picture_Release(last[j].picture);
                     memset(&last[j], 0, sizeof(last[j]));
                     break;
                 }
             }
 
-            const size_t pixels_offset =
-                r->fmt.i_y_offset * r->p_picture->p->i_pitch +
-                r->fmt.i_x_offset * r->p_picture->p->i_pixel_pitch;
             if (!glr->texture)
             {
                 /* Could not recycle a previous texture, generate a new one. */
@@ -1236,11 +1267,15 @@ int vout_display_opengl_Prepare(vout_display_opengl_t *vgl,
                                                * r->p_picture->p[0].i_pixel_pitch;
             ret = tc->pf_update(tc, &glr->texture, &glr->width, &glr->height,
                                 r->p_picture, &pixels_offset);
+            if (ret == VLC_SUCCESS)
+                glr->picture = picture_Hold(r->p_picture);
         }
     }
     for (int i = 0; i < last_count; i++) {
         if (last[i].texture)
             DelTextures(tc, &last[i].texture);
+        if (last[i].picture)
+            picture_Release(last[i].picture);
     }
     free(last);
 
@@ -521,6 +521,15 @@ static int vout_update_format( decoder_t *p_dec )
             dpb_size = 2;
             break;
         }
+        /* Use the DPB size signaled by the stream, with the same margin as
+         * the 16 frames worst case above */
+        const unsigned stream_dpb_size = p_dec->fmt_in.video.i_dpb_size;
+        if( stream_dpb_size > 0 && stream_dpb_size + 2 < dpb_size )
+        {
+            msg_Dbg( p_dec, "using a DPB of %u pictures instead of %u",
+                     stream_dpb_size + 2, dpb_size );
+            dpb_size = stream_dpb_size + 2;
+        }
         p_vout = input_resource_RequestVout( p_owner->p_resource,
                                              p_vout, &fmt,
                                              dpb_size +
@@ -1047,6 +1056,7 @@ static int DecoderPlayVideo( decoder_t *p_dec, picture_t *p_picture,
     }
 
     const bool b_dated = p_picture->date > VLC_TS_INVALID;
+    const mtime_t i_stream_ts = p_picture->date;
     int i_rate = INPUT_RATE_DEFAULT;
     DecoderFixTs( p_dec, &p_picture->date, NULL, NULL,
                   &i_rate, DECODER_BOGUS_VIDEO_DELAY );
@@ -1073,6 +1083,14 @@ static int DecoderPlayVideo( decoder_t *p_dec, picture_t *p_picture,
             vout_Flush( p_vout, p_picture->date );
             p_owner->i_last_rate = i_rate;
         }
+        if( unlikely(libvlc_priv(p_dec->obj.libvlc)->frame_trace != NULL) )
+        {
+            /* The video output only sees the display date */
+            vlc_FrameTrace( p_dec, VLC_FRAME_TRACE_VOUT_QUEUE, VIDEO_ES,
+                            p_dec->fmt_in.i_id, i_stream_ts );
+            vout_FrameTraceQueue( p_vout, p_dec->fmt_in.i_id,
+                                  p_picture->date, i_stream_ts );
+        }
         vout_PutPicture( p_vout, p_picture );
     }
     else
@@ -1122,6 +1140,9 @@ static int DecoderQueueVideo( decoder_t *p_dec, picture_t *p_pic )
     unsigned i_lost = 0;
     decoder_owner_sys_t *p_owner = p_dec->p_owner;
 
+    vlc_FrameTrace( p_dec, VLC_FRAME_TRACE_DECODED, VIDEO_ES,
+                    p_dec->fmt_in.i_id, p_pic->date );
+
     int ret = DecoderPlayVideo( p_dec, p_pic, &i_lost );
 
     p_owner->pf_update_stat( p_owner, 1, i_lost );
@@ -1613,6 +1634,11 @@ static void *DecoderThread( void *p_data )
             /* We have emptied the FIFO and there is a pending request to
              * drain. Pass p_block = NULL to decoder just once. */
         }
+        else
+            vlc_FrameTrace( p_dec, VLC_FRAME_TRACE_DECODER_DEQUEUE,
+                            p_dec->fmt_in.i_cat, p_dec->fmt_in.i_id,
+                            p_block->i_pts > VLC_TS_INVALID ?
+                            p_block->i_pts : p_block->i_dts );
 
         vlc_fifo_Unlock( p_owner->p_fifo );
 
@@ -2050,6 +2050,10 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
 
     assert( p_block->p_next == NULL );
 
+    vlc_FrameTrace( p_input, VLC_FRAME_TRACE_ES_OUT_SEND, es->fmt.i_cat,
+                    es->fmt.i_id, p_block->i_pts > VLC_TS_INVALID ?
+                    p_block->i_pts : p_block->i_dts );
+
     if( libvlc_stats( p_input ) )
     {
         uint64_t i_total;
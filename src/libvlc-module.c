@@ -1038,6 +1038,24 @@ static const char *const ppsz_prefres[] = {
     "priorities. You can use it to tune VLC priority against other " \
     "programs, or against other VLC instances.")
 
+#define BLOCK_CACHE_TEXT N_("Cache data blocks")
+#define BLOCK_CACHE_LONGTEXT N_( \
+    "Recycle the memory of the small and medium data blocks instead of " \
+    "allocating it for each packet, to reduce the allocation overhead of " \
+    "high bitrate streams. This uses more memory: up to a few megabytes " \
+    "per thread. The setting applies to all the instances of the process.")
+
+#define EXECUTOR_THREADS_TEXT N_("Worker threads")
+#define EXECUTOR_THREADS_LONGTEXT N_( \
+    "Maximum number of threads of the pool shared by the modules for " \
+    "parallel processing. 0 means one per CPU.")
+
+#define FILTER_SLICES_TEXT N_("Video filter slices")
+#define FILTER_SLICES_LONGTEXT N_( \
+    "Maximum number of bands each picture is split into, for the video " \
+    "filters that can process them in parallel. 0 means one per worker " \
+    "thread, 1 disables parallel processing.")
+
 #define USE_STREAM_IMMEDIATE_LONGTEXT N_( \
      "This option is useful if you want to lower the latency when " \
      "reading a stream")
@@ -1063,6 +1081,12 @@ static const char *const ppsz_prefres[] = {
 #define STATS_LONGTEXT N_( \
      "Collect miscellaneous local statistics about the playing media.")
 
+#define FRAME_TRACE_TEXT N_("Frame timing trace file")
+#define FRAME_TRACE_LONGTEXT N_( \
+     "Record when each frame goes through the demuxer, the decoder and the " \
+     "video output, and write it to this file in the Chrome trace event " \
+     "format when VLC exits. Only the latest events are kept.")
+
 #define DAEMON_TEXT N_("Run as daemon process")
 #define DAEMON_LONGTEXT N_( \
      "Runs VLC as a background daemon process.")
@@ -2042,6 +2066,15 @@ vlc_module_begin ()
 
     set_section( N_("Performance options"), NULL )
 
+    add_bool( "block-cache", true, BLOCK_CACHE_TEXT,
+              BLOCK_CACHE_LONGTEXT, true )
+    add_integer_with_range( "executor-threads", 0, 0, 256,
+                            EXECUTOR_THREADS_TEXT,
+                            EXECUTOR_THREADS_LONGTEXT, true )
+    add_integer_with_range( "filter-slices", 0, 0, 16,
+                            FILTER_SLICES_TEXT,
+                            FILTER_SLICES_LONGTEXT, true )
+
 #if defined (LIBVLC_USE_PTHREAD) && !defined (__APPLE__)
     add_bool( "rt-priority", false, RT_PRIORITY_TEXT,
               RT_PRIORITY_LONGTEXT, true )
@@ -2161,6 +2194,8 @@ vlc_module_begin ()
               INTERACTION_LONGTEXT, false )
 
     add_bool ( "stats", true, STATS_TEXT, STATS_LONGTEXT, true )
+    add_savefile( "frame-trace", NULL, FRAME_TRACE_TEXT,
+                  FRAME_TRACE_LONGTEXT, true )
 
     set_subcategory( SUBCAT_INTERFACE_MAIN )
     add_module_cat( "intf", SUBCAT_INTERFACE_MAIN, NULL, INTF_TEXT,
@@ -228,6 +228,10 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
         msg_Warn( p_libvlc, "memory keystore init failed" );
 
     vlc_CPU_dump( VLC_OBJECT(p_libvlc) );
+    block_CacheInit( p_libvlc );
+    vlc_FrameTraceInit( p_libvlc );
+    if( vlc_ExecutorInit( p_libvlc ) != VLC_SUCCESS )
+        goto error;
 
     priv->b_stats = var_InheritBool( p_libvlc, "stats" );
 
@@ -422,6 +426,10 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
     if( !var_InheritBool( p_libvlc, "ignore-config" ) )
         config_AutoSaveConfigFile( VLC_OBJECT(p_libvlc) );
 
+    vlc_ExecutorDeinit( p_libvlc );
+    vlc_FrameTraceDeinit( p_libvlc );
+    block_CacheDeinit( p_libvlc );
+
     /* Free module bank. It is refcounted, so we call this each time  */
     vlc_LogDeinit (p_libvlc);
     module_EndBank (true);
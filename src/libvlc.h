@@ -45,6 +45,35 @@ size_t EnumClockSource( vlc_object_t *, const char *, char ***, char *** );
 void vlc_CPU_init(void);
 void vlc_CPU_dump(vlc_object_t *);
 
+/*
+ * Data blocks cache
+ */
+void block_CacheInit(libvlc_int_t *);
+void block_CacheDeinit(libvlc_int_t *);
+
+/*
+ * Frame timing trace
+ */
+typedef struct vlc_frame_trace_t vlc_frame_trace_t;
+
+enum vlc_frame_trace_stage
+{
+    VLC_FRAME_TRACE_ES_OUT_SEND, /**< block sent by the demuxer */
+    VLC_FRAME_TRACE_DECODER_DEQUEUE, /**< block taken by the decoder thread */
+    VLC_FRAME_TRACE_DECODED, /**< picture output by the decoder */
+    VLC_FRAME_TRACE_VOUT_QUEUE, /**< picture queued to the video output */
+    VLC_FRAME_TRACE_VOUT_RENDER, /**< picture rendered by the video output */
+    VLC_FRAME_TRACE_VOUT_DISPLAY, /**< picture displayed */
+};
+
+int vlc_ExecutorInit(libvlc_int_t *);
+void vlc_ExecutorDeinit(libvlc_int_t *);
+
+void vlc_FrameTraceInit(libvlc_int_t *);
+void vlc_FrameTraceDeinit(libvlc_int_t *);
+void vlc_FrameTraceRecord(vlc_frame_trace_t *, enum vlc_frame_trace_stage,
+                          int cat, int es_id, mtime_t ts);
+
 /*
  * Threads subsystem
  */
@@ -191,6 +220,8 @@ typedef struct libvlc_priv_t
     struct playlist_t *playlist; ///< Playlist for interfaces
     struct playlist_preparser_t *parser; ///< Input item meta data handler
     vlc_actions_t *actions; ///< Hotkeys handler
+    vlc_frame_trace_t *frame_trace; ///< Frame timing trace (or NULL)
+    struct vlc_executor *executor; ///< Shared thread pool
 
     /* Exit callback */
     vlc_exit_t       exit;
@@ -207,6 +238,17 @@ void intf_DestroyAll( libvlc_int_t * );
 
 #define libvlc_stats( o ) (libvlc_priv((VLC_OBJECT(o))->obj.libvlc)->b_stats)
 
+/**
+ * Records a frame timing trace event, if tracing is enabled.
+ */
+#define vlc_FrameTrace( o, stage, cat, es_id, ts ) \
+    do { \
+        vlc_frame_trace_t *trace_ = \
+            libvlc_priv((VLC_OBJECT(o))->obj.libvlc)->frame_trace; \
+        if( unlikely(trace_ != NULL) ) \
+            vlc_FrameTraceRecord( trace_, stage, cat, es_id, ts ); \
+    } while( 0 )
+
 int vlc_MetadataRequest(libvlc_int_t *libvlc, input_item_t *item,
                         input_item_meta_request_option_t i_options,
                         int timeout, void *id);
@@ -34,6 +34,8 @@
 #include <vlc_common.h>
 #include <vlc_block.h>
 #include <vlc_fs.h>
+#include <vlc_atomic.h>
+#include "../libvlc.h"
 
 #ifndef NDEBUG
 static void BlockNoRelease( block_t *b )
@@ -117,6 +119,275 @@ static void BlockMetaCopy( block_t *restrict out, const block_t *in )
 /** Initial reserved header and footer size. */
 #define BLOCK_PADDING      32
 
+/*****************************************************************************
+ * Blocks cache
+ *****************************************************************************
+ * The memory of the blocks up to BLOCK_CACHE_MAX bytes is allocated by size
+ * classes, and kept on release to be reused by the next allocations of the
+ * same class. Each thread caches blocks in its own magazines, without
+ * locking. Full or empty magazines are balanced with a global depot.
+ *
+ * There are four classes per power of two, so that rounding the allocations
+ * up to their class wastes less than a quarter of them.
+ *
+ * The cache is shared by all the LibVLC instances of the process: the
+ * "block-cache" value last set by any of them applies to all.
+ *****************************************************************************/
+#define BLOCK_CACHE_MIN_SHIFT 8  /* smallest class, 256 bytes */
+#define BLOCK_CACHE_CLASSES  33  /* up to 64 KiB */
+#define BLOCK_CACHE_MAX      (1 << (BLOCK_CACHE_MIN_SHIFT + 8))
+/** Memory cached by a thread for each class, in bytes */
+#define BLOCK_MAGAZINE_BYTES (32 * 1024)
+#define BLOCK_MAGAZINE_MAX   32
+#define BLOCK_DEPOT_MAGAZINES 4
+
+typedef struct
+{
+    unsigned count;
+    block_t *blocks[BLOCK_MAGAZINE_MAX];
+} block_magazine_t;
+
+static struct
+{
+    vlc_mutex_t      lock;
+    unsigned         refs;
+    bool             key_created;
+    vlc_threadvar_t  key; /* block_magazine_t[BLOCK_CACHE_CLASSES] */
+    atomic_bool      enabled;
+
+    /* depot */
+    unsigned         count[BLOCK_CACHE_CLASSES];
+    block_t         *blocks[BLOCK_CACHE_CLASSES]
+                           [BLOCK_DEPOT_MAGAZINES * BLOCK_MAGAZINE_MAX];
+
+    /* statistics */
+    atomic_ullong    hits;
+    atomic_ullong    misses;
+    atomic_size_t    resident; /* bytes of the cached blocks */
+} block_cache = {
+    .lock = VLC_STATIC_MUTEX,
+    .enabled = ATOMIC_VAR_INIT(false),
+    .hits = ATOMIC_VAR_INIT(0),
+    .misses = ATOMIC_VAR_INIT(0),
+    .resident = ATOMIC_VAR_INIT(0),
+};
+
+/* Classes are 4, 5, 6 and 7 times a power of two */
+static size_t block_cache_ClassSize(unsigned i_class)
+{
+    return (size_t)(4 + (i_class & 3))
+           << (BLOCK_CACHE_MIN_SHIFT - 2 + i_class / 4);
+}
+
+/** Number of blocks a magazine holds for a class */
+static unsigned block_cache_MagazineSize(unsigned i_class)
+{
+    unsigned count = BLOCK_MAGAZINE_BYTES / block_cache_ClassSize(i_class);
+    return VLC_CLIP(count, 2, BLOCK_MAGAZINE_MAX);
+}
+
+static unsigned block_cache_GetClass(size_t alloc)
+{
+    if (alloc <= (1 << BLOCK_CACHE_MIN_SHIFT))
+        return 0;
+
+    /* alloc is in ]2^log, 2^(log + 1)], the classes of that range being 5, 6,
+     * 7 and 8 times 2^(log - 2) */
+    const unsigned log = (sizeof (unsigned) * 8 - 1) - clz(alloc - 1);
+    const unsigned step = (alloc + (1 << (log - 2)) - 1) >> (log - 2);
+    const unsigned i_class = (log - BLOCK_CACHE_MIN_SHIFT) * 4 + step - 4;
+
+    assert(i_class < BLOCK_CACHE_CLASSES);
+    assert(block_cache_ClassSize(i_class) >= alloc);
+    assert(i_class == 0 || block_cache_ClassSize(i_class - 1) < alloc);
+    return i_class;
+}
+
+/** Moves blocks from the depot to an empty magazine */
+static void block_cache_Refill(block_magazine_t *mag, unsigned i_class)
+{
+    unsigned count = block_cache_MagazineSize(i_class) / 2;
+
+    vlc_mutex_lock(&block_cache.lock);
+    if (count > block_cache.count[i_class])
+        count = block_cache.count[i_class];
+    block_cache.count[i_class] -= count;
+    memcpy(mag->blocks, &block_cache.blocks[i_class][block_cache.count[i_class]],
+           count * sizeof (block_t *));
+    vlc_mutex_unlock(&block_cache.lock);
+    mag->count = count;
+}
+
+/** Moves blocks from a magazine to the depot, freeing those not fitting */
+static void block_cache_Flush(block_magazine_t *mag, unsigned i_class,
+                              unsigned count)
+{
+    /* Nothing is kept once the cache is disabled */
+    const unsigned depot_size = atomic_load(&block_cache.enabled)
+        ? BLOCK_DEPOT_MAGAZINES * block_cache_MagazineSize(i_class) : 0;
+    unsigned i = 0;
+
+    assert(count <= mag->count);
+    vlc_mutex_lock(&block_cache.lock);
+    for (; i < count && block_cache.count[i_class] < depot_size; i++)
+        block_cache.blocks[i_class][block_cache.count[i_class]++] =
+            mag->blocks[--mag->count];
+    vlc_mutex_unlock(&block_cache.lock);
+
+    for (; i < count; i++)
+    {
+        free(mag->blocks[--mag->count]);
+        atomic_fetch_sub(&block_cache.resident, block_cache_ClassSize(i_class));
+    }
+}
+
+static void block_cache_ThreadExit(void *data)
+{
+    block_magazine_t *mags = data;
+
+    for (unsigned i = 0; i < BLOCK_CACHE_CLASSES; i++)
+        block_cache_Flush(&mags[i], i, mags[i].count);
+    free(mags);
+}
+
+static block_magazine_t *block_cache_GetMagazines(void)
+{
+    block_magazine_t *mags = vlc_threadvar_get(block_cache.key);
+    if (likely(mags != NULL))
+        return mags;
+
+    mags = calloc(BLOCK_CACHE_CLASSES, sizeof (*mags));
+    if (likely(mags != NULL) && vlc_threadvar_set(block_cache.key, mags))
+    {
+        free(mags);
+        mags = NULL;
+    }
+    return mags;
+}
+
+/** Gets a block of a class from the cache, or allocates it */
+static block_t *block_cache_Alloc(size_t *restrict alloc)
+{
+    const unsigned i_class = block_cache_GetClass(*alloc);
+    block_magazine_t *mags = block_cache_GetMagazines();
+
+    *alloc = block_cache_ClassSize(i_class);
+    if (likely(mags != NULL))
+    {
+        block_magazine_t *mag = &mags[i_class];
+        if (mag->count == 0)
+            block_cache_Refill(mag, i_class);
+        if (mag->count > 0)
+        {
+            atomic_fetch_add(&block_cache.hits, 1);
+            atomic_fetch_sub(&block_cache.resident, *alloc);
+            return mag->blocks[--mag->count];
+        }
+    }
+
+    atomic_fetch_add(&block_cache.misses, 1);
+    return malloc(*alloc);
+}
+
+static void block_cache_Release(block_t *block)
+{
+    const size_t alloc = sizeof (*block) + block->i_size;
+    const unsigned i_class = block_cache_GetClass(alloc);
+
+    /* That is always true for blocks allocated with block_Alloc(). */
+    assert(block->p_start == (unsigned char *)(block + 1));
+    assert(alloc == block_cache_ClassSize(i_class));
+    block_Invalidate(block);
+
+    block_magazine_t *mags = atomic_load_explicit(&block_cache.enabled,
+                                                  memory_order_relaxed)
+                           ? block_cache_GetMagazines() : NULL;
+    if (unlikely(mags == NULL))
+    {
+        free(block);
+        return;
+    }
+
+    block_magazine_t *mag = &mags[i_class];
+    const unsigned size = block_cache_MagazineSize(i_class);
+    if (mag->count >= size)
+        block_cache_Flush(mag, i_class, size / 2);
+    mag->blocks[mag->count++] = block;
+    atomic_fetch_add(&block_cache.resident, alloc);
+}
+
+static int block_cache_Changed(vlc_object_t *obj, const char *var,
+                               vlc_value_t oldval, vlc_value_t newval,
+                               void *data)
+{
+    (void) obj; (void) var; (void) oldval; (void) data;
+    atomic_store(&block_cache.enabled, newval.b_bool);
+    return VLC_SUCCESS;
+}
+
+void block_CacheInit(libvlc_int_t *libvlc)
+{
+    var_Create(libvlc, "block-cache", VLC_VAR_BOOL | VLC_VAR_DOINHERIT);
+
+    vlc_mutex_lock(&block_cache.lock);
+    /* The key is kept for the process lifetime, as the magazines of running
+     * threads are freed when those exit */
+    if (!block_cache.key_created)
+        block_cache.key_created =
+            !vlc_threadvar_create(&block_cache.key, block_cache_ThreadExit);
+    if (block_cache.key_created)
+    {
+        block_cache.refs++;
+        atomic_store(&block_cache.enabled, var_GetBool(libvlc, "block-cache"));
+        var_AddCallback(libvlc, "block-cache", block_cache_Changed, NULL);
+    }
+    vlc_mutex_unlock(&block_cache.lock);
+}
+
+void block_CacheDeinit(libvlc_int_t *libvlc)
+{
+    if (var_Type(libvlc, "block-cache") == 0)
+        return; /* not initialized */
+
+    /* The magazines of the calling thread, normally the main one, would
+     * otherwise be kept until it exits, if ever */
+    if (block_cache.key_created)
+    {
+        block_magazine_t *mags = vlc_threadvar_get(block_cache.key);
+        if (mags != NULL)
+        {
+            vlc_threadvar_set(block_cache.key, NULL);
+            block_cache_ThreadExit(mags);
+        }
+    }
+
+    msg_Dbg(libvlc, "blocks cache: %llu hits, %llu misses, %zu KiB resident",
+            atomic_load(&block_cache.hits), atomic_load(&block_cache.misses),
+            atomic_load(&block_cache.resident) >> 10);
+
+    vlc_mutex_lock(&block_cache.lock);
+    if (block_cache.key_created)
+    {
+        var_DelCallback(libvlc, "block-cache", block_cache_Changed, NULL);
+        assert(block_cache.refs > 0);
+        if (--block_cache.refs == 0)
+        {
+            atomic_store(&block_cache.enabled, false);
+            for (unsigned i = 0; i < BLOCK_CACHE_CLASSES; i++)
+            {
+                while (block_cache.count[i] > 0)
+                {
+                    free(block_cache.blocks[i][--block_cache.count[i]]);
+                    atomic_fetch_sub(&block_cache.resident,
+                                     block_cache_ClassSize(i));
+                }
+            }
+        }
+    }
+    vlc_mutex_unlock(&block_cache.lock);
+    var_Destroy(libvlc, "block-cache");
+}
+
 block_t *block_Alloc (size_t size)
 {
     if (unlikely(size >> 27))
@@ -126,12 +397,14 @@ block_t *block_Alloc (size_t size)
     }
 
     /* 2 * BLOCK_PADDING: pre + post padding */
-    const size_t alloc = sizeof (block_t) + BLOCK_ALIGN + (2 * BLOCK_PADDING)
-                       + size;
+    size_t alloc = sizeof (block_t) + BLOCK_ALIGN + (2 * BLOCK_PADDING)
+                 + size;
     if (unlikely(alloc <= size))
         return NULL;
 
-    block_t *b = malloc (alloc);
+    const bool cached = alloc <= BLOCK_CACHE_MAX
+        && atomic_load_explicit(&block_cache.enabled, memory_order_relaxed);
+    block_t *b = cached ? block_cache_Alloc (&alloc) : malloc (alloc);
     if (unlikely(b == NULL))
         return NULL;
 
@@ -141,7 +414,7 @@ block_t *block_Alloc (size_t size)
     b->p_buffer += BLOCK_PADDING + BLOCK_ALIGN - 1;
     b->p_buffer = (void *)(((uintptr_t)b->p_buffer) & ~(BLOCK_ALIGN - 1));
     b->i_buffer = size;
-    b->pf_release = block_generic_Release;
+    b->pf_release = cached ? block_cache_Release : block_generic_Release;
     return b;
 }
 
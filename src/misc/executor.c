@@ -0,0 +1,393 @@
+/*****************************************************************************
+ * executor.c: work-stealing thread pool
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_cpu.h>
+#include <vlc_executor.h>
+#include "libvlc.h"
+
+struct executor_worker
+{
+    vlc_executor_t *executor;
+    vlc_thread_t thread;
+    unsigned index;
+
+    /* The owner takes tasks from the back, other workers steal from the
+     * front. Tasks from the owner are queued at the back (and run last-in
+     * first-out), other tasks at the front (and run first-in first-out). */
+    vlc_mutex_t lock;
+    struct vlc_runnable *first;
+    struct vlc_runnable *last;
+};
+
+struct vlc_executor
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    bool closing;
+    vlc_threadvar_t current; /**< worker of the calling thread */
+
+    unsigned max_threads;
+    atomic_uint threads;
+    atomic_uint idle;
+    atomic_uint pending; /**< queued tasks, over all workers */
+    atomic_uint next; /**< round-robin for external submissions */
+
+    atomic_uint_least64_t submitted;
+    atomic_uint_least64_t completed;
+    atomic_uint_least64_t canceled;
+    atomic_uint_least64_t stolen;
+    atomic_uint_least64_t busy;
+    mtime_t created;
+
+    struct executor_worker workers[];
+};
+
+static void QueuePush(struct executor_worker *w, struct vlc_runnable *r,
+                      bool back)
+{
+    vlc_executor_t *ex = w->executor;
+
+    vlc_mutex_lock(&w->lock);
+    if (back)
+    {
+        r->prev = w->last;
+        r->next = NULL;
+        if (w->last != NULL)
+            w->last->next = r;
+        else
+            w->first = r;
+        w->last = r;
+    }
+    else
+    {
+        r->prev = NULL;
+        r->next = w->first;
+        if (w->first != NULL)
+            w->first->prev = r;
+        else
+            w->last = r;
+        w->first = r;
+    }
+    /* Counted under the queue lock, so that the pending count never falls
+     * below the number of tasks that other workers can find. */
+    atomic_fetch_add(&ex->pending, 1);
+    vlc_mutex_unlock(&w->lock);
+}
+
+static void QueueUnlink(struct executor_worker *w, struct vlc_runnable *r)
+{
+    if (r->prev != NULL)
+        r->prev->next = r->next;
+    else
+        w->first = r->next;
+    if (r->next != NULL)
+        r->next->prev = r->prev;
+    else
+        w->last = r->prev;
+    atomic_fetch_sub(&w->executor->pending, 1);
+}
+
+static struct vlc_runnable *QueuePop(struct executor_worker *w, bool back)
+{
+    struct vlc_runnable *r;
+
+    vlc_mutex_lock(&w->lock);
+    r = back ? w->last : w->first;
+    if (r != NULL)
+        QueueUnlink(w, r);
+    vlc_mutex_unlock(&w->lock);
+    return r;
+}
+
+static struct vlc_runnable *WorkerTake(struct executor_worker *self)
+{
+    vlc_executor_t *ex = self->executor;
+    struct vlc_runnable *r = QueuePop(self, true);
+
+    if (r != NULL)
+        return r;
+
+    unsigned n = atomic_load(&ex->threads);
+
+    for (unsigned i = 1; i < n; i++)
+    {
+        r = QueuePop(&ex->workers[(self->index + i) % n], false);
+        if (r != NULL)
+        {
+            atomic_fetch_add_explicit(&ex->stolen, 1, memory_order_relaxed);
+            return r;
+        }
+    }
+    return NULL;
+}
+
+static void *WorkerThread(void *data)
+{
+    struct executor_worker *self = data;
+    vlc_executor_t *ex = self->executor;
+
+    vlc_threadvar_set(ex->current, self);
+
+    for (;;)
+    {
+        struct vlc_runnable *r = WorkerTake(self);
+
+        if (r != NULL)
+        {
+            mtime_t start = mdate();
+
+            r->run(r->userdata);
+            atomic_fetch_add_explicit(&ex->busy, mdate() - start,
+                                      memory_order_relaxed);
+            atomic_fetch_add_explicit(&ex->completed, 1,
+                                      memory_order_relaxed);
+            continue;
+        }
+
+        /* Both the idle and pending counts are sequentially consistent:
+         * either this thread sees the new task, or the submitter sees this
+         * thread as idle and signals it. */
+        vlc_mutex_lock(&ex->lock);
+        atomic_fetch_add(&ex->idle, 1);
+        while (atomic_load(&ex->pending) == 0 && !ex->closing)
+            vlc_cond_wait(&ex->wait, &ex->lock);
+        atomic_fetch_sub(&ex->idle, 1);
+
+        bool done = ex->closing && atomic_load(&ex->pending) == 0;
+        vlc_mutex_unlock(&ex->lock);
+        if (done)
+            break;
+    }
+    return NULL;
+}
+
+/* Starts one more worker if allowed. Called with the executor lock held. */
+static bool SpawnWorker(vlc_executor_t *ex)
+{
+    unsigned n = atomic_load(&ex->threads);
+
+    if (n >= ex->max_threads)
+        return false;
+
+    struct executor_worker *w = &ex->workers[n];
+
+    if (vlc_clone(&w->thread, WorkerThread, w, VLC_THREAD_PRIORITY_LOW))
+        return false;
+    atomic_store(&ex->threads, n + 1);
+    return true;
+}
+
+vlc_executor_t *vlc_executor_New(unsigned max_threads)
+{
+    assert(max_threads > 0);
+
+    vlc_executor_t *ex = malloc(sizeof (*ex)
+                                + max_threads * sizeof (ex->workers[0]));
+    if (unlikely(ex == NULL))
+        return NULL;
+
+    if (vlc_threadvar_create(&ex->current, NULL))
+    {
+        free(ex);
+        return NULL;
+    }
+
+    vlc_mutex_init(&ex->lock);
+    vlc_cond_init(&ex->wait);
+    ex->closing = false;
+    ex->max_threads = max_threads;
+    atomic_init(&ex->threads, 0);
+    atomic_init(&ex->idle, 0);
+    atomic_init(&ex->pending, 0);
+    atomic_init(&ex->next, 0);
+    atomic_init(&ex->submitted, 0);
+    atomic_init(&ex->completed, 0);
+    atomic_init(&ex->canceled, 0);
+    atomic_init(&ex->stolen, 0);
+    atomic_init(&ex->busy, 0);
+    ex->created = mdate();
+
+    for (unsigned i = 0; i < max_threads; i++)
+    {
+        struct executor_worker *w = &ex->workers[i];
+
+        w->executor = ex;
+        w->index = i;
+        vlc_mutex_init(&w->lock);
+        w->first = NULL;
+        w->last = NULL;
+    }
+    return ex;
+}
+
+void vlc_executor_Delete(vlc_executor_t *ex)
+{
+    vlc_mutex_lock(&ex->lock);
+    ex->closing = true;
+    vlc_cond_broadcast(&ex->wait);
+    vlc_mutex_unlock(&ex->lock);
+
+    unsigned n = atomic_load(&ex->threads);
+
+    for (unsigned i = 0; i < n; i++)
+        vlc_join(ex->workers[i].thread, NULL);
+    assert(atomic_load(&ex->pending) == 0);
+
+    for (unsigned i = 0; i < ex->max_threads; i++)
+        vlc_mutex_destroy(&ex->workers[i].lock);
+    vlc_cond_destroy(&ex->wait);
+    vlc_mutex_destroy(&ex->lock);
+    vlc_threadvar_delete(&ex->current);
+    free(ex);
+}
+
+void vlc_executor_Submit(vlc_executor_t *ex, struct vlc_runnable *r)
+{
+    struct executor_worker *w = vlc_threadvar_get(ex->current);
+    bool local = w != NULL && w->executor == ex;
+
+    atomic_fetch_add_explicit(&ex->submitted, 1, memory_order_relaxed);
+
+    if (!local)
+    {   /* Not from one of our workers: spread the tasks */
+        unsigned n = atomic_load(&ex->threads);
+
+        if (unlikely(n == 0))
+        {
+            vlc_mutex_lock(&ex->lock);
+            SpawnWorker(ex);
+            n = atomic_load(&ex->threads);
+            vlc_mutex_unlock(&ex->lock);
+
+            if (unlikely(n == 0))
+            {   /* No threads at all: run it here rather than never */
+                r->run(r->userdata);
+                atomic_fetch_add_explicit(&ex->completed, 1,
+                                          memory_order_relaxed);
+                return;
+            }
+        }
+        w = &ex->workers[atomic_fetch_add_explicit(&ex->next, 1,
+                                                   memory_order_relaxed) % n];
+    }
+
+    QueuePush(w, r, local);
+
+    /* Wake an idle worker up, or start a new one if there are none. */
+    if (atomic_load(&ex->idle) > 0
+     || atomic_load(&ex->threads) < ex->max_threads)
+    {
+        vlc_mutex_lock(&ex->lock);
+        if (atomic_load(&ex->idle) > 0)
+            vlc_cond_signal(&ex->wait);
+        else
+            SpawnWorker(ex);
+        vlc_mutex_unlock(&ex->lock);
+    }
+}
+
+bool vlc_executor_Cancel(vlc_executor_t *ex, struct vlc_runnable *r)
+{
+    unsigned n = atomic_load(&ex->threads);
+
+    for (unsigned i = 0; i < n; i++)
+    {
+        struct executor_worker *w = &ex->workers[i];
+
+        vlc_mutex_lock(&w->lock);
+        for (struct vlc_runnable *p = w->first; p != NULL; p = p->next)
+            if (p == r)
+            {
+                QueueUnlink(w, r);
+                vlc_mutex_unlock(&w->lock);
+                atomic_fetch_add_explicit(&ex->canceled, 1,
+                                          memory_order_relaxed);
+                return true;
+            }
+        vlc_mutex_unlock(&w->lock);
+    }
+    return false;
+}
+
+void vlc_executor_GetStats(vlc_executor_t *ex,
+                           struct vlc_executor_stats *restrict stats)
+{
+    stats->threads = atomic_load(&ex->threads);
+    stats->max_threads = ex->max_threads;
+    stats->submitted = atomic_load_explicit(&ex->submitted,
+                                            memory_order_relaxed);
+    stats->completed = atomic_load_explicit(&ex->completed,
+                                            memory_order_relaxed);
+    stats->canceled = atomic_load_explicit(&ex->canceled,
+                                           memory_order_relaxed);
+    stats->stolen = atomic_load_explicit(&ex->stolen, memory_order_relaxed);
+    stats->busy = atomic_load_explicit(&ex->busy, memory_order_relaxed);
+    stats->uptime = mdate() - ex->created;
+}
+
+#undef vlc_executor_GetShared
+vlc_executor_t *vlc_executor_GetShared(vlc_object_t *obj)
+{
+    return libvlc_priv(obj->obj.libvlc)->executor;
+}
+
+int vlc_ExecutorInit(libvlc_int_t *libvlc)
+{
+    libvlc_priv_t *priv = libvlc_priv(libvlc);
+    int64_t threads = var_InheritInteger(libvlc, "executor-threads");
+
+    if (threads <= 0)
+        threads = vlc_GetCPUCount();
+
+    priv->executor = vlc_executor_New(threads);
+    if (unlikely(priv->executor == NULL))
+        return VLC_ENOMEM;
+    return VLC_SUCCESS;
+}
+
+void vlc_ExecutorDeinit(libvlc_int_t *libvlc)
+{
+    libvlc_priv_t *priv = libvlc_priv(libvlc);
+    vlc_executor_t *ex = priv->executor;
+
+    if (ex == NULL)
+        return;
+
+    struct vlc_executor_stats st;
+
+    vlc_executor_GetStats(ex, &st);
+    if (st.threads > 0)
+        msg_Dbg(libvlc, "executor: %"PRIu64" tasks (%"PRIu64" stolen, "
+                "%"PRIu64" canceled) on %u/%u threads, %.1f%% busy",
+                st.completed, st.stolen, st.canceled, st.threads,
+                st.max_threads,
+                100. * st.busy / (st.uptime * (double)st.threads));
+    vlc_executor_Delete(ex);
+    priv->executor = NULL;
+}
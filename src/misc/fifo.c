@@ -30,6 +30,7 @@
 
 #include <vlc_common.h>
 #include <vlc_block.h>
+#include <vlc_atomic.h>
 #include "libvlc.h"
 
 /**
@@ -233,3 +234,198 @@ size_t block_FifoCount (block_fifo_t *fifo)
     vlc_mutex_unlock (&fifo->lock);
     return depth;
 }
+
+/**
+ * Single producer, single consumer block queue.
+ *
+ * Blocks are stored in a linked list of fixed size segments. The producer
+ * only touches the tail and the consumer only touches the head; the element
+ * count is the only shared state on the fast path. The consumer sleeps on a
+ * condition variable, which the producer signals only when the queue goes
+ * from empty to non-empty while the consumer is actually waiting.
+ */
+#define BLOCK_SPSC_SEGMENT 254
+
+typedef struct block_spsc_segment_t
+{
+    atomic_uintptr_t next;
+    block_t *blocks[BLOCK_SPSC_SEGMENT];
+} block_spsc_segment_t;
+
+struct block_spsc_t
+{
+    /* Producer side */
+    block_spsc_segment_t *tail;
+    unsigned tail_index;
+
+    /* Consumer side */
+    block_spsc_segment_t *head;
+    unsigned head_index;
+
+    atomic_size_t count;
+    atomic_size_t bytes;
+    atomic_uintptr_t spare; /**< Recycled segment */
+    atomic_bool waiting;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+};
+
+static block_spsc_segment_t *block_SpscSegmentNew(block_spsc_t *q)
+{
+    block_spsc_segment_t *seg =
+        (block_spsc_segment_t *)atomic_exchange(&q->spare, (uintptr_t)NULL);
+
+    if (seg == NULL)
+    {
+        seg = malloc(sizeof (*seg));
+        if (unlikely(seg == NULL))
+            return NULL;
+    }
+    atomic_init(&seg->next, (uintptr_t)NULL);
+    return seg;
+}
+
+block_spsc_t *block_SpscNew(void)
+{
+    block_spsc_t *q = malloc(sizeof (*q));
+    if (unlikely(q == NULL))
+        return NULL;
+
+    atomic_init(&q->spare, (uintptr_t)NULL);
+    q->head = q->tail = block_SpscSegmentNew(q);
+    if (unlikely(q->head == NULL))
+    {
+        free(q);
+        return NULL;
+    }
+    q->head_index = q->tail_index = 0;
+    atomic_init(&q->count, 0);
+    atomic_init(&q->bytes, 0);
+    atomic_init(&q->waiting, false);
+    vlc_mutex_init(&q->lock);
+    vlc_cond_init(&q->wait);
+    return q;
+}
+
+void block_SpscRelease(block_spsc_t *q)
+{
+    block_t *block;
+
+    while ((block = block_SpscTryGet(q)) != NULL)
+        block_Release(block);
+
+    free(q->head);
+    free((void *)atomic_load(&q->spare));
+    vlc_cond_destroy(&q->wait);
+    vlc_mutex_destroy(&q->lock);
+    free(q);
+}
+
+void block_SpscPut(block_spsc_t *q, block_t *block)
+{
+    size_t count = 0, bytes = 0;
+
+    while (block != NULL)
+    {
+        block_t *next = block->p_next;
+
+        if (q->tail_index == BLOCK_SPSC_SEGMENT)
+        {
+            block_spsc_segment_t *seg = block_SpscSegmentNew(q);
+            if (unlikely(seg == NULL))
+            {
+                block_ChainRelease(block);
+                break;
+            }
+            atomic_store_explicit(&q->tail->next, (uintptr_t)seg,
+                                  memory_order_release);
+            q->tail = seg;
+            q->tail_index = 0;
+        }
+
+        block->p_next = NULL;
+        q->tail->blocks[q->tail_index++] = block;
+        count++;
+        bytes += block->i_buffer;
+        block = next;
+    }
+
+    if (count == 0)
+        return;
+
+    atomic_fetch_add_explicit(&q->bytes, bytes, memory_order_relaxed);
+    /* Sequentially consistent, paired with the waiting flag below */
+    if (atomic_fetch_add(&q->count, count) == 0
+     && atomic_load(&q->waiting))
+    {
+        vlc_mutex_lock(&q->lock);
+        vlc_cond_signal(&q->wait);
+        vlc_mutex_unlock(&q->lock);
+    }
+}
+
+block_t *block_SpscTryGet(block_spsc_t *q)
+{
+    if (atomic_load_explicit(&q->count, memory_order_acquire) == 0)
+        return NULL;
+
+    if (q->head_index == BLOCK_SPSC_SEGMENT)
+    {
+        block_spsc_segment_t *old = q->head;
+
+        q->head = (block_spsc_segment_t *)
+            atomic_load_explicit(&old->next, memory_order_acquire);
+        q->head_index = 0;
+        assert(q->head != NULL);
+        free((void *)atomic_exchange(&q->spare, (uintptr_t)old));
+    }
+
+    block_t *block = q->head->blocks[q->head_index++];
+
+    atomic_fetch_sub_explicit(&q->bytes, block->i_buffer,
+                              memory_order_relaxed);
+    atomic_fetch_sub_explicit(&q->count, 1, memory_order_relaxed);
+    return block;
+}
+
+static void block_SpscCleanup(void *data)
+{
+    block_spsc_t *q = data;
+
+    atomic_store(&q->waiting, false);
+    vlc_mutex_unlock(&q->lock);
+}
+
+block_t *block_SpscGet(block_spsc_t *q)
+{
+    block_t *block;
+
+    vlc_testcancel();
+
+    block = block_SpscTryGet(q);
+    if (block != NULL)
+        return block;
+
+    vlc_mutex_lock(&q->lock);
+    atomic_store(&q->waiting, true);
+    vlc_cleanup_push(block_SpscCleanup, q);
+    while (atomic_load(&q->count) == 0)
+        vlc_cond_wait(&q->wait, &q->lock);
+    vlc_cleanup_pop();
+    block_SpscCleanup(q);
+
+    block = block_SpscTryGet(q);
+    assert(block != NULL);
+    return block;
+}
+
+size_t block_SpscCount(block_spsc_t *q)
+{
+    return atomic_load_explicit(&q->count, memory_order_relaxed);
+}
+
+size_t block_SpscSize(block_spsc_t *q)
+{
+    return atomic_load_explicit(&q->bytes, memory_order_relaxed);
+}
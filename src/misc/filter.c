@@ -29,6 +29,7 @@
 
 #include <vlc_common.h>
 #include <libvlc.h>
+#include <vlc_executor.h>
 #include <vlc_filter.h>
 #include <vlc_modules.h>
 #include "../misc/variables.h"
@@ -100,8 +101,106 @@ void filter_DelProxyCallbacks( vlc_object_t *obj, filter_t *filter,
     free(names);
 }
 
-/* */
+/* Bands are whole multiples of this many lines (but the last one), so that
+ * they split the chroma planes evenly. */
+#define FILTER_SLICE_ALIGN 16
+#define FILTER_SLICE_MIN_LINES 64
+#define FILTER_SLICES_MAX 16
+
+struct filter_slices
+{
+    filter_t *filter;
+    picture_t *outpic;
+    const picture_t *inpic;
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    unsigned pending;
+};
+
+struct filter_slice
+{
+    struct vlc_runnable runnable;
+    struct filter_slices *slices;
+    unsigned first;
+    unsigned lines;
+};
+
+static void FilterSliceDone( struct filter_slices *slices )
+{
+    vlc_mutex_lock( &slices->lock );
+    assert( slices->pending > 0 );
+    if( --slices->pending == 0 )
+        vlc_cond_signal( &slices->wait );
+    vlc_mutex_unlock( &slices->lock );
+}
+
+static void FilterSliceRun( void *data )
+{
+    struct filter_slice *slice = data;
+    struct filter_slices *slices = slice->slices;
+    filter_t *filter = slices->filter;
+
+    filter->pf_video_slice( filter, slices->outpic, slices->inpic,
+                            slice->first, slice->lines );
+    FilterSliceDone( slices );
+}
+
+void filter_SliceVideo( filter_t *filter, picture_t *outpic,
+                        const picture_t *inpic )
+{
+    const unsigned lines = outpic->p[0].i_visible_lines;
+    unsigned count = __MIN( filter->owner.video.slices, FILTER_SLICES_MAX );
 
+    assert( filter->pf_video_slice != NULL );
+    count = __MIN( count, lines / FILTER_SLICE_MIN_LINES );
+    if( count <= 1 )
+    {
+        filter->pf_video_slice( filter, outpic, inpic, 0, lines );
+        return;
+    }
+
+    unsigned step = (lines + count - 1) / count;
+    step = (step + FILTER_SLICE_ALIGN - 1) & ~(FILTER_SLICE_ALIGN - 1);
+    count = (lines + step - 1) / step;
+
+    vlc_executor_t *executor = vlc_executor_GetShared( filter );
+    struct filter_slices slices = {
+        .filter = filter,
+        .outpic = outpic,
+        .inpic = inpic,
+        .pending = count - 1,
+    };
+    struct filter_slice slice[FILTER_SLICES_MAX];
+
+    vlc_mutex_init( &slices.lock );
+    vlc_cond_init( &slices.wait );
+
+    for( unsigned i = 1; i < count; i++ )
+    {
+        slice[i].runnable.run = FilterSliceRun;
+        slice[i].runnable.userdata = &slice[i];
+        slice[i].slices = &slices;
+        slice[i].first = i * step;
+        slice[i].lines = __MIN( step, lines - i * step );
+        vlc_executor_Submit( executor, &slice[i].runnable );
+    }
+
+    /* Process the first band on this thread, then take back the bands that
+     * no workers have started yet, rather than wait for them. */
+    filter->pf_video_slice( filter, outpic, inpic, 0, step );
+    for( unsigned i = count - 1; i > 0; i-- )
+        if( vlc_executor_Cancel( executor, &slice[i].runnable ) )
+            FilterSliceRun( &slice[i] );
+
+    vlc_mutex_lock( &slices.lock );
+    while( slices.pending > 0 )
+        vlc_cond_wait( &slices.wait, &slices.lock );
+    vlc_mutex_unlock( &slices.lock );
+    vlc_cond_destroy( &slices.wait );
+    vlc_mutex_destroy( &slices.lock );
+}
+
+/* */
 filter_t *filter_NewBlend( vlc_object_t *p_this,
                            const video_format_t *p_dst_chroma )
 {
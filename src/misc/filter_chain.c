@@ -27,6 +27,7 @@
 
 #include <vlc_filter.h>
 #include <vlc_modules.h>
+#include <vlc_executor.h>
 #include <vlc_mouse.h>
 #include <vlc_spu.h>
 #include <libvlc.h>
@@ -128,6 +129,21 @@ static picture_t *filter_chain_VideoBufferNew( filter_t *filter )
     }
 }
 
+/** Maximum number of bands per picture for row-sliceable video filters */
+static unsigned filter_chain_VideoSlices( vlc_object_t *obj )
+{
+    int64_t slices = var_InheritInteger( obj, "filter-slices" );
+
+    if( slices <= 0 )
+    {
+        struct vlc_executor_stats stats;
+
+        vlc_executor_GetStats( vlc_executor_GetShared( obj ), &stats );
+        slices = stats.max_threads;
+    }
+    return slices;
+}
+
 #undef filter_chain_NewVideo
 filter_chain_t *filter_chain_NewVideo( vlc_object_t *obj, bool allow_change,
                                        const filter_owner_t *restrict owner )
@@ -136,6 +152,7 @@ filter_chain_t *filter_chain_NewVideo( vlc_object_t *obj, bool allow_change,
         .sys = obj,
         .video = {
             .buffer_new = filter_chain_VideoBufferNew,
+            .slices = filter_chain_VideoSlices( obj ),
         },
     };
 
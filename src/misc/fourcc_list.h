@@ -228,6 +228,7 @@ static const staticentry_t p_list_video[] = {
         A("H266"),
         A("h266"),
         A("vvc1"),
+        A("vvi1"),
 
     /* HEVC / H.265 */
     B(VLC_CODEC_HEVC, "MPEG-H Part2/HEVC (H.265)"),
@@ -0,0 +1,191 @@
+/*****************************************************************************
+ * frame_trace.c: frame timing trace
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_arrays.h>
+#include <vlc_atomic.h>
+#include <vlc_es.h>
+#include <vlc_fs.h>
+#include "libvlc.h"
+
+/* Number of events kept in the ring (power of two). Older events are
+ * overwritten: this is about 12 minutes of 60 fps video through all the
+ * stages. */
+#define FRAME_TRACE_EVENTS (1 << 18)
+
+static_assert((FRAME_TRACE_EVENTS & (FRAME_TRACE_EVENTS - 1)) == 0,
+              "Not a power of two");
+
+struct vlc_frame_trace_event
+{
+    atomic_uint   seq; /**< index + 1 once written, 0 while writing */
+    uint8_t       stage;
+    uint8_t       cat;
+    int           es_id;
+    unsigned long thread;
+    mtime_t       date;
+    mtime_t       ts;
+};
+
+struct vlc_frame_trace_t
+{
+    char *path;
+    atomic_uint next;
+    struct vlc_frame_trace_event events[FRAME_TRACE_EVENTS];
+};
+
+static const char *const stage_names[] = {
+    [VLC_FRAME_TRACE_ES_OUT_SEND] = "es_out send",
+    [VLC_FRAME_TRACE_DECODER_DEQUEUE] = "decoder dequeue",
+    [VLC_FRAME_TRACE_DECODED] = "decoded",
+    [VLC_FRAME_TRACE_VOUT_QUEUE] = "vout queue",
+    [VLC_FRAME_TRACE_VOUT_RENDER] = "vout render",
+    [VLC_FRAME_TRACE_VOUT_DISPLAY] = "vout display",
+};
+
+static const char *const cat_names[] = {
+    [UNKNOWN_ES] = "unknown",
+    [VIDEO_ES] = "video",
+    [AUDIO_ES] = "audio",
+    [SPU_ES] = "spu",
+    [DATA_ES] = "data",
+};
+
+void vlc_FrameTraceRecord(vlc_frame_trace_t *trace,
+                          enum vlc_frame_trace_stage stage,
+                          int cat, int es_id, mtime_t ts)
+{
+    unsigned index = atomic_fetch_add_explicit(&trace->next, 1,
+                                               memory_order_relaxed);
+    struct vlc_frame_trace_event *ev =
+        &trace->events[index & (FRAME_TRACE_EVENTS - 1)];
+
+    atomic_store_explicit(&ev->seq, 0, memory_order_relaxed);
+    /* Readers must not see the new fields with the old sequence number */
+    atomic_thread_fence(memory_order_release);
+    ev->stage = stage;
+    ev->cat = (unsigned)cat < ARRAY_SIZE(cat_names) ? cat : UNKNOWN_ES;
+    ev->es_id = es_id;
+    ev->thread = vlc_thread_id();
+    ev->date = mdate();
+    ev->ts = ts;
+    atomic_store_explicit(&ev->seq, index + 1, memory_order_release);
+}
+
+void vlc_FrameTraceInit(libvlc_int_t *libvlc)
+{
+    libvlc_priv_t *priv = libvlc_priv(libvlc);
+    char *path = var_InheritString(libvlc, "frame-trace");
+
+    if (path == NULL)
+        return;
+
+    vlc_frame_trace_t *trace = malloc(sizeof (*trace));
+    if (unlikely(trace == NULL))
+    {
+        free(path);
+        return;
+    }
+
+    trace->path = path;
+    atomic_init(&trace->next, 0);
+    for (unsigned i = 0; i < FRAME_TRACE_EVENTS; i++)
+        atomic_init(&trace->events[i].seq, 0);
+    priv->frame_trace = trace;
+    msg_Dbg(libvlc, "tracing frame timings to %s", path);
+}
+
+static void vlc_FrameTraceDump(libvlc_int_t *libvlc,
+                               const vlc_frame_trace_t *trace)
+{
+    FILE *stream = vlc_fopen(trace->path, "wt");
+    if (stream == NULL)
+    {
+        msg_Err(libvlc, "cannot write frame trace %s: %s", trace->path,
+                vlc_strerror_c(errno));
+        return;
+    }
+
+    unsigned end = atomic_load(&trace->next);
+    unsigned start = 0, count = 0;
+
+    if (end > FRAME_TRACE_EVENTS)
+        start = end - FRAME_TRACE_EVENTS;
+
+    /* Chrome trace event format, one instant event per frame and stage.
+     * The "ts" argument is the stream timestamp of the frame. */
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", stream);
+    for (unsigned i = start; i != end; i++)
+    {
+        const struct vlc_frame_trace_event *ev =
+            &trace->events[i & (FRAME_TRACE_EVENTS - 1)];
+
+        if (atomic_load_explicit(&ev->seq, memory_order_acquire) != i + 1)
+            continue; /* overwritten or being written */
+
+        const uint8_t stage = ev->stage, cat = ev->cat;
+        const int es_id = ev->es_id;
+        const unsigned long thread = ev->thread;
+        const mtime_t date = ev->date, ts = ev->ts;
+
+        /* Make sure that the event was not overwritten while copied */
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&ev->seq, memory_order_relaxed) != i + 1)
+            continue;
+
+        fprintf(stream, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"i\","
+                "\"s\":\"t\",\"ts\":%"PRId64",\"pid\":1,\"tid\":%lu,"
+                "\"args\":{\"es\":%d,\"ts\":%"PRId64"}}",
+                count ? "," : "", stage_names[stage], cat_names[cat], date,
+                thread, es_id, ts);
+        count++;
+    }
+    fputs("\n]}\n", stream);
+
+    if (fclose(stream))
+        msg_Err(libvlc, "cannot write frame trace %s: %s", trace->path,
+                vlc_strerror_c(errno));
+    else
+        msg_Dbg(libvlc, "%u frame trace events written to %s (%u dropped)",
+                count, trace->path, end - count);
+}
+
+void vlc_FrameTraceDeinit(libvlc_int_t *libvlc)
+{
+    libvlc_priv_t *priv = libvlc_priv(libvlc);
+    vlc_frame_trace_t *trace = priv->frame_trace;
+
+    if (trace == NULL)
+        return;
+
+    priv->frame_trace = NULL;
+    vlc_FrameTraceDump(libvlc, trace);
+    free(trace->path);
+    free(trace);
+}
@@ -41,13 +41,16 @@ static_assert ((POOL_MAX & (POOL_MAX - 1)) == 0, "Not a power of two");
 struct picture_pool_t {
     int       (*pic_lock)(picture_t *);
     void      (*pic_unlock)(picture_t *);
-    vlc_mutex_t lock;
+    vlc_mutex_t lock; /* only to sleep in picture_pool_Wait() */
     vlc_cond_t  wait;
 
-    bool               canceled;
-    unsigned long long available;
+    atomic_bool        canceled;
+    atomic_ullong      available;
+    atomic_uint        waiters;
     atomic_ushort      refs;
     unsigned short     picture_count;
+    atomic_ushort      picture_allocated;
+    video_format_t     format; /* of the pictures allocated on first use */
     picture_t  *picture[];
 };
 
@@ -56,6 +59,7 @@ static void picture_pool_Destroy(picture_pool_t *pool)
     if (atomic_fetch_sub(&pool->refs, 1) != 1)
         return;
 
+    video_format_Clean(&pool->format);
     vlc_cond_destroy(&pool->wait);
     vlc_mutex_destroy(&pool->lock);
     aligned_free(pool);
@@ -64,10 +68,45 @@ static void picture_pool_Destroy(picture_pool_t *pool)
 void picture_pool_Release(picture_pool_t *pool)
 {
     for (unsigned i = 0; i < pool->picture_count; i++)
-        picture_Release(pool->picture[i]);
+        if (pool->picture[i] != NULL)
+            picture_Release(pool->picture[i]);
     picture_pool_Destroy(pool);
 }
 
+/** Takes the first available slot that is not in the skip mask */
+static int picture_pool_TakeSlot(picture_pool_t *pool,
+                                 unsigned long long skip)
+{
+    unsigned long long available = atomic_load(&pool->available);
+
+    while (available & ~skip)
+    {
+        unsigned offset = ffsll(available & ~skip) - 1;
+
+        if (atomic_compare_exchange_weak(&pool->available, &available,
+                                         available & ~(1ULL << offset)))
+            return offset;
+    }
+    return -1;
+}
+
+/** Gives a slot back, waking up picture_pool_Wait() only if it sleeps */
+static void picture_pool_PutSlot(picture_pool_t *pool, unsigned offset)
+{
+    unsigned long long old = atomic_fetch_or(&pool->available,
+                                             1ULL << offset);
+    assert(!(old & (1ULL << offset)));
+    (void) old;
+
+    /* Sequentially consistent, paired with picture_pool_Wait() */
+    if (atomic_load(&pool->waiters) > 0)
+    {
+        vlc_mutex_lock(&pool->lock);
+        vlc_cond_signal(&pool->wait);
+        vlc_mutex_unlock(&pool->lock);
+    }
+}
+
 static void picture_pool_ReleasePicture(picture_t *clone)
 {
     picture_priv_t *priv = (picture_priv_t *)clone;
@@ -82,15 +121,27 @@ static void picture_pool_ReleasePicture(picture_t *clone)
         pool->pic_unlock(picture);
     picture_Release(picture);
 
-    vlc_mutex_lock(&pool->lock);
-    assert(!(pool->available & (1ULL << offset)));
-    pool->available |= 1ULL << offset;
-    vlc_cond_signal(&pool->wait);
-    vlc_mutex_unlock(&pool->lock);
-
+    picture_pool_PutSlot(pool, offset);
     picture_pool_Destroy(pool);
 }
 
+/** Gets the pooled picture of a slot owned by the caller, allocating it on
+ * first use for pools created by picture_pool_NewFromFormat() */
+static picture_t *picture_pool_GetPicture(picture_pool_t *pool,
+                                          unsigned offset)
+{
+    picture_t *picture = pool->picture[offset];
+    if (picture != NULL)
+        return picture;
+
+    picture = picture_NewFromFormat(&pool->format);
+    if (unlikely(picture == NULL))
+        return NULL;
+    pool->picture[offset] = picture;
+    atomic_fetch_add(&pool->picture_allocated, 1);
+    return picture;
+}
+
 static picture_t *picture_pool_ClonePicture(picture_pool_t *pool,
                                             unsigned offset)
 {
@@ -133,14 +184,21 @@ picture_pool_t *picture_pool_NewExtended(const picture_pool_configuration_t *cfg
     vlc_mutex_init(&pool->lock);
     vlc_cond_init(&pool->wait);
     if (cfg->picture_count == POOL_MAX)
-        pool->available = ~0ULL;
+        atomic_init(&pool->available, ~0ULL);
     else
-        pool->available = (1ULL << cfg->picture_count) - 1;
+        atomic_init(&pool->available, (1ULL << cfg->picture_count) - 1);
+    atomic_init(&pool->waiters, 0);
     atomic_init(&pool->refs,  1);
     pool->picture_count = cfg->picture_count;
-    memcpy(pool->picture, cfg->picture,
-           cfg->picture_count * sizeof (picture_t *));
-    pool->canceled = false;
+    atomic_init(&pool->picture_allocated, cfg->picture_count);
+    video_format_Init(&pool->format, 0);
+    if (cfg->picture != NULL)
+        memcpy(pool->picture, cfg->picture,
+               cfg->picture_count * sizeof (picture_t *));
+    else
+        for (unsigned i = 0; i < cfg->picture_count; i++)
+            pool->picture[i] = NULL;
+    atomic_init(&pool->canceled, false);
     return pool;
 }
 
@@ -157,25 +215,29 @@ picture_pool_t *picture_pool_New(unsigned count, picture_t *const *tab)
 picture_pool_t *picture_pool_NewFromFormat(const video_format_t *fmt,
                                            unsigned count)
 {
-    picture_t *picture[count ? count : 1];
-    unsigned i;
+    /* Check the format once, the pictures are allocated on first use */
+    picture_t *first = picture_NewFromFormat(fmt);
+    if (first == NULL)
+        return NULL;
 
-    for (i = 0; i < count; i++) {
-        picture[i] = picture_NewFromFormat(fmt);
-        if (picture[i] == NULL)
-            goto error;
+    picture_pool_configuration_t cfg = {
+        .picture_count = count,
+    };
+    picture_pool_t *pool = picture_pool_NewExtended(&cfg);
+    if (pool == NULL ||
+        video_format_Copy(&pool->format, fmt) != VLC_SUCCESS) {
+        if (pool != NULL)
+            picture_pool_Release(pool);
+        picture_Release(first);
+        return NULL;
     }
 
-    picture_pool_t *pool = picture_pool_New(count, picture);
-    if (!pool)
-        goto error;
-
+    if (count > 0)
+        pool->picture[0] = first;
+    else
+        picture_Release(first);
+    atomic_init(&pool->picture_allocated, count > 0);
     return pool;
-
-error:
-    while (i > 0)
-        picture_Release(picture[--i]);
-    return NULL;
 }
 
 picture_pool_t *picture_pool_Reserve(picture_pool_t *master, unsigned count)
@@ -201,125 +263,139 @@ error:
     return NULL;
 }
 
-/** Find next (bit) set */
-static int fnsll(unsigned long long x, unsigned i)
+/** Gets a clone of the pooled picture of a slot taken by the caller */
+static picture_t *picture_pool_GetClone(picture_pool_t *pool, unsigned offset)
 {
-    if (i >= CHAR_BIT * sizeof (x))
-        return 0;
-    return ffsll(x & ~((1ULL << i) - 1));
+    picture_t *clone = picture_pool_ClonePicture(pool, offset);
+    if (clone != NULL) {
+        assert(clone->p_next == NULL);
+        atomic_fetch_add(&pool->refs, 1);
+    }
+    return clone;
 }
 
 picture_t *picture_pool_Get(picture_pool_t *pool)
 {
-    vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
+    unsigned long long skip = 0;
+    int i;
 
-    if (pool->canceled)
-    {
-        vlc_mutex_unlock(&pool->lock);
+    assert(atomic_load(&pool->refs) > 0);
+
+    if (atomic_load(&pool->canceled))
         return NULL;
-    }
 
-    for (unsigned i = ffsll(pool->available); i; i = fnsll(pool->available, i))
+    while ((i = picture_pool_TakeSlot(pool, skip)) >= 0)
     {
-        pool->available &= ~(1ULL << (i - 1));
-        vlc_mutex_unlock(&pool->lock);
-
-        picture_t *picture = pool->picture[i - 1];
+        picture_t *picture = picture_pool_GetPicture(pool, i);
+        if (unlikely(picture == NULL)) {
+            picture_pool_PutSlot(pool, i);
+            break;
+        }
 
         if (pool->pic_lock != NULL && pool->pic_lock(picture) != VLC_SUCCESS) {
-            vlc_mutex_lock(&pool->lock);
-            pool->available |= 1ULL << (i - 1);
+            picture_pool_PutSlot(pool, i);
+            skip |= 1ULL << i;
             continue;
         }
 
-        picture_t *clone = picture_pool_ClonePicture(pool, i - 1);
-        if (clone != NULL) {
-            assert(clone->p_next == NULL);
-            atomic_fetch_add(&pool->refs, 1);
-        }
-        return clone;
+        return picture_pool_GetClone(pool, i);
     }
-
-    vlc_mutex_unlock(&pool->lock);
     return NULL;
 }
 
 picture_t *picture_pool_Wait(picture_pool_t *pool)
 {
-    unsigned i;
+    int i;
 
-    vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
+    assert(atomic_load(&pool->refs) > 0);
 
-    while (pool->available == 0)
+    i = picture_pool_TakeSlot(pool, 0);
+    if (i < 0)
     {
-        if (pool->canceled)
+        vlc_mutex_lock(&pool->lock);
+        atomic_fetch_add(&pool->waiters, 1);
+        while ((i = picture_pool_TakeSlot(pool, 0)) < 0)
         {
-            vlc_mutex_unlock(&pool->lock);
-            return NULL;
+            if (atomic_load(&pool->canceled))
+                break;
+            vlc_cond_wait(&pool->wait, &pool->lock);
         }
-        vlc_cond_wait(&pool->wait, &pool->lock);
-    }
+        atomic_fetch_sub(&pool->waiters, 1);
+        vlc_mutex_unlock(&pool->lock);
 
-    i = ffsll(pool->available);
-    assert(i > 0);
-    pool->available &= ~(1ULL << (i - 1));
-    vlc_mutex_unlock(&pool->lock);
+        if (i < 0)
+            return NULL;
+    }
 
-    picture_t *picture = pool->picture[i - 1];
+    picture_t *picture = picture_pool_GetPicture(pool, i);
 
-    if (pool->pic_lock != NULL && pool->pic_lock(picture) != VLC_SUCCESS) {
-        vlc_mutex_lock(&pool->lock);
-        pool->available |= 1ULL << (i - 1);
-        vlc_cond_signal(&pool->wait);
-        vlc_mutex_unlock(&pool->lock);
+    if (picture == NULL ||
+        (pool->pic_lock != NULL && pool->pic_lock(picture) != VLC_SUCCESS)) {
+        picture_pool_PutSlot(pool, i);
         return NULL;
     }
 
-    picture_t *clone = picture_pool_ClonePicture(pool, i - 1);
-    if (clone != NULL) {
-        assert(clone->p_next == NULL);
-        atomic_fetch_add(&pool->refs, 1);
-    }
-    return clone;
+    return picture_pool_GetClone(pool, i);
 }
 
 void picture_pool_Cancel(picture_pool_t *pool, bool canceled)
 {
     vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
+    assert(atomic_load(&pool->refs) > 0);
 
-    pool->canceled = canceled;
+    atomic_store(&pool->canceled, canceled);
     if (canceled)
         vlc_cond_broadcast(&pool->wait);
     vlc_mutex_unlock(&pool->lock);
 }
 
-bool picture_pool_OwnsPic(picture_pool_t *pool, picture_t *pic)
+/** Find the pooled picture a picture was (directly or not) cloned from */
+static picture_priv_t *picture_pool_FindPooled(picture_t *pic)
 {
     picture_priv_t *priv = (picture_priv_t *)pic;
 
     while (priv->gc.destroy != picture_pool_ReleasePicture) {
         pic = priv->gc.opaque;
+        if (pic == NULL)
+            return NULL; /* not allocated from a pool */
         priv = (picture_priv_t *)pic;
     }
+    return priv;
+}
+
+bool picture_pool_OwnsPic(picture_pool_t *pool, picture_t *pic)
+{
+    picture_priv_t *priv = picture_pool_FindPooled(pic);
+    if (priv == NULL)
+        return false;
 
     uintptr_t sys = (uintptr_t)priv->gc.opaque;
     picture_pool_t *picpool = (void *)(sys & ~(POOL_MAX - 1));
     return pool == picpool;
 }
 
+bool picture_pool_IsForeignPic(picture_t *pic)
+{
+    return picture_pool_FindPooled(pic) == NULL;
+}
+
 unsigned picture_pool_GetSize(const picture_pool_t *pool)
 {
     return pool->picture_count;
 }
 
+unsigned picture_pool_GetAllocated(picture_pool_t *pool)
+{
+    return atomic_load(&pool->picture_allocated);
+}
+
 void picture_pool_Enum(picture_pool_t *pool, void (*cb)(void *, picture_t *),
                        void *opaque)
 {
-    /* NOTE: So far, the pictures table cannot change after the pool is created
-     * so there is no need to lock the pool mutex here. */
+    /* NOTE: So far, the pictures table only changes when a picture of a pool
+     * created from a format is allocated on first use. Such pools are not
+     * enumerated, so there is no need to lock the pool mutex here. */
     for (unsigned i = 0; i < pool->picture_count; i++)
-        cb(opaque, pool->picture[i]);
+        if (pool->picture[i] != NULL)
+            cb(opaque, pool->picture[i]);
 }
@@ -0,0 +1,176 @@
+/*****************************************************************************
+ * block_fifo.c: Test and benchmark for block queues
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+
+#define BLOCKS 500000
+
+static block_t blocks[BLOCKS];
+
+static void DummyRelease(block_t *block)
+{
+    (void) block;
+}
+
+static void InitBlocks(void)
+{
+    for (unsigned i = 0; i < BLOCKS; i++)
+    {
+        block_Init(&blocks[i], NULL, i % 1500);
+        blocks[i].pf_release = DummyRelease;
+        blocks[i].i_dts = i;
+    }
+}
+
+static void *FifoProducer(void *data)
+{
+    block_fifo_t *fifo = data;
+
+    for (unsigned i = 0; i < BLOCKS; i++)
+        block_FifoPut(fifo, &blocks[i]);
+    return NULL;
+}
+
+static void *SpscProducer(void *data)
+{
+    block_spsc_t *q = data;
+
+    /* Queue a few chains too */
+    for (unsigned i = 0; i < BLOCKS; i += 4)
+    {
+        blocks[i].p_next = &blocks[i + 1];
+        blocks[i + 1].p_next = &blocks[i + 2];
+        block_SpscPut(q, &blocks[i]);
+        block_SpscPut(q, &blocks[i + 3]);
+    }
+    return NULL;
+}
+
+static void test_fifo(void)
+{
+    block_fifo_t *fifo = block_FifoNew();
+    vlc_thread_t th;
+
+    assert(fifo != NULL);
+    InitBlocks();
+
+    mtime_t start = mdate();
+    if (vlc_clone(&th, FifoProducer, fifo, VLC_THREAD_PRIORITY_LOW))
+        abort();
+
+    for (unsigned i = 0; i < BLOCKS; i++)
+    {
+        block_t *block = block_FifoGet(fifo);
+        assert(block == &blocks[i]);
+    }
+    vlc_join(th, NULL);
+    mtime_t end = mdate();
+
+    printf("block_fifo: %u blocks in %"PRId64" us\n", BLOCKS, end - start);
+    block_FifoRelease(fifo);
+}
+
+static void test_spsc(void)
+{
+    block_spsc_t *q = block_SpscNew();
+    vlc_thread_t th;
+
+    assert(q != NULL);
+    assert(block_SpscTryGet(q) == NULL);
+    InitBlocks();
+
+    mtime_t start = mdate();
+    if (vlc_clone(&th, SpscProducer, q, VLC_THREAD_PRIORITY_LOW))
+        abort();
+
+    for (unsigned i = 0; i < BLOCKS; i++)
+    {
+        block_t *block = block_SpscGet(q);
+        assert(block == &blocks[i]);
+        assert(block->p_next == NULL);
+    }
+    vlc_join(th, NULL);
+    mtime_t end = mdate();
+
+    printf("block_spsc: %u blocks in %"PRId64" us\n", BLOCKS, end - start);
+    assert(block_SpscCount(q) == 0);
+    assert(block_SpscSize(q) == 0);
+
+    /* Accounting */
+    InitBlocks();
+    size_t size = 0;
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        block_SpscPut(q, &blocks[i]);
+        size += blocks[i].i_buffer;
+    }
+    assert(block_SpscCount(q) == 1000);
+    assert(block_SpscSize(q) == size);
+    for (unsigned i = 0; i < 10; i++)
+    {
+        block_t *block = block_SpscTryGet(q);
+        assert(block == &blocks[i]);
+        size -= block->i_buffer;
+    }
+    assert(block_SpscCount(q) == 990);
+    assert(block_SpscSize(q) == size);
+    block_SpscRelease(q);
+}
+
+static void *SpscWaiter(void *data)
+{
+    block_spsc_t *q = data;
+
+    block_t *block = block_SpscGet(q);
+    (void) block;
+    assert(!"not reached");
+    return NULL;
+}
+
+static void test_spsc_cancel(void)
+{
+    block_spsc_t *q = block_SpscNew();
+    vlc_thread_t th;
+
+    assert(q != NULL);
+    if (vlc_clone(&th, SpscWaiter, q, VLC_THREAD_PRIORITY_LOW))
+        abort();
+    vlc_cancel(th);
+    vlc_join(th, NULL);
+    block_SpscRelease(q);
+}
+
+int main(void)
+{
+    test_fifo();
+    test_spsc();
+    test_spsc_cancel();
+    return 0;
+}
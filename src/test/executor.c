@@ -0,0 +1,237 @@
+/*****************************************************************************
+ * executor.c: Test and benchmark for the thread pool
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_executor.h>
+
+#define TASKS 100000
+
+struct latch
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    unsigned count;
+};
+
+static void latch_init(struct latch *l, unsigned count)
+{
+    vlc_mutex_init(&l->lock);
+    vlc_cond_init(&l->wait);
+    l->count = count;
+}
+
+static void latch_countdown(struct latch *l)
+{
+    vlc_mutex_lock(&l->lock);
+    assert(l->count > 0);
+    if (--l->count == 0)
+        vlc_cond_broadcast(&l->wait);
+    vlc_mutex_unlock(&l->lock);
+}
+
+static void latch_wait(struct latch *l)
+{
+    vlc_mutex_lock(&l->lock);
+    while (l->count > 0)
+        vlc_cond_wait(&l->wait, &l->lock);
+    vlc_mutex_unlock(&l->lock);
+    vlc_cond_destroy(&l->wait);
+    vlc_mutex_destroy(&l->lock);
+}
+
+struct task
+{
+    struct vlc_runnable runnable;
+    vlc_executor_t *executor;
+    struct latch *latch;
+    atomic_uint *runs;
+};
+
+static struct task tasks[TASKS];
+
+static void RunTask(void *data)
+{
+    struct task *t = data;
+
+    atomic_fetch_add(t->runs, 1);
+    latch_countdown(t->latch);
+}
+
+static void test_submit(unsigned threads)
+{
+    vlc_executor_t *ex = vlc_executor_New(threads);
+    struct latch latch;
+    atomic_uint runs = ATOMIC_VAR_INIT(0);
+
+    assert(ex != NULL);
+    latch_init(&latch, TASKS);
+
+    mtime_t start = mdate();
+    for (unsigned i = 0; i < TASKS; i++)
+    {
+        tasks[i].runnable.run = RunTask;
+        tasks[i].runnable.userdata = &tasks[i];
+        tasks[i].latch = &latch;
+        tasks[i].runs = &runs;
+        vlc_executor_Submit(ex, &tasks[i].runnable);
+    }
+    latch_wait(&latch);
+    mtime_t end = mdate();
+    assert(atomic_load(&runs) == TASKS);
+
+    struct vlc_executor_stats st;
+
+    vlc_executor_GetStats(ex, &st);
+    assert(st.threads >= 1 && st.threads <= threads);
+    assert(st.max_threads == threads);
+    assert(st.submitted == TASKS);
+    assert(st.canceled == 0);
+    printf("executor: %u tasks on %u/%u threads in %"PRId64" us "
+           "(%"PRIu64" stolen)\n", TASKS, st.threads, threads, end - start,
+           st.stolen);
+    vlc_executor_Delete(ex);
+}
+
+/* Binary tree of tasks, each submitting its children from a worker */
+static void RunTree(void *data)
+{
+    struct task *t = data;
+    size_t index = t - tasks;
+
+    atomic_fetch_add(t->runs, 1);
+    for (size_t i = 2 * index + 1; i <= 2 * index + 2 && i < TASKS; i++)
+    {
+        struct task *child = &tasks[i];
+
+        child->runnable.run = RunTree;
+        child->runnable.userdata = child;
+        child->executor = t->executor;
+        child->latch = t->latch;
+        child->runs = t->runs;
+        vlc_executor_Submit(t->executor, &child->runnable);
+    }
+    latch_countdown(t->latch);
+}
+
+static void test_nested(unsigned threads)
+{
+    vlc_executor_t *ex = vlc_executor_New(threads);
+    struct latch latch;
+    atomic_uint runs = ATOMIC_VAR_INIT(0);
+
+    assert(ex != NULL);
+    latch_init(&latch, TASKS);
+    tasks[0].runnable.run = RunTree;
+    tasks[0].runnable.userdata = &tasks[0];
+    tasks[0].executor = ex;
+    tasks[0].latch = &latch;
+    tasks[0].runs = &runs;
+    vlc_executor_Submit(ex, &tasks[0].runnable);
+    latch_wait(&latch);
+    assert(atomic_load(&runs) == TASKS);
+    vlc_executor_Delete(ex);
+}
+
+static void RunBlocking(void *data)
+{
+    struct latch *gate = data;
+
+    latch_wait(gate);
+}
+
+static void RunNever(void *data)
+{
+    (void) data;
+    assert(!"not reached");
+}
+
+static void test_cancel(void)
+{
+    vlc_executor_t *ex = vlc_executor_New(1);
+    struct latch gate;
+    struct vlc_runnable blocker = { .run = RunBlocking, .userdata = &gate };
+    struct vlc_runnable r[4];
+
+    assert(ex != NULL);
+    latch_init(&gate, 1);
+    /* Occupy the only worker, so that the next tasks remain queued */
+    vlc_executor_Submit(ex, &blocker);
+    for (unsigned i = 0; i < ARRAY_SIZE(r); i++)
+    {
+        r[i].run = RunNever;
+        r[i].userdata = NULL;
+        vlc_executor_Submit(ex, &r[i]);
+    }
+
+    assert(vlc_executor_Cancel(ex, &r[2]));
+    assert(vlc_executor_Cancel(ex, &r[0]));
+    assert(vlc_executor_Cancel(ex, &r[3]));
+    assert(vlc_executor_Cancel(ex, &r[1]));
+    assert(!vlc_executor_Cancel(ex, &r[1]));
+    latch_countdown(&gate);
+
+    struct vlc_executor_stats st;
+
+    vlc_executor_GetStats(ex, &st);
+    assert(st.canceled == ARRAY_SIZE(r));
+    vlc_executor_Delete(ex);
+}
+
+static void test_drain(void)
+{
+    vlc_executor_t *ex = vlc_executor_New(2);
+    struct latch latch;
+    atomic_uint runs = ATOMIC_VAR_INIT(0);
+
+    assert(ex != NULL);
+    latch_init(&latch, 1000);
+    for (unsigned i = 0; i < 1000; i++)
+    {
+        tasks[i].runnable.run = RunTask;
+        tasks[i].runnable.userdata = &tasks[i];
+        tasks[i].latch = &latch;
+        tasks[i].runs = &runs;
+        vlc_executor_Submit(ex, &tasks[i].runnable);
+    }
+    /* Deletion waits for the queued tasks */
+    vlc_executor_Delete(ex);
+    assert(atomic_load(&runs) == 1000);
+    latch_wait(&latch);
+}
+
+int main(void)
+{
+    test_submit(1);
+    test_submit(4);
+    test_nested(4);
+    test_cancel();
+    test_drain();
+    return 0;
+}
@@ -23,14 +23,20 @@
 #endif
 
 #include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
 #undef NDEBUG
 #include <assert.h>
 
 #include <vlc_common.h>
 #include <vlc_es.h>
 #include <vlc_picture_pool.h>
+#include <vlc_atomic.h>
 
 #define PICTURES 10
+#define THREADS 4
+#define HELD 3 /* THREADS * (HELD - 1) < PICTURES, so Wait cannot deadlock */
+#define ITERATIONS 100000
 
 static video_format_t fmt;
 static picture_pool_t *pool, *reserve;
@@ -41,10 +47,12 @@ static void test(bool zombie)
 
     pool = picture_pool_NewFromFormat(&fmt, PICTURES);
     assert(pool != NULL);
+    assert(picture_pool_GetAllocated(pool) <= 1);
 
     for (unsigned i = 0; i < PICTURES; i++) {
         pics[i] = picture_pool_Get(pool);
         assert(pics[i] != NULL);
+        assert(picture_pool_GetAllocated(pool) == i + 1);
     }
 
     for (unsigned i = 0; i < PICTURES; i++)
@@ -106,6 +114,103 @@ static void test(bool zombie)
             picture_Release(pics[i]);
 }
 
+static atomic_uint outstanding;
+
+static void *StressThread(void *data)
+{
+    uint8_t id = (uintptr_t)data;
+    picture_t *pics[HELD];
+
+    for (unsigned i = 0; i < ITERATIONS; i++) {
+        unsigned count = 1 + (i % HELD);
+
+        for (unsigned j = 0; j < count; j++) {
+            pics[j] = (i & 1) ? picture_pool_Get(pool)
+                              : picture_pool_Wait(pool);
+            if (pics[j] == NULL) {
+                assert(i & 1);
+                count = j;
+                break;
+            }
+            assert(atomic_fetch_add(&outstanding, 1) < PICTURES);
+            pics[j]->p[0].p_pixels[0] = id;
+        }
+
+        /* Nobody else may own the same picture meanwhile */
+        for (unsigned j = 0; j < count; j++) {
+            assert(pics[j]->p[0].p_pixels[0] == id);
+            atomic_fetch_sub(&outstanding, 1);
+            picture_Release(pics[j]);
+        }
+    }
+    return NULL;
+}
+
+static void test_stress(void)
+{
+    vlc_thread_t th[THREADS];
+
+    pool = picture_pool_NewFromFormat(&fmt, PICTURES);
+    assert(pool != NULL);
+    atomic_init(&outstanding, 0);
+
+    mtime_t start = mdate();
+    for (unsigned i = 0; i < THREADS; i++)
+        if (vlc_clone(&th[i], StressThread, (void *)(uintptr_t)(i + 1),
+                      VLC_THREAD_PRIORITY_LOW))
+            abort();
+    for (unsigned i = 0; i < THREADS; i++)
+        vlc_join(th[i], NULL);
+    mtime_t end = mdate();
+
+    assert(atomic_load(&outstanding) == 0);
+    assert(picture_pool_GetAllocated(pool) <= PICTURES);
+    printf("%u threads: %u iterations in %"PRId64" us\n", THREADS,
+           THREADS * ITERATIONS, end - start);
+
+    /* All pictures must be back */
+    picture_t *pics[PICTURES];
+    for (unsigned i = 0; i < PICTURES; i++) {
+        pics[i] = picture_pool_Get(pool);
+        assert(pics[i] != NULL);
+    }
+    for (unsigned i = 0; i < PICTURES; i++)
+        picture_Release(pics[i]);
+    picture_pool_Release(pool);
+}
+
+static void *WaitThread(void *data)
+{
+    return picture_pool_Wait(data);
+}
+
+static void test_wait(void)
+{
+    picture_t *pics[PICTURES];
+    vlc_thread_t th;
+    void *ret;
+
+    pool = picture_pool_NewFromFormat(&fmt, PICTURES);
+    assert(pool != NULL);
+
+    for (unsigned i = 0; i < PICTURES; i++) {
+        pics[i] = picture_pool_Get(pool);
+        assert(pics[i] != NULL);
+    }
+
+    /* A released picture wakes the waiter up */
+    if (vlc_clone(&th, WaitThread, pool, VLC_THREAD_PRIORITY_LOW))
+        abort();
+    picture_Release(pics[0]);
+    vlc_join(th, &ret);
+    assert(ret != NULL);
+    pics[0] = ret;
+
+    for (unsigned i = 0; i < PICTURES; i++)
+        picture_Release(pics[i]);
+    picture_pool_Release(pool);
+}
+
 int main(void)
 {
     video_format_Setup(&fmt, VLC_CODEC_I420, 320, 200, 320, 200, 1, 1);
@@ -122,6 +227,8 @@ int main(void)
 
     test(false);
     test(true);
+    test_stress();
+    test_wait();
 
     return 0;
 }
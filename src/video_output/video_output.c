@@ -145,6 +145,7 @@ static vout_thread_t *VoutCreate(vlc_object_t *object,
     /* Initialize locks */
     vlc_mutex_init(&vout->p->filter.lock);
     vlc_mutex_init(&vout->p->spu_lock);
+    vlc_mutex_init(&vout->p->trace.lock);
 
     /* Take care of some "interface/control" related initialisations */
     vout_IntfInit(vout);
@@ -291,6 +292,7 @@ static void VoutDestructor(vlc_object_t *object)
     free(vout->p->splitter_name);
 
     /* Destroy the locks */
+    vlc_mutex_destroy(&vout->p->trace.lock);
     vlc_mutex_destroy(&vout->p->spu_lock);
     vlc_mutex_destroy(&vout->p->filter.lock);
     vout_control_Clean(&vout->p->control);
@@ -343,6 +345,17 @@ bool vout_IsEmpty(vout_thread_t *vout)
     return !picture;
 }
 
+void vout_FrameTraceQueue(vout_thread_t *vout, int es_id, mtime_t date,
+                          mtime_t ts)
+{
+    vlc_mutex_lock(&vout->p->trace.lock);
+    unsigned i = vout->p->trace.next++ % VOUT_TRACE_FRAMES;
+    vout->p->trace.frames[i].date = date;
+    vout->p->trace.frames[i].ts = ts;
+    vout->p->trace.frames[i].es_id = es_id;
+    vlc_mutex_unlock(&vout->p->trace.lock);
+}
+
 void vout_NextPicture(vout_thread_t *vout, mtime_t *duration)
 {
     vout_control_cmd_t cmd;
@@ -417,7 +430,9 @@ picture_t *vout_GetPicture(vout_thread_t *vout)
 /**
  * It gives to the vout a picture to be displayed.
  *
- * The given picture MUST comes from vout_GetPicture.
+ * The given picture MUST comes from vout_GetPicture, or be a picture
+ * allocated outside of any pool (see picture_pool_IsForeignPic()) with the
+ * format of the video output.
  *
  * Becareful, after vout_PutPicture is called, picture_t::p_next cannot be
  * read/used.
@@ -425,7 +440,8 @@ picture_t *vout_GetPicture(vout_thread_t *vout)
 void vout_PutPicture(vout_thread_t *vout, picture_t *picture)
 {
     picture->p_next = NULL;
-    if (picture_pool_OwnsPic(vout->p->decoder_pool, picture))
+    if (picture_pool_OwnsPic(vout->p->decoder_pool, picture)
+     || picture_pool_IsForeignPic(picture))
     {
         picture_fifo_Push(vout->p->decoder_fifo, picture);
 
@@ -964,6 +980,35 @@ static picture_t *ConvertRGB32AndBlend(vout_thread_t *vout, picture_t *pic,
     return NULL;
 }
 
+/* Records a frame trace event with the ES and the stream timestamp of the
+ * picture, as the earlier stages do. The pictures created by the filters,
+ * such as the second field of a deinterlaced one, are timed from the last
+ * queued picture before them. */
+static void ThreadFrameTrace(vout_thread_t *vout,
+                             enum vlc_frame_trace_stage stage, mtime_t date)
+{
+    vlc_frame_trace_t *trace = libvlc_priv(vout->obj.libvlc)->frame_trace;
+    if (likely(trace == NULL))
+        return;
+
+    int es_id = -1;
+    mtime_t ts = VLC_TS_INVALID, from = VLC_TS_INVALID;
+
+    vlc_mutex_lock(&vout->p->trace.lock);
+    for (unsigned i = 0; i < VOUT_TRACE_FRAMES; i++) {
+        const mtime_t queued = vout->p->trace.frames[i].date;
+
+        if (queued > from && queued <= date) {
+            from = queued;
+            ts = vout->p->trace.frames[i].ts + (date - queued);
+            es_id = vout->p->trace.frames[i].es_id;
+        }
+    }
+    vlc_mutex_unlock(&vout->p->trace.lock);
+
+    vlc_FrameTraceRecord(trace, stage, VIDEO_ES, es_id, ts);
+}
+
 static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
 {
     vout_thread_sys_t *sys = vout->p;
@@ -1098,7 +1143,8 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
     }
 
     assert(vout_IsDisplayFiltered(vd) == !sys->display.use_dr);
-    if (sys->display.use_dr && !is_direct) {
+    if (sys->display.use_dr &&
+        (!is_direct || picture_pool_IsForeignPic(todisplay))) {
         picture_t *direct = NULL;
         if (likely(vout->p->display_pool != NULL))
             direct = picture_pool_Get(vout->p->display_pool);
@@ -1111,8 +1157,12 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
 
         /* The display uses direct rendering (no conversion), but its pool of
          * pictures is not usable by the decoder (too few, too slow or
-         * subject to invalidation...). Since there are no filters, copying
-         * pictures from the decoder to the output is unavoidable. */
+         * subject to invalidation...), or the decoder exported its own
+         * buffers. Since there are no filters, copying pictures from the
+         * decoder to the output is unavoidable. The copy of the exported
+         * buffers only moves from the decoder to the video output thread. */
+        if (picture_pool_IsForeignPic(todisplay))
+            sys->display.foreign_copied++;
         VideoFormatCopyCropAr(&direct->format, &todisplay->format);
         picture_Copy(direct, todisplay);
         picture_Release(todisplay);
@@ -1155,6 +1205,7 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
     }
 
     vout_chrono_Stop(&vout->p->render);
+    ThreadFrameTrace(vout, VLC_FRAME_TRACE_VOUT_RENDER, todisplay->date);
 #if 0
         {
         static int i = 0;
@@ -1175,6 +1226,7 @@ static int ThreadDisplayRenderPicture(vout_thread_t *vout, bool is_forced)
 
     /* Display the direct buffer returned by vout_RenderPicture */
     vout->p->displayed.date = mdate();
+    ThreadFrameTrace(vout, VLC_FRAME_TRACE_VOUT_DISPLAY, todisplay->date);
     vout_display_Display(vd, todisplay, subpic);
 
     vout_statistic_AddDisplayed(&vout->p->statistic, 1);
@@ -1493,6 +1545,7 @@ static int ThreadStart(vout_thread_t *vout, vout_display_state_t *state)
     vout->p->decoder_pool = NULL;
     vout->p->display_pool = NULL;
     vout->p->private_pool = NULL;
+    vout->p->display.foreign_copied = 0;
 
     vout->p->filter.configuration = NULL;
     video_format_Copy(&vout->p->filter.format, &vout->p->original);
@@ -1568,6 +1621,10 @@ error:
 
 static void ThreadStop(vout_thread_t *vout, vout_display_state_t *state)
 {
+    if (vout->p->display.foreign_copied > 0)
+        msg_Dbg(vout, "%u pictures exported by the decoder copied to the "
+                "display", vout->p->display.foreign_copied);
+
     if (vout->p->spu_blend)
         filter_DeleteBlend(vout->p->spu_blend);
 
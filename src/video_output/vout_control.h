@@ -74,4 +74,11 @@ void vout_WindowMouseEvent( vout_thread_t *p_vout,
  */
 bool vout_IsEmpty( vout_thread_t *p_vout );
 
+/**
+ * This function will remember the ES and the stream timestamp of a picture
+ * about to be queued with the given display date, for the frame trace.
+ */
+void vout_FrameTraceQueue( vout_thread_t *p_vout, int i_es_id,
+                           mtime_t i_date, mtime_t i_ts );
+
 #endif
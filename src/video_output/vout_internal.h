@@ -35,6 +35,9 @@
 #include "statistic.h"
 #include "chrono.h"
 
+/* Number of queued pictures remembered for the frame trace */
+#define VOUT_TRACE_FRAMES 64
+
 /* It should be high enough to absorbe jitter due to difficult picture(s)
  * to decode but not too high as memory is not that cheap.
  *
@@ -81,6 +84,7 @@ struct vout_thread_sys_t
         char           *title;
         vout_display_t *vd;
         bool           use_dr;
+        unsigned       foreign_copied; /* foreign pictures copied to vd */
     } display;
 
     struct {
@@ -136,6 +140,17 @@ struct vout_thread_sys_t
     picture_pool_t  *decoder_pool;
     picture_fifo_t  *decoder_fifo;
     vout_chrono_t   render;           /**< picture render time estimator */
+
+    /* Frame timing trace, only used if enabled */
+    struct {
+        vlc_mutex_t lock;
+        unsigned    next;
+        struct {
+            mtime_t date;   /**< display date, 0 if unused */
+            mtime_t ts;     /**< stream timestamp */
+            int     es_id;
+        } frames[VOUT_TRACE_FRAMES];
+    } trace;
 };
 
 /* TODO to move them to vlc_vout.h */
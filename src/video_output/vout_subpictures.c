@@ -61,11 +61,38 @@ typedef struct {
     spu_heap_entry_t entry[VOUT_MAX_SUBPICTURES];
 } spu_heap_t;
 
+/* Cache of the converted/scaled pictures of the last rendered regions */
+#define SPU_CACHE_SIZE     8
+#define SPU_CACHE_MAX_SIZE (32 << 20)
+
+typedef struct {
+    picture_t      *picture;           /**< scaled picture, NULL if unused */
+    uint64_t       hash;                         /**< hash of the source */
+    uint8_t        *pixels;                      /**< copy of the source */
+    size_t         size;                        /**< size of the entry */
+    video_format_t fmt;                        /**< source region format */
+    video_format_t picture_fmt;               /**< source picture format */
+    unsigned       width;                           /**< scaled width */
+    unsigned       height;                         /**< scaled height */
+    vlc_fourcc_t   chroma;                       /**< conversion chroma */
+    bool           convert;                 /**< conversion was required */
+    uint64_t       date;                             /**< last use date */
+} spu_cache_entry_t;
+
+typedef struct {
+    spu_cache_entry_t entry[SPU_CACHE_SIZE];
+    size_t            size;
+    uint64_t          date;
+    unsigned          hits;
+    unsigned          misses;
+} spu_cache_t;
+
 struct spu_private_t {
     vlc_mutex_t  lock;            /* lock to protect all followings fields */
     vlc_object_t *input;
 
     spu_heap_t   heap;
+    spu_cache_t  cache;
 
     int channel;             /**< number of subpicture channels registered */
     filter_t *text;                              /**< text renderer module */
@@ -159,6 +186,235 @@ static void SpuHeapClean(spu_heap_t *heap)
     }
 }
 
+/*****************************************************************************
+ * region cache management
+ *
+ * A subtitle often keeps the same content for seconds while its regions are
+ * recreated (updaters, karaoke re-rendering, ...), so the converted/scaled
+ * pictures are kept keyed on the source pixels rather than on the region.
+ *****************************************************************************/
+static void SpuCacheInit(spu_cache_t *cache)
+{
+    memset(cache, 0, sizeof(*cache));
+}
+
+static void SpuCacheDeleteAt(spu_cache_t *cache, int index)
+{
+    spu_cache_entry_t *e = &cache->entry[index];
+
+    if (!e->picture)
+        return;
+
+    picture_Release(e->picture);
+    free(e->pixels);
+    video_format_Clean(&e->fmt);
+    cache->size -= e->size;
+
+    e->picture = NULL;
+}
+
+static void SpuCacheClean(spu_cache_t *cache)
+{
+    for (int i = 0; i < SPU_CACHE_SIZE; i++)
+        SpuCacheDeleteAt(cache, i);
+}
+
+/* Size of the rows of each plane that hold the coded pixels */
+static bool SpuCacheExtent(const picture_t *picture,
+                           size_t pitch[PICTURE_PLANE_MAX],
+                           int lines[PICTURE_PLANE_MAX])
+{
+    const video_format_t *fmt = &picture->format;
+    const vlc_chroma_description_t *dsc =
+        vlc_fourcc_GetChromaDescription(fmt->i_chroma);
+
+    if (!dsc || dsc->plane_count != (unsigned)picture->i_planes)
+        return false;
+
+    for (int i = 0; i < picture->i_planes; i++) {
+        const plane_t *p = &picture->p[i];
+
+        pitch[i] = (fmt->i_width + dsc->p[i].w.den - 1) / dsc->p[i].w.den
+                 * dsc->p[i].w.num * dsc->pixel_size;
+        lines[i] = (fmt->i_height + dsc->p[i].h.den - 1) / dsc->p[i].h.den
+                 * dsc->p[i].h.num;
+        pitch[i] = __MIN(pitch[i], (size_t)p->i_pitch);
+        lines[i] = __MIN(lines[i], p->i_lines);
+    }
+    return true;
+}
+
+static uint64_t SpuCacheHash(const picture_t *picture,
+                             const size_t pitch[], const int lines[])
+{
+    const uint64_t k = UINT64_C(0x9E3779B97F4A7C15);
+    uint64_t h = 0;
+
+    for (int i = 0; i < picture->i_planes; i++) {
+        for (int y = 0; y < lines[i]; y++) {
+            const uint8_t *row = &picture->p[i].p_pixels[y * picture->p[i].i_pitch];
+            size_t x = 0;
+
+            for (; x + 8 <= pitch[i]; x += 8) {
+                uint64_t v;
+
+                memcpy(&v, &row[x], sizeof(v));
+                h = ((h << 5 | h >> 59) ^ v) * k;
+            }
+            for (; x < pitch[i]; x++)
+                h = ((h << 5 | h >> 59) ^ row[x]) * k;
+        }
+    }
+    return h;
+}
+
+static bool SpuCacheIsSameFormat(const video_format_t *a,
+                                 const video_format_t *b)
+{
+    if (!video_format_IsSimilar(a, b) ||
+        a->primaries != b->primaries || a->transfer != b->transfer ||
+        a->space != b->space || a->b_color_range_full != b->b_color_range_full)
+        return false;
+
+    if (a->i_chroma != VLC_CODEC_YUVP)
+        return true;
+    if (!a->p_palette || !b->p_palette)
+        return a->p_palette == b->p_palette;
+    return a->p_palette->i_entries == b->p_palette->i_entries &&
+           !memcmp(a->p_palette->palette, b->p_palette->palette,
+                   sizeof(a->p_palette->palette[0]) * a->p_palette->i_entries);
+}
+
+static bool SpuCacheIsSameContent(const spu_cache_entry_t *e,
+                                  const picture_t *picture,
+                                  const size_t pitch[], const int lines[])
+{
+    const uint8_t *pixels = e->pixels;
+
+    for (int i = 0; i < picture->i_planes; i++) {
+        for (int y = 0; y < lines[i]; y++) {
+            if (memcmp(pixels, &picture->p[i].p_pixels[y * picture->p[i].i_pitch],
+                       pitch[i]))
+                return false;
+            pixels += pitch[i];
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns a held reference to the cached scaled picture of a region, or NULL.
+ *
+ * The hash of the region pixels is returned for SpuCachePut(), 0 if the
+ * region cannot be cached.
+ */
+static picture_t *SpuCacheGet(spu_cache_t *cache,
+                              const subpicture_region_t *region,
+                              unsigned width, unsigned height,
+                              vlc_fourcc_t chroma, bool convert,
+                              uint64_t *hash)
+{
+    const picture_t *picture = region->p_picture;
+    size_t pitch[PICTURE_PLANE_MAX];
+    int lines[PICTURE_PLANE_MAX];
+
+    *hash = 0;
+    if (!SpuCacheExtent(picture, pitch, lines))
+        return NULL;
+    *hash = SpuCacheHash(picture, pitch, lines) | 1;
+
+    for (int i = 0; i < SPU_CACHE_SIZE; i++) {
+        spu_cache_entry_t *e = &cache->entry[i];
+
+        if (!e->picture || e->hash != *hash ||
+            e->width != width || e->height != height ||
+            e->chroma != chroma || e->convert != convert ||
+            !SpuCacheIsSameFormat(&e->fmt, &region->fmt) ||
+            !video_format_IsSimilar(&e->picture_fmt, &picture->format) ||
+            !SpuCacheIsSameContent(e, picture, pitch, lines))
+            continue;
+
+        e->date = ++cache->date;
+        cache->hits++;
+        return picture_Hold(e->picture);
+    }
+    cache->misses++;
+    return NULL;
+}
+
+/**
+ * Stores the scaled picture of a region, evicting the least recently used
+ * entries if needed.
+ */
+static void SpuCachePut(spu_cache_t *cache, const subpicture_region_t *region,
+                        picture_t *scaled, unsigned width, unsigned height,
+                        vlc_fourcc_t chroma, bool convert, uint64_t hash)
+{
+    const picture_t *picture = region->p_picture;
+    size_t pitch[PICTURE_PLANE_MAX];
+    int lines[PICTURE_PLANE_MAX];
+
+    if (hash == 0 || !SpuCacheExtent(picture, pitch, lines))
+        return;
+
+    size_t source_size = 0;
+    for (int i = 0; i < picture->i_planes; i++)
+        source_size += pitch[i] * lines[i];
+
+    size_t size = source_size;
+    for (int i = 0; i < scaled->i_planes; i++)
+        size += (size_t)scaled->p[i].i_pitch * scaled->p[i].i_lines;
+    if (size > SPU_CACHE_MAX_SIZE)
+        return;
+
+    /* Evict until the entry fits */
+    for (;;) {
+        int oldest = -1;
+        int free_index = -1;
+
+        for (int i = 0; i < SPU_CACHE_SIZE; i++) {
+            const spu_cache_entry_t *e = &cache->entry[i];
+
+            if (!e->picture)
+                free_index = i;
+            else if (oldest < 0 || e->date < cache->entry[oldest].date)
+                oldest = i;
+        }
+
+        if (free_index >= 0 && cache->size + size <= SPU_CACHE_MAX_SIZE) {
+            spu_cache_entry_t *e = &cache->entry[free_index];
+
+            e->pixels = malloc(source_size);
+            if (!e->pixels)
+                return;
+
+            uint8_t *pixels = e->pixels;
+            for (int i = 0; i < picture->i_planes; i++)
+                for (int y = 0; y < lines[i]; y++) {
+                    memcpy(pixels, &picture->p[i].p_pixels[y * picture->p[i].i_pitch],
+                           pitch[i]);
+                    pixels += pitch[i];
+                }
+
+            video_format_Copy(&e->fmt, &region->fmt);
+            e->picture_fmt = picture->format;
+            e->picture_fmt.p_palette = NULL;
+            e->picture = picture_Hold(scaled);
+            e->hash    = hash;
+            e->size    = size;
+            e->width   = width;
+            e->height  = height;
+            e->chroma  = chroma;
+            e->convert = convert;
+            e->date    = ++cache->date;
+            cache->size += size;
+            return;
+        }
+        assert(oldest >= 0);
+        SpuCacheDeleteAt(cache, oldest);
+    }
+}
+
 static void FilterRelease(filter_t *filter)
 {
     if (filter->p_module)
@@ -840,12 +1096,18 @@ static void SpuRenderRegion(spu_t *spu,
         /* Scale if needed into cache */
         if (!region->p_private && dst_width > 0 && dst_height > 0) {
             filter_t *scale = sys->scale;
+            uint64_t hash;
 
-            picture_t *picture = region->p_picture;
-            picture_Hold(picture);
+            picture_t *picture = SpuCacheGet(&sys->cache, region,
+                                             dst_width, dst_height,
+                                             chroma_list[0], convert_chroma,
+                                             &hash);
+            const bool cached = picture != NULL;
+            if (!cached)
+                picture = picture_Hold(region->p_picture);
 
             /* Convert YUVP to YUVA/RGBA first for better scaling quality */
-            if (using_palette) {
+            if (!cached && using_palette) {
                 filter_t *scale_yuvp = sys->scale_yuvp;
 
                 scale_yuvp->fmt_in.video = region->fmt;
@@ -863,7 +1125,7 @@ static void SpuRenderRegion(spu_t *spu,
             }
 
             /* Conversion(except from YUVP)/Scaling */
-            if (picture &&
+            if (!cached && picture &&
                 (picture->format.i_visible_width  != dst_width ||
                  picture->format.i_visible_height != dst_height ||
                  (convert_chroma && !using_palette)))
@@ -889,6 +1151,11 @@ static void SpuRenderRegion(spu_t *spu,
                     msg_Err(spu, "scaling failed");
             }
 
+            if (!cached && picture && picture != region->p_picture)
+                SpuCachePut(&sys->cache, region, picture,
+                            dst_width, dst_height,
+                            chroma_list[0], convert_chroma, hash);
+
             /* */
             if (picture) {
                 region->p_private = subpicture_region_private_New(&picture->format);
@@ -961,14 +1228,14 @@ static void SpuRenderRegion(spu_t *spu,
         }
     }
 
-    subpicture_region_t *dst = *dst_ptr = subpicture_region_New(&region_fmt);
+    /* The output region shares the (cached) picture instead of allocating
+     * a new one for every rendered frame */
+    subpicture_region_t *dst = *dst_ptr =
+        subpicture_region_NewFromPicture(&region_fmt, region_picture);
     if (dst) {
         dst->i_x       = x_offset;
         dst->i_y       = y_offset;
         dst->i_align   = 0;
-        if (dst->p_picture)
-            picture_Release(dst->p_picture);
-        dst->p_picture = picture_Hold(region_picture);
         int fade_alpha = 255;
         if (subpic->b_fade) {
             mtime_t fade_start = subpic->i_start + 3 * (subpic->i_stop - subpic->i_start) / 4;
@@ -1306,6 +1573,7 @@ spu_t *spu_Create(vlc_object_t *object, vout_thread_t *vout)
     vlc_mutex_init(&sys->lock);
 
     SpuHeapInit(&sys->heap);
+    SpuCacheInit(&sys->cache);
 
     sys->text = NULL;
     sys->scale = NULL;
@@ -1380,6 +1648,11 @@ void spu_Destroy(spu_t *spu)
     /* Destroy all remaining subpictures */
     SpuHeapClean(&sys->heap);
 
+    if (sys->cache.hits + sys->cache.misses > 0)
+        msg_Dbg(spu, "region cache: %u hits, %u misses",
+                sys->cache.hits, sys->cache.misses);
+    SpuCacheClean(&sys->cache);
+
     vlc_mutex_destroy(&sys->lock);
 
     vlc_object_release(spu);
@@ -103,6 +103,20 @@ void vout_CloseWrapper(vout_thread_t *vout, vout_display_state_t *state)
 /*****************************************************************************
  *
  *****************************************************************************/
+/* Approximate size of a picture, without the alignment and margins */
+static size_t PictureSize(const video_format_t *fmt)
+{
+    const vlc_chroma_description_t *dsc =
+        vlc_fourcc_GetChromaDescription(fmt->i_chroma);
+    size_t size = 0;
+
+    for (unsigned i = 0; dsc != NULL && i < dsc->plane_count; i++)
+        size += (size_t)fmt->i_width * dsc->p[i].w.num / dsc->p[i].w.den
+              * fmt->i_height * dsc->p[i].h.num / dsc->p[i].h.den
+              * dsc->pixel_size;
+    return size;
+}
+
 /* Minimum number of display picture */
 #define DISPLAY_PICTURE_COUNT (1)
 
@@ -183,8 +197,15 @@ void vout_EndWrapper(vout_thread_t *vout)
 
     picture_pool_Release(sys->private_pool);
 
-    if (sys->decoder_pool != sys->display_pool)
+    if (sys->decoder_pool != sys->display_pool) {
+        const unsigned count = picture_pool_GetSize(sys->decoder_pool);
+        const unsigned allocated = picture_pool_GetAllocated(sys->decoder_pool);
+
+        msg_Dbg(vout, "%u/%u decoder pictures allocated (%zu KiB saved)",
+                allocated, count,
+                (count - allocated) * PictureSize(&sys->display.vd->source) >> 10);
         picture_pool_Release(sys->decoder_pool);
+    }
 }
 
 /*****************************************************************************
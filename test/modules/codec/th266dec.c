@@ -0,0 +1,326 @@
+/*****************************************************************************
+ * th266dec.c: th266dec late pictures skipping test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef NDEBUG
+ #undef NDEBUG
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+
+#define MODULE_NAME th266dec
+#define MODULE_STRING "th266dec"
+const char vlc_module_name[] = MODULE_STRING;
+
+#include "../modules/codec/th266dec.c"
+#include "../modules/packetizer/vvc_nal.c"
+
+/* The module sources include config.h again */
+#undef NDEBUG
+#include <assert.h>
+
+/* The module is run against a model of the decoder, which outputs a picture
+ * for each slice. The samples of the picture are a hash of the slice and of
+ * the parameter sets received so far, so that a picture decoded with stale
+ * parameter sets is detected. */
+
+#define WIDTH 16
+#define HEIGHT 16
+#define MAX_NALS 16
+#define MAX_PICTURES 8
+
+struct TH266DecDecoder
+{
+    struct
+    {
+        uint8_t type, id;
+        uint32_t hash;
+    } params[MAX_NALS];
+    unsigned param_count;
+
+    uint32_t pictures[MAX_PICTURES];
+    unsigned picture_count;
+    bool eos;
+};
+
+static uint32_t Hash(uint32_t h, const uint8_t *p, size_t n)
+{
+    while (n-- > 0)
+        h = (h ^ *(p++)) * 16777619;
+    return h;
+}
+
+TH266DecStatus TH266DecCreateDecoder(TH266DecConfig *config,
+                                     TH266DecDecoderHandle *handle)
+{
+    (void) config;
+    *handle = calloc(1, sizeof (struct TH266DecDecoder));
+    return *handle != NULL ? kTH266DecOk : kTH266DecError;
+}
+
+TH266DecStatus TH266DecPushData(TH266DecDecoderHandle handle,
+                                TH266DecDataPacket *packet)
+{
+    struct TH266DecDecoder *d = handle;
+    hxxx_iterator_ctx_t it;
+    const uint8_t *nal;
+    size_t size;
+
+    hxxx_iterator_init(&it, packet->data_buf, packet->data_size, 0);
+    while (hxxx_annexb_iterate_next(&it, &nal, &size))
+    {
+        assert(size > 2);
+
+        const uint8_t type = vvc_getNALType(nal);
+        const uint32_t hash = Hash(2166136261, nal, size);
+
+        if (vvc_isVCL(type))
+        {
+            uint32_t h = hash;
+            for (unsigned i = 0; i < d->param_count; i++)
+                h = Hash(h, (const uint8_t *)&d->params[i].hash, 4);
+            assert(d->picture_count < MAX_PICTURES);
+            d->pictures[d->picture_count++] = h;
+        }
+        else if (IsDecoderStateNAL(type))
+        {   /* the first payload byte stands for the parameter set id */
+            unsigned i = 0;
+            while (i < d->param_count && (d->params[i].type != type ||
+                                          d->params[i].id != nal[2]))
+                i++;
+            if (i == d->param_count)
+            {
+                assert(d->param_count < MAX_NALS);
+                d->param_count++;
+            }
+            d->params[i].type = type;
+            d->params[i].id = nal[2];
+            d->params[i].hash = hash;
+        }
+    }
+    return kTH266DecOk;
+}
+
+TH266DecStatus TH266DecDecodeFrame(TH266DecDecoderHandle handle)
+{
+    struct TH266DecDecoder *d = handle;
+
+    if (d->picture_count > 0)
+        return kTH266DecOk;
+    return d->eos ? kTH266DecEndOfStream : kTH266DecNeedMoreData;
+}
+
+TH266DecStatus TH266DecNotifyEndOfStream(TH266DecDecoderHandle handle)
+{
+    struct TH266DecDecoder *d = handle;
+
+    d->eos = true;
+    return kTH266DecOk;
+}
+
+TH266DecStatus TH266DecGetOutputPicture(TH266DecDecoderHandle handle,
+                                        TH266DecOutputPicture *img)
+{
+    struct TH266DecDecoder *d = handle;
+
+    if (d->picture_count == 0)
+        return kTH266DecNeedMoreData;
+
+    memset(img, 0, sizeof (*img));
+    img->header.width = WIDTH;
+    img->header.height = HEIGHT;
+    img->header.chroma_format = kTH266DecChromaFormat420;
+    for (int i = 0; i < 3; i++)
+    {
+        const int stride = i ? WIDTH / 2 : WIDTH;
+        const size_t size = stride * (i ? HEIGHT / 2 : HEIGHT);
+        uint8_t *pix = malloc(size);
+
+        assert(pix != NULL);
+        memset(pix, 0x80, size);
+        img->planes[i].pix = pix;
+        img->planes[i].stride = stride;
+        img->planes[i].bit_depth = 8;
+    }
+    memcpy(img->planes[0].pix, &d->pictures[0], 4);
+
+    d->picture_count--;
+    memmove(&d->pictures[0], &d->pictures[1],
+            d->picture_count * sizeof (d->pictures[0]));
+    return kTH266DecOk;
+}
+
+TH266DecStatus TH266DecReleaseOutputPicture(TH266DecDecoderHandle handle,
+                                            TH266DecOutputPicture *img)
+{
+    (void) handle;
+    for (int i = 0; i < 3; i++)
+        free(img->planes[i].pix);
+    return kTH266DecOk;
+}
+
+TH266DecStatus TH266DecCloseDecoder(TH266DecDecoderHandle handle)
+{
+    free(handle);
+    return kTH266DecOk;
+}
+
+/* VVC NAL units, the first payload byte is the parameter set id */
+#define SC 0x00, 0x00, 0x00, 0x01
+#define SPS SC, 0x00, 0x79, 0x00, 0x11
+#define PPS SC, 0x00, 0x81, 0x00, 0x22
+#define APS(v) SC, 0x00, 0x89, 0x00, (v)
+#define PH SC, 0x00, 0x99, 0x33
+#define IDR SC, 0x00, 0x41, 0x44, 0x55
+#define TRAIL(v) SC, 0x00, 0x01, (v), 0x66
+#define SEI SC, 0x00, 0xC1, 0x77 /* suffix SEI */
+
+static const uint8_t idr[] = { SPS, PPS, APS(1), IDR };
+/* Non-reference picture updating the ALF parameters */
+static const uint8_t nonref[] = { APS(2), PH, TRAIL(1), SEI };
+static const uint8_t nonref_stale[] = { PH, TRAIL(1), SEI };
+/* Reference picture using the updated ALF parameters */
+static const uint8_t ref[] = { TRAIL(2) };
+
+struct output
+{
+    uint32_t hashes[4];
+    mtime_t dates[4];
+    unsigned count;
+};
+
+static int FormatUpdate(decoder_t *dec)
+{
+    (void) dec;
+    return VLC_SUCCESS;
+}
+
+static picture_t *BufferNew(decoder_t *dec)
+{
+    return picture_NewFromFormat(&dec->fmt_out.video);
+}
+
+static int QueueVideo(decoder_t *dec, picture_t *pic)
+{
+    struct output *out = dec->p_queue_ctx;
+
+    assert(out->count < ARRAY_SIZE(out->hashes));
+    memcpy(&out->hashes[out->count], pic->p[0].p_pixels, 4);
+    out->dates[out->count++] = pic->date;
+    picture_Release(pic);
+    return 0;
+}
+
+static void DecodeStream(vlc_object_t *obj, const uint8_t *nonref_au,
+                         size_t nonref_size, bool skip,
+                         struct output *out)
+{
+    static const struct
+    {
+        const uint8_t *data;
+        size_t size;
+        int flags;
+    } aus[] = {
+        { idr, sizeof (idr), BLOCK_FLAG_TYPE_I },
+        { NULL, 0, BLOCK_FLAG_TYPE_B },
+        { ref, sizeof (ref), BLOCK_FLAG_TYPE_P },
+    };
+    decoder_t *dec = vlc_object_create(obj, sizeof (*dec));
+    assert(dec != NULL);
+
+    var_Create(dec, "th266dec-threads", VLC_VAR_INTEGER);
+    var_SetInteger(dec, "th266dec-threads", 1);
+    var_Create(dec, "th266dec-zero-copy", VLC_VAR_BOOL);
+    var_SetBool(dec, "th266dec-zero-copy", true);
+    var_Create(dec, "th266dec-copy-threads", VLC_VAR_INTEGER);
+    var_SetInteger(dec, "th266dec-copy-threads", 1);
+    var_Create(dec, "th266dec-skip-frames", VLC_VAR_INTEGER);
+    var_SetInteger(dec, "th266dec-skip-frames", 1);
+
+    es_format_Init(&dec->fmt_in, VIDEO_ES, VLC_CODEC_VVC);
+    es_format_Init(&dec->fmt_out, VIDEO_ES, 0);
+    dec->b_frame_drop_allowed = true;
+    dec->pf_vout_format_update = FormatUpdate;
+    dec->pf_vout_buffer_new = BufferNew;
+    dec->pf_queue_video = QueueVideo;
+    dec->p_queue_ctx = out;
+    out->count = 0;
+
+    assert(OpenDecoder(VLC_OBJECT(dec)) == VLC_SUCCESS);
+    for (size_t i = 0; i < ARRAY_SIZE(aus); i++)
+    {
+        const uint8_t *data = aus[i].data ? aus[i].data : nonref_au;
+        const size_t size = aus[i].data ? aus[i].size : nonref_size;
+        block_t *block = block_Alloc(size);
+
+        assert(block != NULL);
+        memcpy(block->p_buffer, data, size);
+        block->i_pts = block->i_dts = VLC_TS_0 + i * 40000;
+        block->i_flags = aus[i].flags;
+        /* Skip the non-reference picture without depending on the clock */
+        if (skip)
+            block->i_flags |= BLOCK_FLAG_PREROLL;
+        assert(dec->pf_decode(dec, block) == VLCDEC_SUCCESS);
+    }
+    assert(dec->pf_decode(dec, NULL) == VLCDEC_SUCCESS);
+
+    assert(dec->p_sys->i_skipped == (skip ? 1 : 0));
+    CloseDecoder(VLC_OBJECT(dec));
+    es_format_Clean(&dec->fmt_in);
+    es_format_Clean(&dec->fmt_out);
+    vlc_object_release(dec);
+}
+
+int main(void)
+{
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    struct output all, skipped, stale;
+
+    DecodeStream(obj, nonref, sizeof (nonref), false, &all);
+    assert(all.count == 3);
+
+    /* The reference picture following the skipped one is the same */
+    DecodeStream(obj, nonref, sizeof (nonref), true, &skipped);
+    assert(skipped.count == 2);
+    assert(skipped.dates[0] == all.dates[0]);
+    assert(skipped.hashes[0] == all.hashes[0]);
+    assert(skipped.dates[1] == all.dates[2]);
+    assert(skipped.hashes[1] == all.hashes[2]);
+
+    /* and it would not be without the APS of the skipped access unit */
+    DecodeStream(obj, nonref_stale, sizeof (nonref_stale), true, &stale);
+    assert(stale.count == 2);
+    assert(stale.hashes[1] != all.hashes[2]);
+
+    libvlc_release(vlc);
+    return 0;
+}
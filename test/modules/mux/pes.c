@@ -0,0 +1,113 @@
+/*****************************************************************************
+ * pes.c: PES muxing helpers test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef NDEBUG
+ #undef NDEBUG
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_es.h>
+
+#include "../modules/mux/mpeg/pes.c"
+
+/* VVC NAL units, with their 2 bytes header */
+#define AUD(irap) 0x00, 0x00, 0x00, 0x01, 0x00, 0xA1, (irap) ? 0xA8 : 0x28
+#define SPS 0x00, 0x00, 0x00, 0x01, 0x00, 0x79, 0x00, 0x01, 0x02
+#define PPS 0x00, 0x00, 0x01, 0x00, 0x81, 0x03, 0x04
+#define PH  0x00, 0x00, 0x01, 0x00, 0x99, 0x05
+#define IDR 0x00, 0x00, 0x01, 0x00, 0x41, 0x06, 0x07, 0x08
+#define TRAIL 0x00, 0x00, 0x01, 0x00, 0x01, 0x09, 0x0A, 0x0B
+
+static const uint8_t extra[] = { SPS, PPS };
+
+static void test_au(const char *name, const uint8_t *in, size_t in_size,
+                    bool keyframe, const uint8_t *out, size_t out_size)
+{
+    es_format_t fmt;
+
+    es_format_Init(&fmt, VIDEO_ES, VLC_CODEC_VVC);
+    fmt.p_extra = (void *)extra;
+    fmt.i_extra = sizeof (extra);
+
+    block_t *block = block_Alloc(in_size);
+    assert(block != NULL);
+    memcpy(block->p_buffer, in, in_size);
+    if (keyframe)
+        block->i_flags |= BLOCK_FLAG_TYPE_I;
+
+    block = VVCSetupAccessUnit(block, &fmt);
+    assert(block != NULL);
+
+    if (block->i_buffer != out_size
+     || memcmp(block->p_buffer, out, out_size))
+    {
+        fprintf(stderr, "%s: mismatch\n", name);
+        for (size_t i = 0; i < block->i_buffer; i++)
+            fprintf(stderr, " %02x", block->p_buffer[i]);
+        fputc('\n', stderr);
+        abort();
+    }
+    printf("%s: OK\n", name);
+    block_Release(block);
+}
+
+#define TEST(name, keyframe, in, out) \
+    test_au(name, in, sizeof (in), keyframe, out, sizeof (out))
+
+int main(void)
+{
+    static const uint8_t trail[] = { TRAIL };
+    static const uint8_t aud_trail[] = { AUD(false), TRAIL };
+    static const uint8_t ph_trail[] = { PH, TRAIL };
+    static const uint8_t aud_ph_trail[] = { AUD(false), PH, TRAIL };
+    static const uint8_t idr[] = { IDR };
+    static const uint8_t aud_idr[] = { AUD(true), IDR };
+    static const uint8_t aud_ps_idr[] = { AUD(true), SPS, PPS, IDR };
+    static const uint8_t aud_ph_idr[] = { AUD(true), PH, IDR };
+    static const uint8_t aud_ps_ph_idr[] = { AUD(true), SPS, PPS, PH, IDR };
+    static const uint8_t aud[] = { AUD(true) };
+    static const uint8_t aud_ps[] = { AUD(true), SPS, PPS };
+
+    /* An AUD is inserted in front of the access units without one */
+    TEST("no AUD", false, trail, aud_trail);
+    TEST("no AUD, with PH", false, ph_trail, aud_ph_trail);
+    TEST("no AUD, IRAP", false, idr, aud_idr);
+
+    /* The parameter sets go after the AUD, whether it is inserted or not */
+    TEST("no AUD, keyframe", true, idr, aud_ps_idr);
+    TEST("AUD, keyframe", true, aud_idr, aud_ps_idr);
+    TEST("AUD, keyframe, with PH", true, aud_ph_idr, aud_ps_ph_idr);
+    TEST("AUD only, keyframe", true, aud, aud_ps);
+
+    /* Otherwise the access units are left alone */
+    TEST("AUD", false, aud_trail, aud_trail);
+    TEST("AUD, IRAP", false, aud_idr, aud_idr);
+
+    return 0;
+}
@@ -0,0 +1,279 @@
+/*****************************************************************************
+ * yuv_rgb.c: Vectorized YUV to RGB conversion test
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef NDEBUG
+ #undef NDEBUG
+#endif
+
+#include <assert.h>
+#include <math.h>
+#include <stdalign.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "../modules/video_chroma/yuv_rgb_simd.h"
+
+/* The C routines must stay within one of the exact conversion, and the
+ * vectorized ones must give the same pixels as the C ones. */
+
+#define WIDTH_MAX 1920
+#define BENCH_LINES 1080
+
+struct chroma
+{
+    const char *name;
+    unsigned bits;
+    unsigned shift;
+    bool semiplanar;
+    yuv_rgb_row_t c;
+#ifdef HAVE_YUV_RGB_SSE4_1
+    yuv_rgb_row_t sse4_1;
+#endif
+#ifdef HAVE_YUV_RGB_AVX2
+    yuv_rgb_row_t avx2;
+#endif
+};
+
+#if defined(HAVE_YUV_RGB_SSE4_1) && defined(HAVE_YUV_RGB_AVX2)
+# define ROWS(f) f ## _c, f ## _sse4_1, f ## _avx2
+#elif defined(HAVE_YUV_RGB_SSE4_1)
+# define ROWS(f) f ## _c, f ## _sse4_1
+#elif defined(HAVE_YUV_RGB_AVX2)
+# define ROWS(f) f ## _c, f ## _avx2
+#else
+# define ROWS(f) f ## _c
+#endif
+
+static const struct chroma chromas[] = {
+    { "I420", 8, 0, false, ROWS(yuv_rgb_i420) },
+    { "NV12", 8, 0, true, ROWS(yuv_rgb_nv12) },
+    { "I0AL", 10, 0, false, ROWS(yuv_rgb_i420_16) },
+    { "P010", 10, 6, true, ROWS(yuv_rgb_p010) },
+};
+
+static const struct
+{
+    video_color_space_t space;
+    double kr, kb;
+} spaces[] = {
+    { COLOR_SPACE_BT601, 0.299, 0.114 },
+    { COLOR_SPACE_BT709, 0.2126, 0.0722 },
+    { COLOR_SPACE_BT2020, 0.2627, 0.0593 },
+};
+
+static alignas (32) uint8_t luma[WIDTH_MAX * 2];
+static alignas (32) uint8_t cb[WIDTH_MAX * 2], cr[WIDTH_MAX];
+static alignas (32) uint8_t ref[WIDTH_MAX * 4], out[WIDTH_MAX * 4];
+
+static unsigned Random(void)
+{
+    static uint32_t seed = 1;
+
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+/* Fills the planes with samples, including some outside of the nominal
+ * range, and returns them unpacked, chroma samples interleaved */
+static void FillPlanes(const struct chroma *ch, unsigned width,
+                       unsigned *y, unsigned *uv)
+{
+    const unsigned max = (1u << ch->bits) - 1;
+    const unsigned chroma_width = (width + 1) / 2;
+
+    for (unsigned x = 0; x < width; x++)
+    {
+        y[x] = Random() & max;
+        if (ch->bits > 8)
+            ((uint16_t *)luma)[x] = y[x] << ch->shift;
+        else
+            luma[x] = y[x];
+    }
+
+    for (unsigned x = 0; x < 2 * chroma_width; x++)
+    {
+        uv[x] = Random() & max;
+
+        const unsigned i = ch->semiplanar ? x : x / 2;
+        uint8_t *plane = (ch->semiplanar || !(x & 1)) ? cb : cr;
+
+        if (ch->bits > 8)
+            ((uint16_t *)plane)[i] = uv[x] << ch->shift;
+        else
+            plane[i] = uv[x];
+    }
+}
+
+static uint8_t Exact(double v)
+{
+    long l = lround(v * 255.);
+
+    return l < 0 ? 0 : l > 255 ? 255 : l;
+}
+
+static void CheckAccuracy(const struct chroma *ch)
+{
+    unsigned y[WIDTH_MAX], uv[WIDTH_MAX + 1];
+    const double scale = 1 << (ch->bits - 8);
+    int max_error = 0;
+
+    for (size_t s = 0; s < ARRAY_SIZE(spaces); s++)
+        for (int full = 0; full < 2; full++)
+            for (int bgr = 0; bgr < 2; bgr++)
+            {
+                const double kr = spaces[s].kr, kb = spaces[s].kb;
+                const double kg = 1. - kr - kb;
+                const double max = (1 << ch->bits) - 1;
+                yuv_rgb_coefs_t c;
+
+                yuv_rgb_SetupCoefs(&c, spaces[s].space, full, ch->bits,
+                                   ch->shift, bgr);
+                FillPlanes(ch, WIDTH_MAX, y, uv);
+                ch->c(out, luma, cb, cr, WIDTH_MAX, &c);
+
+                for (unsigned x = 0; x < WIDTH_MAX; x++)
+                {
+                    double l, u, v;
+
+                    if (full)
+                    {
+                        l = y[x] / max;
+                        u = (uv[x & ~1u] - 128. * scale) / max;
+                        v = (uv[x | 1u] - 128. * scale) / max;
+                    }
+                    else
+                    {
+                        l = (y[x] - 16. * scale) / (219. * scale);
+                        u = (uv[x & ~1u] - 128. * scale) / (224. * scale);
+                        v = (uv[x | 1u] - 128. * scale) / (224. * scale);
+                    }
+
+                    const uint8_t rgb[3] = {
+                        Exact(l + 2. * (1. - kr) * v),
+                        Exact(l - 2. * kb * (1. - kb) / kg * u
+                                - 2. * kr * (1. - kr) / kg * v),
+                        Exact(l + 2. * (1. - kb) * u),
+                    };
+
+                    for (int i = 0; i < 3; i++)
+                    {
+                        const int e = abs(rgb[i] - out[4 * x
+                                                       + (bgr ? 2 - i : i)]);
+
+                        if (e > 1)
+                        {
+                            fprintf(stderr, "%s: space %d, %s range: "
+                                    "pixel %u component %d is off by %d\n",
+                                    ch->name, spaces[s].space,
+                                    full ? "full" : "limited", x, i, e);
+                            abort();
+                        }
+                        max_error = __MAX(max_error, e);
+                    }
+                    assert(out[4 * x + 3] == 0xFF);
+                }
+            }
+
+    printf("yuv_rgb %s C     : maximum error %d\n", ch->name, max_error);
+}
+
+static void CheckExact(const struct chroma *ch, const char *name,
+                       yuv_rgb_row_t row)
+{
+    unsigned y[WIDTH_MAX], uv[WIDTH_MAX + 1];
+
+    for (unsigned iter = 0; iter < 200; iter++)
+    {
+        unsigned width = (iter < 100) ? iter + 1 : WIDTH_MAX - (Random() % 64);
+        yuv_rgb_coefs_t c;
+
+        yuv_rgb_SetupCoefs(&c, spaces[iter % ARRAY_SIZE(spaces)].space,
+                           iter & 1, ch->bits, ch->shift, iter & 2);
+        FillPlanes(ch, width, y, uv);
+        memset(ref, 0xA5, sizeof (ref));
+        memset(out, 0xA5, sizeof (out));
+        ch->c(ref, luma, cb, cr, width, &c);
+        row(out, luma, cb, cr, width, &c);
+
+        if (memcmp(ref, out, sizeof (ref)))
+        {
+            fprintf(stderr, "%s %s: mismatch (width %u)\n", ch->name, name,
+                    width);
+            abort();
+        }
+    }
+}
+
+static void Bench(const struct chroma *ch, const char *name,
+                  yuv_rgb_row_t row)
+{
+    unsigned y[WIDTH_MAX], uv[WIDTH_MAX + 1];
+    yuv_rgb_coefs_t c;
+
+    yuv_rgb_SetupCoefs(&c, COLOR_SPACE_BT709, false, ch->bits, ch->shift,
+                       true);
+    FillPlanes(ch, WIDTH_MAX, y, uv);
+
+    mtime_t start = mdate();
+    for (unsigned i = 0; i < BENCH_LINES; i++)
+        row(out, luma, cb, cr, WIDTH_MAX, &c);
+    mtime_t end = mdate();
+
+    printf("yuv_rgb %s %-6s: %7.3f ms per %ux%u picture\n", ch->name, name,
+           (end - start) / 1000., WIDTH_MAX, BENCH_LINES);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(chromas); i++)
+    {
+        const struct chroma *ch = &chromas[i];
+
+        CheckAccuracy(ch);
+        Bench(ch, "C", ch->c);
+#ifdef HAVE_YUV_RGB_SSE4_1
+        if (vlc_CPU_SSE4_1())
+        {
+            CheckExact(ch, "SSE4.1", ch->sse4_1);
+            Bench(ch, "SSE4.1", ch->sse4_1);
+        }
+        else
+            printf("yuv_rgb SSE4.1: not supported by this CPU\n");
+#endif
+#ifdef HAVE_YUV_RGB_AVX2
+        if (vlc_CPU_AVX2())
+        {
+            CheckExact(ch, "AVX2", ch->avx2);
+            Bench(ch, "AVX2", ch->avx2);
+        }
+        else
+            printf("yuv_rgb AVX2: not supported by this CPU\n");
+#endif
+    }
+    return 0;
+}
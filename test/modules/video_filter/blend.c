@@ -0,0 +1,200 @@
+/*****************************************************************************
+ * blend.c: Vectorized blending test
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef NDEBUG
+ #undef NDEBUG
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_modules.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+/* The vectorized routines must give the same pictures as the generic ones,
+ * for any position and size of the blended picture. */
+
+#define DST_WIDTH 320
+#define DST_HEIGHT 48
+#define SRC_WIDTH 203
+#define SRC_HEIGHT 37
+
+static const struct
+{
+    vlc_fourcc_t dst;
+    vlc_fourcc_t src;
+} chromas[] = {
+    { VLC_CODEC_I420,     VLC_CODEC_YUVA },
+    { VLC_CODEC_J420,     VLC_CODEC_YUVA },
+    { VLC_CODEC_YV12,     VLC_CODEC_YUVA },
+    { VLC_CODEC_NV12,     VLC_CODEC_YUVA },
+    { VLC_CODEC_NV21,     VLC_CODEC_YUVA },
+    { VLC_CODEC_I420_10L, VLC_CODEC_YUVA },
+    { VLC_CODEC_RGB32,    VLC_CODEC_RGBA },
+};
+
+static const struct
+{
+    int x, y;
+    unsigned width;
+} positions[] = {
+    { 0, 0, SRC_WIDTH }, { 1, 1, SRC_WIDTH }, { 6, 3, 64 }, { 17, 10, 31 },
+    { DST_WIDTH - SRC_WIDTH, DST_HEIGHT - SRC_HEIGHT, SRC_WIDTH },
+    { DST_WIDTH - 50, 2, SRC_WIDTH }, /* clipped */
+};
+
+static const int alphas[] = { 255, 128, 1 };
+
+static unsigned Random(void)
+{
+    static uint32_t seed = 1;
+
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+static picture_t *NewPicture(vlc_fourcc_t chroma, unsigned width,
+                             unsigned height)
+{
+    const vlc_chroma_description_t *desc =
+        vlc_fourcc_GetChromaDescription(chroma);
+    video_format_t fmt;
+
+    video_format_Init(&fmt, 0);
+    video_format_Setup(&fmt, chroma, width, height, width, height, 1, 1);
+
+    picture_t *pic = picture_NewFromFormat(&fmt);
+    assert(pic != NULL);
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        plane_t *p = &pic->p[i];
+
+        for (int y = 0; y < p->i_lines; y++)
+        {
+            uint8_t *line = &p->p_pixels[y * p->i_pitch];
+
+            if (desc->pixel_size == 2)
+                for (int x = 0; x < p->i_pitch / 2; x++)
+                    ((uint16_t *)line)[x] = Random()
+                                          & ((1 << desc->pixel_bits) - 1);
+            else
+                for (int x = 0; x < p->i_pitch; x++)
+                {   /* Plenty of fully transparent and opaque pixels */
+                    unsigned v = Random();
+
+                    line[x] = (v & 0x300) == 0 ? 0 :
+                              (v & 0x300) == 0x100 ? 255 : v & 0xFF;
+                }
+        }
+    }
+    return pic;
+}
+
+static void Blend(vlc_object_t *obj, picture_t *dst, const picture_t *src,
+                  int x, int y, int alpha, bool simd)
+{
+    filter_t *blend = vlc_object_create(obj, sizeof (*blend));
+    assert(blend != NULL);
+
+    es_format_Init(&blend->fmt_in, VIDEO_ES, src->format.i_chroma);
+    blend->fmt_in.video = src->format;
+    es_format_Init(&blend->fmt_out, VIDEO_ES, dst->format.i_chroma);
+    blend->fmt_out.video = dst->format;
+
+    var_Create(blend, "blend-simd", VLC_VAR_BOOL);
+    var_SetBool(blend, "blend-simd", simd);
+    blend->p_module = module_need(blend, "video blending", "blend", true);
+    assert(blend->p_module != NULL);
+
+    blend->pf_video_blend(blend, dst, src, x, y, alpha);
+
+    module_unneed(blend, blend->p_module);
+    vlc_object_release(blend);
+}
+
+static void test_chroma(vlc_object_t *obj, vlc_fourcc_t dst_chroma,
+                        vlc_fourcc_t src_chroma)
+{
+    picture_t *base = NewPicture(dst_chroma, DST_WIDTH, DST_HEIGHT);
+    picture_t *src = NewPicture(src_chroma, SRC_WIDTH, SRC_HEIGHT);
+    picture_t *ref = NewPicture(dst_chroma, DST_WIDTH, DST_HEIGHT);
+    picture_t *out = NewPicture(dst_chroma, DST_WIDTH, DST_HEIGHT);
+
+    for (size_t i = 0; i < ARRAY_SIZE(positions); i++)
+        for (size_t j = 0; j < ARRAY_SIZE(alphas); j++)
+        {
+            src->format.i_visible_width = positions[i].width;
+            picture_CopyPixels(ref, base);
+            picture_CopyPixels(out, base);
+
+            Blend(obj, ref, src, positions[i].x, positions[i].y, alphas[j],
+                  false);
+            Blend(obj, out, src, positions[i].x, positions[i].y, alphas[j],
+                  true);
+
+            for (int p = 0; p < ref->i_planes; p++)
+            {
+                size_t size = ref->p[p].i_pitch * ref->p[p].i_lines;
+
+                if (memcmp(ref->p[p].p_pixels, out->p[p].p_pixels, size))
+                {
+                    fprintf(stderr, "%4.4s -> %4.4s at %d x %d, width %u, "
+                            "alpha %d: plane %d mismatch\n",
+                            (const char *)&src_chroma,
+                            (const char *)&dst_chroma, positions[i].x,
+                            positions[i].y, positions[i].width, alphas[j],
+                            p);
+                    abort();
+                }
+            }
+        }
+
+    printf("%4.4s -> %4.4s: OK\n", (const char *)&src_chroma,
+           (const char *)&dst_chroma);
+    picture_Release(out);
+    picture_Release(ref);
+    picture_Release(src);
+    picture_Release(base);
+}
+
+int main(void)
+{
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+
+    for (size_t i = 0; i < ARRAY_SIZE(chromas); i++)
+        test_chroma(VLC_OBJECT(vlc->p_libvlc_int), chromas[i].dst,
+                    chromas[i].src);
+
+    libvlc_release(vlc);
+    return 0;
+}
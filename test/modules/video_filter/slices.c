@@ -0,0 +1,174 @@
+/*****************************************************************************
+ * slices.c: slice-parallel video filters test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef NDEBUG
+ #undef NDEBUG
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+/* The filters processing pictures in bands must give the same pictures
+ * whatever the number of bands. */
+
+#define WIDTH 1280
+#define HEIGHT 720
+#define SLICES 8
+
+static const vlc_fourcc_t chromas[] = {
+    VLC_CODEC_I420, VLC_CODEC_I422, VLC_CODEC_I420_10L,
+};
+
+static const char *const filters[] = {
+    "sharpen{sigma=2}",
+    "adjust{contrast=1.3,brightness=1.1,hue=40,saturation=1.6,gamma=1.4}",
+    "adjust{saturation=2.5}", /* with clipping */
+    "croppadd{croptop=18,cropbottom=30,cropleft=8,cropright=4,paddtop=36,"
+        "paddbottom=20,paddleft=6,paddright=10}",
+};
+
+static unsigned Random(void)
+{
+    static uint32_t seed = 1;
+
+    seed = seed * 1103515245 + 12345;
+    return seed >> 16;
+}
+
+static picture_t *NewPicture(vlc_fourcc_t chroma)
+{
+    const vlc_chroma_description_t *desc =
+        vlc_fourcc_GetChromaDescription(chroma);
+    video_format_t fmt;
+
+    video_format_Init(&fmt, 0);
+    video_format_Setup(&fmt, chroma, WIDTH, HEIGHT, WIDTH, HEIGHT, 1, 1);
+
+    picture_t *pic = picture_NewFromFormat(&fmt);
+    assert(pic != NULL);
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        plane_t *p = &pic->p[i];
+
+        for (int y = 0; y < p->i_lines; y++)
+        {
+            uint8_t *line = &p->p_pixels[y * p->i_pitch];
+
+            if (desc->pixel_size == 2)
+                for (int x = 0; x < p->i_pitch / 2; x++)
+                    ((uint16_t *)line)[x] = Random()
+                                          & ((1 << desc->pixel_bits) - 1);
+            else
+                for (int x = 0; x < p->i_pitch; x++)
+                    line[x] = Random();
+        }
+    }
+    return pic;
+}
+
+static picture_t *BufferNew(filter_t *filter)
+{
+    return picture_NewFromFormat(&filter->fmt_out.video);
+}
+
+static picture_t *Filter(vlc_object_t *obj, const char *filter,
+                         picture_t *pic, unsigned slices)
+{
+    const filter_owner_t owner = {
+        .video = {
+            .buffer_new = BufferNew,
+        },
+    };
+    es_format_t fmt;
+
+    var_SetInteger(obj, "filter-slices", slices);
+    filter_chain_t *chain = filter_chain_NewVideo(obj, true, &owner);
+    assert(chain != NULL);
+
+    es_format_Init(&fmt, VIDEO_ES, pic->format.i_chroma);
+    fmt.video = pic->format;
+    filter_chain_Reset(chain, &fmt, &fmt);
+    assert(filter_chain_AppendFromString(chain, filter) == 1);
+
+    picture_t *out = filter_chain_VideoFilter(chain, picture_Hold(pic));
+    assert(out != NULL);
+    filter_chain_Delete(chain);
+    return out;
+}
+
+static void test_filter(vlc_object_t *obj, const char *filter,
+                        vlc_fourcc_t chroma)
+{
+    picture_t *pic = NewPicture(chroma);
+    picture_t *ref = Filter(obj, filter, pic, 1);
+    picture_t *out = Filter(obj, filter, pic, SLICES);
+
+    assert(ref->i_planes == out->i_planes);
+    for (int p = 0; p < ref->i_planes; p++)
+    {
+        const plane_t *a = &ref->p[p], *b = &out->p[p];
+
+        assert(a->i_visible_lines == b->i_visible_lines);
+        assert(a->i_visible_pitch == b->i_visible_pitch);
+        for (int y = 0; y < a->i_visible_lines; y++)
+            if (memcmp(&a->p_pixels[y * a->i_pitch],
+                       &b->p_pixels[y * b->i_pitch], a->i_visible_pitch))
+            {
+                fprintf(stderr, "%s, %4.4s: plane %d line %d mismatch\n",
+                        filter, (const char *)&chroma, p, y);
+                abort();
+            }
+    }
+
+    printf("%s, %4.4s: OK\n", filter, (const char *)&chroma);
+    picture_Release(out);
+    picture_Release(ref);
+    picture_Release(pic);
+}
+
+int main(void)
+{
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    var_Create(obj, "filter-slices", VLC_VAR_INTEGER);
+
+    for (size_t i = 0; i < ARRAY_SIZE(filters); i++)
+        for (size_t j = 0; j < ARRAY_SIZE(chromas); j++)
+            test_filter(obj, filters[i], chromas[j]);
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,182 @@
+/*****************************************************************************
+ * yadif.c: Yadif line filters test and benchmark
+ *****************************************************************************
+ * Copyright (C) 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef NDEBUG
+ #undef NDEBUG
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "../modules/video_filter/deinterlace/common.h"
+#include "../modules/video_filter/deinterlace/yadif.h"
+
+/* Room for two lines above and below, and for 3 pixels on each side */
+#define LINES 5
+#define WIDTH_MAX 1920
+#define PITCH ((WIDTH_MAX + 64) * 2)
+#define BENCH_LINES 20000
+
+typedef void (*yadif_line_8)(uint8_t *, uint8_t *, uint8_t *, uint8_t *,
+                             int, int, int, int, int);
+typedef void (*yadif_line_16)(uint16_t *, uint16_t *, uint16_t *, uint16_t *,
+                              int, int, int, int, int);
+
+struct variant
+{
+    const char *name;
+    bool supported;
+    yadif_line_8 filter;
+    yadif_line_16 filter16;
+};
+
+static alignas (32) uint8_t planes[3][LINES * PITCH];
+static alignas (32) uint8_t ref[PITCH], out[PITCH];
+
+static void FillPlanes(unsigned bits)
+{
+    for (unsigned p = 0; p < 3; p++)
+        for (unsigned i = 0; i < LINES * PITCH; i += 2)
+        {
+            unsigned v = rand();
+
+            if (bits <= 8)
+            {
+                planes[p][i] = v;
+                planes[p][i + 1] = v >> 8;
+            }
+            else
+            {   /* Mostly smooth content, so that all the paths are taken */
+                v = (v & 7) ? (i * 37u + (v & 63)) : v;
+                ((uint16_t *)planes[p])[i / 2] = v & ((1u << bits) - 1);
+            }
+        }
+}
+
+static void Run(const struct variant *v, uint8_t *dst, int w, int pixel_size,
+                int parity, int mode)
+{
+    const size_t offset = 2 * PITCH + 32;
+
+    if (pixel_size == 2)
+        v->filter16((uint16_t *)dst, (uint16_t *)&planes[0][offset],
+                    (uint16_t *)&planes[1][offset],
+                    (uint16_t *)&planes[2][offset], w, PITCH, -PITCH,
+                    parity, mode);
+    else
+        v->filter(dst, &planes[0][offset], &planes[1][offset],
+                  &planes[2][offset], w, PITCH, -PITCH, parity, mode);
+}
+
+static void Check(const struct variant *c, const struct variant *v,
+                  int pixel_size, unsigned bits)
+{
+    for (unsigned iter = 0; iter < 200; iter++)
+    {
+        int w = (iter < 100) ? (int)iter + 1 : WIDTH_MAX - (rand() % 64);
+
+        FillPlanes(bits);
+        for (int parity = 0; parity < 2; parity++)
+            for (int mode = 0; mode <= 2; mode += 2)
+            {
+                memset(ref, 0xA5, sizeof (ref));
+                memset(out, 0xA5, sizeof (out));
+                Run(c, ref, w, pixel_size, parity, mode);
+                Run(v, out, w, pixel_size, parity, mode);
+                /* The assembly versions may write whole vectors past w */
+                if (memcmp(ref, out, w * pixel_size))
+                {
+                    fprintf(stderr, "%s: mismatch (%u-bit, width %d, "
+                            "parity %d, mode %d)\n", v->name, bits, w,
+                            parity, mode);
+                    abort();
+                }
+            }
+    }
+}
+
+static void Bench(const struct variant *v, int pixel_size, unsigned bits)
+{
+    FillPlanes(bits);
+
+    mtime_t start = mdate();
+    for (unsigned i = 0; i < BENCH_LINES; i++)
+        Run(v, out, WIDTH_MAX, pixel_size, i & 1, 0);
+    mtime_t end = mdate();
+
+    printf("yadif %2u-bit %-6s: %6.2f us per %u-pixel line\n", bits, v->name,
+           (end - start) / (double)BENCH_LINES, WIDTH_MAX);
+}
+
+int main(void)
+{
+    const struct variant variants[] = {
+        { "C", true, yadif_filter_line_c, yadif_filter_line_c_16bit },
+#if defined(HAVE_YADIF_MMX)
+        { "MMX", vlc_CPU_MMX(), yadif_filter_line_mmx, NULL },
+#endif
+#if defined(HAVE_YADIF_SSE2)
+        { "SSE2", vlc_CPU_SSE2(), yadif_filter_line_sse2, NULL },
+#endif
+#if defined(HAVE_YADIF_SSSE3)
+        { "SSSE3", vlc_CPU_SSSE3(), yadif_filter_line_ssse3, NULL },
+#endif
+#if defined(HAVE_YADIF_16BIT_SSE4_1)
+        { "SSE4.1", vlc_CPU_SSE4_1(), NULL, yadif_filter_line_16bit_sse4_1 },
+#endif
+#if defined(HAVE_YADIF_AVX2)
+        { "AVX2", vlc_CPU_AVX2(), yadif_filter_line_avx2,
+          yadif_filter_line_16bit_avx2 },
+#endif
+    };
+
+    srand(0);
+    for (size_t i = 0; i < ARRAY_SIZE(variants); i++)
+    {
+        const struct variant *v = &variants[i];
+
+        if (!v->supported)
+        {
+            printf("yadif %s: not supported by this CPU\n", v->name);
+            continue;
+        }
+        if (v->filter != NULL)
+        {
+            Check(&variants[0], v, 1, 8);
+            Bench(v, 1, 8);
+        }
+        if (v->filter16 != NULL)
+        {
+            Check(&variants[0], v, 2, 10);
+            Check(&variants[0], v, 2, 16);
+            Bench(v, 2, 10);
+        }
+    }
+    return 0;
+}
@@ -34,11 +34,19 @@
 #include <vlc_url.h>
 
 #include <vlc/libvlc.h>
-#include "../../lib/libvlc_internal.h"
+#include "../lib/libvlc_internal.h"
 
 #include "common.h"
 #include "decoder.h"
 
+struct decoder_owner_sys_t
+{
+    decoder_t *packetizer;
+    uintmax_t frames;
+    mtime_t packetizer_time;
+    mtime_t decoder_time;
+};
+
 static picture_t *video_new_buffer_decoder(decoder_t *dec)
 {
     return picture_NewFromFormat(&dec->fmt_out.video);
@@ -56,16 +64,22 @@ static int video_update_format_decoder(decoder_t *dec)
     (void) dec;
     return 0;
 }
-static int queue_video(decoder_t *dec, picture_t *pic)
+
+static int audio_update_format_decoder(decoder_t *dec)
 {
     (void) dec;
+    return 0;
+}
+static int queue_video(decoder_t *dec, picture_t *pic)
+{
+    dec->p_owner->frames++;
     picture_Release(pic);
     return 0;
 }
 
 static int queue_audio(decoder_t *dec, block_t *p_block)
 {
-    (void) dec;
+    dec->p_owner->frames++;
     block_Release(p_block);
     return 0;
 }
@@ -77,7 +91,7 @@ static int queue_cc(decoder_t *dec, block_t *p_block, const decoder_cc_desc_t *d
 }
 static int queue_sub(decoder_t *dec, subpicture_t *p_subpic)
 {
-    (void) dec;
+    dec->p_owner->frames++;
     subpicture_Delete(p_subpic);
     return 0;
 }
@@ -135,12 +149,14 @@ static void decoder_unload(decoder_t *decoder)
 
 void test_decoder_destroy(decoder_t *decoder)
 {
-    decoder_t *packetizer = (void *) decoder->p_owner;
+    decoder_owner_sys_t *owner = decoder->p_owner;
+    decoder_t *packetizer = owner->packetizer;
 
     decoder_unload(packetizer);
     decoder_unload(decoder);
     vlc_object_release(packetizer);
     vlc_object_release(decoder);
+    free(owner);
 }
 
 decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt)
@@ -149,6 +165,10 @@ decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt)
     decoder_t *packetizer = NULL;
     decoder_t *decoder = NULL;
 
+    decoder_owner_sys_t *owner = calloc(1, sizeof(*owner));
+    if (owner == NULL)
+        return NULL;
+
     packetizer = vlc_object_create(parent, sizeof(*packetizer));
     decoder = vlc_object_create(parent, sizeof(*decoder));
 
@@ -156,17 +176,22 @@ decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt)
     {
         if (packetizer)
             vlc_object_release(packetizer);
+        if (decoder)
+            vlc_object_release(decoder);
+        free(owner);
         return NULL;
     }
+    owner->packetizer = packetizer;
 
     decoder->pf_vout_format_update = video_update_format_decoder;
+    decoder->pf_aout_format_update = audio_update_format_decoder;
     decoder->pf_vout_buffer_new = video_new_buffer_decoder;
     decoder->pf_spu_buffer_new = spu_new_buffer_decoder;
     decoder->pf_queue_video = queue_video;
     decoder->pf_queue_audio = queue_audio;
     decoder->pf_queue_cc = queue_cc;
     decoder->pf_queue_sub = queue_sub;
-    decoder->p_owner = (void *)packetizer;
+    decoder->p_owner = owner;
 
     if (decoder_load(packetizer, true, fmt) != VLC_SUCCESS)
         goto end;
@@ -183,7 +208,9 @@ end:
 
 int test_decoder_process(decoder_t *decoder, block_t *p_block)
 {
-    decoder_t *packetizer = (void *) decoder->p_owner;
+    decoder_owner_sys_t *owner = decoder->p_owner;
+    decoder_t *packetizer = owner->packetizer;
+    mtime_t start = mdate(), end;
 
     /* This case can happen if a decoder reload failed */
     if (decoder->p_module == NULL)
@@ -198,6 +225,9 @@ int test_decoder_process(decoder_t *decoder, block_t *p_block)
     while ((p_packetized_block =
                 packetizer->pf_packetize(packetizer, pp_block)))
     {
+        end = mdate();
+        owner->packetizer_time += end - start;
+        start = end;
 
         if (!es_format_IsSimilar(&decoder->fmt_in, &packetizer->fmt_out))
         {
@@ -211,6 +241,7 @@ int test_decoder_process(decoder_t *decoder, block_t *p_block)
             if (decoder_load(decoder, false, &packetizer->fmt_out) != VLC_SUCCESS)
             {
                 block_ChainRelease(p_packetized_block);
+                owner->decoder_time += mdate() - start;
                 return VLC_EGENERIC;
             }
         }
@@ -234,13 +265,38 @@ int test_decoder_process(decoder_t *decoder, block_t *p_block)
             if (ret == VLCDEC_ECRITICAL)
             {
                 block_ChainRelease(p_next);
+                owner->decoder_time += mdate() - start;
                 return VLC_EGENERIC;
             }
 
             p_packetized_block = p_next;
         }
+        end = mdate();
+        owner->decoder_time += end - start;
+        start = end;
     }
+    end = mdate();
+    owner->packetizer_time += end - start;
+
     if (p_block == NULL) /* Drain */
+    {
         decoder->pf_decode(decoder, NULL);
+        owner->decoder_time += mdate() - end;
+    }
     return VLC_SUCCESS;
 }
+
+void test_decoder_get_stats(decoder_t *decoder,
+                            struct test_decoder_stats *stats)
+{
+    decoder_owner_sys_t *owner = decoder->p_owner;
+    decoder_t *packetizer = owner->packetizer;
+
+    stats->frames = owner->frames;
+    stats->packetizer_time = owner->packetizer_time;
+    stats->decoder_time = owner->decoder_time;
+    stats->packetizer = packetizer->p_module != NULL ?
+                        module_get_object(packetizer->p_module) : NULL;
+    stats->decoder = decoder->p_module != NULL ?
+                     module_get_object(decoder->p_module) : NULL;
+}
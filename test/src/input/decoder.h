@@ -20,6 +20,20 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 
+struct test_decoder_stats
+{
+    /* pictures, audio buffers or subpictures output by the decoder */
+    uintmax_t frames;
+    /* time spent in the packetizer and in the decoder modules */
+    mtime_t packetizer_time;
+    mtime_t decoder_time;
+    /* module names, NULL if not loaded */
+    const char *packetizer;
+    const char *decoder;
+};
+
 decoder_t *test_decoder_create(vlc_object_t *parent, const es_format_t *fmt);
 void test_decoder_destroy(decoder_t *decoder);
 int test_decoder_process(decoder_t *decoder, block_t *block);
+void test_decoder_get_stats(decoder_t *decoder,
+                            struct test_decoder_stats *stats);
@@ -0,0 +1,126 @@
+/*****************************************************************************
+ * block.c: test for the data blocks cache
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_block.h>
+
+static const size_t sizes[] = { 1, 188, 1316, 7 * 188, 4096, 20000, 65000,
+                                200000 };
+
+#define FIFO_BLOCKS 2000
+
+static void test_reuse(bool cached)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(sizes); i++)
+    {
+        block_t *block = block_Alloc(sizes[i]);
+        assert(block != NULL);
+        assert(block->i_buffer == sizes[i]);
+        assert(((uintptr_t)block->p_buffer % 32) == 0);
+        /* Less than a quarter is lost to the rounding to the cache classes,
+         * block header and padding included */
+        assert(block->i_size <= (sizes[i] + 128 + sizeof (*block)) * 5 / 4);
+        memset(block->p_buffer, 0x55, block->i_buffer);
+
+        uint8_t *p_buffer = block->p_buffer;
+        block_Release(block);
+
+        /* The last released block of the class is reused first */
+        block = block_Alloc(sizes[i]);
+        assert(block != NULL);
+        if (cached && sizes[i] < 65000)
+            assert(block->p_buffer == p_buffer);
+        assert(block->i_buffer == sizes[i]);
+        assert(block->i_flags == 0 && block->p_next == NULL);
+
+        block = block_Realloc(block, 100, sizes[i] + 1000);
+        assert(block != NULL);
+        assert(block->i_buffer == sizes[i] + 1100);
+        memset(block->p_buffer, 0xAA, block->i_buffer);
+        block_Release(block);
+    }
+}
+
+/* Blocks released by another thread than the allocating one */
+static void *consumer(void *data)
+{
+    block_fifo_t *fifo = data;
+
+    for (unsigned i = 0; i < FIFO_BLOCKS; i++)
+    {
+        block_t *block = block_FifoGet(fifo);
+        assert(block != NULL);
+        assert(block->i_buffer == sizes[i % ARRAY_SIZE(sizes)]);
+        assert(block->p_buffer[0] == (uint8_t)i);
+        block_Release(block);
+    }
+    return NULL;
+}
+
+static void test_threads(void)
+{
+    block_fifo_t *fifo = block_FifoNew();
+    assert(fifo != NULL);
+
+    vlc_thread_t th;
+    int ret = vlc_clone(&th, consumer, fifo, VLC_THREAD_PRIORITY_LOW);
+    assert(ret == 0);
+
+    for (unsigned i = 0; i < FIFO_BLOCKS; i++)
+    {
+        block_t *block = block_Alloc(sizes[i % ARRAY_SIZE(sizes)]);
+        assert(block != NULL);
+        block->p_buffer[0] = i;
+        block_FifoPut(fifo, block);
+    }
+
+    vlc_join(th, NULL);
+    block_FifoRelease(fifo);
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+    libvlc_int_t *obj = vlc->p_libvlc_int;
+
+    var_SetBool(obj, "block-cache", true);
+    test_reuse(true);
+    test_threads();
+
+    /* Blocks allocated from the cache and released after it is disabled */
+    block_t *block = block_Alloc(188);
+    assert(block != NULL);
+    var_SetBool(obj, "block-cache", false);
+    block_Release(block);
+    test_reuse(false);
+    test_threads();
+
+    var_SetBool(obj, "block-cache", true);
+    test_threads();
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,195 @@
+/*****************************************************************************
+ * frame_trace.c: test for the frame timing trace
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+
+#include <string.h>
+
+#define WIDTH 16
+#define HEIGHT 16
+#define FRAMES 10
+
+static const char *const stages[] = {
+    "es_out send", "decoder dequeue", "decoded", "vout queue", "vout render",
+    "vout display",
+};
+
+#define STAGES (sizeof (stages) / sizeof (stages[0]))
+
+/* Writes a short raw video, without audio */
+static void write_video(int fd)
+{
+    FILE *stream = fdopen(fd, "wb");
+    assert(stream != NULL);
+
+    fprintf(stream, "YUV4MPEG2 W%d H%d F25:1 Ip A1:1 C420jpeg\n",
+            WIDTH, HEIGHT);
+    for (unsigned i = 0; i < FRAMES; i++)
+    {
+        static unsigned char pixels[WIDTH * HEIGHT * 3 / 2];
+
+        memset(pixels, 16 * i, sizeof (pixels));
+        fputs("FRAME\n", stream);
+        fwrite(pixels, 1, sizeof (pixels), stream);
+    }
+    assert(fclose(stream) == 0);
+}
+
+static void play(const char *video, const char *trace)
+{
+    char option[256];
+    snprintf(option, sizeof (option), "--frame-trace=%s", trace);
+
+    /* The raw video demuxer ignores the frame rate of the file header */
+    const char *argv[] = { "-v", "--vout=vdummy", "--no-audio",
+                           "--rawvid-fps=25", option };
+    libvlc_instance_t *vlc = libvlc_new(sizeof (argv) / sizeof (argv[0]), argv);
+    assert(vlc != NULL);
+
+    libvlc_media_t *md = libvlc_media_new_path(vlc, video);
+    assert(md != NULL);
+    libvlc_media_player_t *mp = libvlc_media_player_new_from_media(md);
+    assert(mp != NULL);
+    libvlc_media_release(md);
+
+    assert(libvlc_media_player_play(mp) == 0);
+
+    libvlc_state_t state;
+    do
+    {
+        usleep(10000);
+        state = libvlc_media_player_get_state(mp);
+    }
+    while (state != libvlc_Ended && state != libvlc_Error);
+    assert(state == libvlc_Ended);
+
+    libvlc_media_player_stop(mp);
+    libvlc_media_player_release(mp);
+    /* The trace is written when the instance is released */
+    libvlc_release(vlc);
+}
+
+static unsigned stage_index(const char *name)
+{
+    for (unsigned i = 0; i < STAGES; i++)
+        if (!strcmp(name, stages[i]))
+            return i;
+    assert(!"unknown stage");
+    return 0;
+}
+
+/* Checks that the events of all the stages are tied to the video ES and to
+ * the stream timestamp of one of its frames */
+static void check(const char *trace)
+{
+    FILE *stream = fopen(trace, "rt");
+    assert(stream != NULL);
+
+    char line[512];
+    assert(fgets(line, sizeof (line), stream) != NULL);
+    assert(!strcmp(line, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"));
+
+    long long timestamps[FRAMES];
+    unsigned count[STAGES][FRAMES] = { { 0 } };
+    unsigned frames = 0;
+    int video_es = -1;
+    bool end = false;
+
+    while (fgets(line, sizeof (line), stream) != NULL)
+    {
+        assert(!end);
+        if (!strcmp(line, "]}\n"))
+        {
+            end = true;
+            continue;
+        }
+
+        char name[32], cat[16];
+        long long date, ts;
+        unsigned long tid;
+        int es_id, len = 0;
+
+        assert(sscanf(line, "{\"name\":\"%31[^\"]\",\"cat\":\"%15[^\"]\","
+                      "\"ph\":\"i\",\"s\":\"t\",\"ts\":%lld,\"pid\":1,"
+                      "\"tid\":%lu,\"args\":{\"es\":%d,\"ts\":%lld}}%n",
+                      name, cat, &date, &tid, &es_id, &ts, &len) == 6);
+        assert(!strcmp(line + len, ",\n") || !strcmp(line + len, "\n"));
+        assert(!strcmp(cat, "video"));
+
+        if (video_es == -1)
+            video_es = es_id;
+        assert(es_id == video_es);
+
+        /* The frames are traced in the order of the stream */
+        const unsigned stage = stage_index(name);
+        unsigned frame = 0;
+        while (frame < frames && timestamps[frame] != ts)
+            frame++;
+        if (frame == frames)
+        {
+            assert(stage == 0);
+            assert(frames < FRAMES);
+            timestamps[frames++] = ts;
+        }
+        count[stage][frame]++;
+    }
+    assert(end);
+    fclose(stream);
+
+    /* Every frame goes once through the input and decoder stages. The video
+     * output may drop late pictures, or show the last one again. */
+    unsigned displayed = 0;
+
+    assert(frames == FRAMES);
+    for (unsigned j = 0; j < FRAMES; j++)
+    {
+        for (unsigned i = 0; i < 4; i++)
+            assert(count[i][j] == 1);
+        displayed += count[5][j];
+    }
+    assert(displayed > 0);
+}
+
+int main(void)
+{
+    test_init();
+
+    char video[] = "/tmp/vlc-frame-trace-XXXXXX.y4m";
+    int fd = mkstemps(video, 4);
+    if (fd == -1)
+        return 77;
+    write_video(fd);
+
+    char trace[] = "/tmp/vlc-frame-trace-XXXXXX.json";
+    fd = mkstemps(trace, 5);
+    if (fd == -1)
+    {
+        unlink(video);
+        return 77;
+    }
+    close(fd);
+
+    play(video, trace);
+    check(trace);
+
+    unlink(trace);
+    unlink(video);
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*****************************************************************************
+ * subpictures.c: test for the subpicture region cache
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifdef NDEBUG
+ #undef NDEBUG
+#endif
+
+#include <assert.h>
+#include <string.h>
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_subpicture.h>
+#include <vlc_spu.h>
+
+/* The subpictures are rendered twice as large as their original size */
+#define WIDTH  320
+#define HEIGHT 240
+
+static subpicture_t *NewSubpicture(int channel, unsigned seed)
+{
+    subpicture_t *subpic = subpicture_New(NULL);
+    assert(subpic != NULL);
+
+    subpic->i_channel = channel;
+    subpic->i_start = 0;
+    subpic->i_stop = INT64_MAX;
+    subpic->b_absolute = true;
+    subpic->i_original_picture_width = WIDTH;
+    subpic->i_original_picture_height = HEIGHT;
+
+    video_format_t fmt;
+    video_format_Init(&fmt, VLC_CODEC_RGBA);
+    video_format_Setup(&fmt, VLC_CODEC_RGBA, 64, 32, 64, 32, 1, 1);
+
+    subpicture_region_t *region = subpicture_region_New(&fmt);
+    assert(region != NULL);
+    region->i_x = 16;
+    region->i_y = 100;
+
+    plane_t *p = &region->p_picture->p[0];
+    for (int y = 0; y < p->i_lines; y++)
+        for (int x = 0; x < p->i_pitch; x++)
+            p->p_pixels[y * p->i_pitch + x] = (x * 7 + y * 13) ^ seed;
+
+    subpic->p_region = region;
+    return subpic;
+}
+
+static picture_t *Render(spu_t *spu, subpicture_t **out)
+{
+    static const vlc_fourcc_t chromas[] = { VLC_CODEC_RGBA, 0 };
+    video_format_t src, dst;
+
+    video_format_Init(&src, VLC_CODEC_I420);
+    video_format_Setup(&src, VLC_CODEC_I420, WIDTH, HEIGHT,
+                       WIDTH, HEIGHT, 1, 1);
+    video_format_Init(&dst, VLC_CODEC_I420);
+    video_format_Setup(&dst, VLC_CODEC_I420, 2 * WIDTH, 2 * HEIGHT,
+                       2 * WIDTH, 2 * HEIGHT, 1, 1);
+
+    *out = spu_Render(spu, chromas, &dst, &src, 1, 1, false);
+    assert(*out != NULL && (*out)->p_region != NULL);
+
+    subpicture_region_t *region = (*out)->p_region;
+    if (region->fmt.i_visible_width != 128)
+        return NULL; /* no scaler */
+    assert(region->fmt.i_visible_height == 64);
+    return region->p_picture;
+}
+
+static int test_cache(spu_t *spu)
+{
+    const int channel = spu_RegisterChannel(spu);
+    subpicture_t *out, *out2;
+
+    /* Same subpicture over several frames */
+    spu_PutSubpicture(spu, NewSubpicture(channel, 0));
+    picture_t *first = Render(spu, &out);
+    if (first == NULL)
+    {
+        subpicture_Delete(out);
+        spu_ClearChannel(spu, channel);
+        return 77;
+    }
+    assert(Render(spu, &out2) == first);
+    subpicture_Delete(out2);
+
+    /* Recreated subpicture with the same content */
+    spu_ClearChannel(spu, channel);
+    spu_PutSubpicture(spu, NewSubpicture(channel, 0));
+    assert(Render(spu, &out2) == first);
+    subpicture_Delete(out2);
+
+    /* Different content */
+    spu_ClearChannel(spu, channel);
+    spu_PutSubpicture(spu, NewSubpicture(channel, 0x55));
+    picture_t *other = Render(spu, &out2);
+    assert(other != first);
+    assert(memcmp(other->p[0].p_pixels, first->p[0].p_pixels,
+                  first->p[0].i_visible_pitch) != 0);
+    subpicture_Delete(out2);
+
+    /* Back to the first content */
+    spu_ClearChannel(spu, channel);
+    spu_PutSubpicture(spu, NewSubpicture(channel, 0));
+    assert(Render(spu, &out2) == first);
+    subpicture_Delete(out2);
+
+    subpicture_Delete(out);
+    spu_ClearChannel(spu, channel);
+    return 0;
+}
+
+int main(void)
+{
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+
+    spu_t *spu = spu_Create(VLC_OBJECT(vlc->p_libvlc_int), NULL);
+    assert(spu != NULL);
+
+    int ret = test_cache(spu);
+
+    spu_Destroy(spu);
+    libvlc_release(vlc);
+    return ret;
+}
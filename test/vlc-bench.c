@@ -0,0 +1,551 @@
+/*****************************************************************************
+ * vlc-bench.c: input, demux and decode throughput benchmark
+ *****************************************************************************
+ * Copyright © 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifndef _WIN32
+# include <sys/resource.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_access.h>
+#include <vlc_block.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_modules.h>
+#include <vlc_url.h>
+#include "../lib/libvlc_internal.h"
+
+#include "src/input/common.h"
+#include "src/input/decoder.h"
+
+/*
+ * Null sink ES output: every ES is packetized and decoded as fast as the
+ * demuxer sends it, and the output frames are dropped.
+ */
+struct bench_es_out_t
+{
+    struct es_out_t out;
+    struct es_out_id_t *ids; /* active ES */
+    struct es_out_id_t *dead; /* deleted ES, kept for the report */
+    mtime_t send_time; /* time spent in EsOutSend */
+};
+
+struct es_out_id_t
+{
+    struct es_out_id_t *next;
+    decoder_t *decoder;
+    int cat;
+    int id;
+    struct test_decoder_stats stats;
+};
+
+static es_out_id_t *EsOutAdd(es_out_t *out, const es_format_t *fmt)
+{
+    struct bench_es_out_t *ctx = (struct bench_es_out_t *) out;
+
+    if (fmt->i_group < 0)
+        return NULL;
+
+    es_out_id_t *id = calloc(1, sizeof (*id));
+    if (unlikely(id == NULL))
+        return NULL;
+
+    id->next = ctx->ids;
+    ctx->ids = id;
+    id->decoder = test_decoder_create((void *)out->p_sys, fmt);
+    id->cat = fmt->i_cat;
+    id->id = fmt->i_id;
+    return id;
+}
+
+static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    struct bench_es_out_t *ctx = (struct bench_es_out_t *) out;
+    mtime_t start = mdate();
+
+    if (id->decoder)
+        test_decoder_process(id->decoder, block);
+    else
+        block_Release(block);
+
+    ctx->send_time += mdate() - start;
+    return VLC_SUCCESS;
+}
+
+static void IdKill(struct bench_es_out_t *ctx, es_out_id_t *id)
+{
+    if (id->decoder)
+    {
+        mtime_t start = mdate();
+
+        /* Drain */
+        test_decoder_process(id->decoder, NULL);
+        ctx->send_time += mdate() - start;
+        test_decoder_get_stats(id->decoder, &id->stats);
+        test_decoder_destroy(id->decoder);
+        id->decoder = NULL;
+    }
+    id->next = ctx->dead;
+    ctx->dead = id;
+}
+
+static void EsOutDelete(es_out_t *out, es_out_id_t *id)
+{
+    struct bench_es_out_t *ctx = (struct bench_es_out_t *) out;
+    es_out_id_t **pp = &ctx->ids;
+
+    while (*pp != id)
+    {
+        if (*pp == NULL)
+            abort();
+        pp = &((*pp)->next);
+    }
+
+    *pp = id->next;
+    IdKill(ctx, id);
+}
+
+static int EsOutControl(es_out_t *out, int query, va_list args)
+{
+    (void) out;
+
+    switch (query)
+    {
+        case ES_OUT_GET_ES_STATE:
+            va_arg(args, es_out_id_t *);
+            *va_arg(args, bool *) = true;
+            break;
+        case ES_OUT_GET_EMPTY:
+            *va_arg(args, bool *) = true;
+            break;
+        case ES_OUT_GET_PCR_SYSTEM:
+        case ES_OUT_MODIFY_PCR_SYSTEM:
+        case ES_OUT_RESTART_ES:
+        case ES_OUT_SET_GROUP:
+            return VLC_EGENERIC;
+        default:
+            break;
+    }
+    return VLC_SUCCESS;
+}
+
+static void EsOutDestroy(es_out_t *out)
+{
+    struct bench_es_out_t *ctx = (struct bench_es_out_t *)out;
+    es_out_id_t *id;
+
+    while ((id = ctx->dead) != NULL)
+    {
+        ctx->dead = id->next;
+        free(id);
+    }
+    free(ctx);
+}
+
+static struct bench_es_out_t *bench_es_out_create(vlc_object_t *parent)
+{
+    struct bench_es_out_t *ctx = malloc(sizeof (*ctx));
+    if (ctx == NULL)
+        return NULL;
+
+    ctx->ids = NULL;
+    ctx->dead = NULL;
+    ctx->send_time = 0;
+
+    es_out_t *out = &ctx->out;
+    out->pf_add = EsOutAdd;
+    out->pf_send = EsOutSend;
+    out->pf_del = EsOutDelete;
+    out->pf_control = EsOutControl;
+    out->pf_destroy = EsOutDestroy;
+    out->p_sys = (void *)parent;
+    return ctx;
+}
+
+/*
+ * Benchmark
+ */
+static mtime_t cpu_time(void)
+{
+#ifndef _WIN32
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+        return ru.ru_utime.tv_sec * CLOCK_FREQ + ru.ru_utime.tv_usec
+             + ru.ru_stime.tv_sec * CLOCK_FREQ + ru.ru_stime.tv_usec;
+#endif
+    return 0;
+}
+
+static long peak_rss(void)
+{
+#ifndef _WIN32
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+        return ru.ru_maxrss; /* KiB */
+#endif
+    return 0;
+}
+
+static const char *const cat_names[] = {
+    [UNKNOWN_ES] = "unknown",
+    [VIDEO_ES] = "video",
+    [AUDIO_ES] = "audio",
+    [SPU_ES] = "spu",
+    [DATA_ES] = "data",
+};
+
+static void print_run(unsigned run, const char *demux_name, mtime_t wall,
+                      mtime_t cpu, mtime_t demux_time,
+                      const es_out_id_t *ids, bool json)
+{
+    uintmax_t frames = 0, video_frames = 0;
+
+    for (const es_out_id_t *id = ids; id != NULL; id = id->next)
+    {
+        frames += id->stats.frames;
+        if (id->cat == VIDEO_ES)
+            video_frames += id->stats.frames;
+    }
+    if (video_frames > 0)
+        frames = video_frames;
+
+    double seconds = wall / (double)CLOCK_FREQ;
+    double fps = seconds > 0. ? frames / seconds : 0.;
+    double cpu_per_frame = frames > 0 ? cpu / (double)frames : 0.;
+
+    if (json)
+    {
+        printf("%s\n    {\"wall_us\":%"PRId64",\"cpu_us\":%"PRId64","
+               "\"frames\":%ju,\"fps\":%.3f,\"cpu_per_frame_us\":%.3f,"
+               "\"modules\":[\n      {\"type\":\"demux\",\"name\":\"%s\","
+               "\"time_us\":%"PRId64"}", run ? "," : "", wall, cpu, frames,
+               fps, cpu_per_frame, demux_name, demux_time);
+
+        for (const es_out_id_t *id = ids; id != NULL; id = id->next)
+        {
+            if (id->stats.packetizer != NULL)
+                printf(",\n      {\"type\":\"packetizer\",\"name\":\"%s\","
+                       "\"es\":%d,\"cat\":\"%s\",\"time_us\":%"PRId64"}",
+                       id->stats.packetizer, id->id, cat_names[id->cat],
+                       id->stats.packetizer_time);
+            if (id->stats.decoder != NULL)
+                printf(",\n      {\"type\":\"decoder\",\"name\":\"%s\","
+                       "\"es\":%d,\"cat\":\"%s\",\"frames\":%ju,"
+                       "\"time_us\":%"PRId64"}",
+                       id->stats.decoder, id->id, cat_names[id->cat],
+                       id->stats.frames, id->stats.decoder_time);
+        }
+        printf("]}");
+        return;
+    }
+
+    printf("run %u: %ju frames in %.3f s: %.2f fps, %.3f ms CPU per frame\n",
+           run + 1, frames, seconds, fps, cpu_per_frame / 1000.);
+    printf("  %-10s %-16s %10.3f ms %5.1f%%\n", "demux", demux_name,
+           demux_time / 1000., wall ? 100. * demux_time / wall : 0.);
+    for (const es_out_id_t *id = ids; id != NULL; id = id->next)
+    {
+        if (id->stats.packetizer != NULL)
+            printf("  %-10s %-16s %10.3f ms %5.1f%% (%s ES %d)\n",
+                   "packetizer", id->stats.packetizer,
+                   id->stats.packetizer_time / 1000.,
+                   wall ? 100. * id->stats.packetizer_time / wall : 0.,
+                   cat_names[id->cat], id->id);
+        if (id->stats.decoder != NULL)
+            printf("  %-10s %-16s %10.3f ms %5.1f%% (%s ES %d, "
+                   "%ju frames)\n", "decoder", id->stats.decoder,
+                   id->stats.decoder_time / 1000.,
+                   wall ? 100. * id->stats.decoder_time / wall : 0.,
+                   cat_names[id->cat], id->id, id->stats.frames);
+    }
+}
+
+static int bench_run(libvlc_int_t *libvlc, const char *url,
+                     const char *name, unsigned run, bool json)
+{
+    stream_t *s = vlc_access_NewMRL(VLC_OBJECT(libvlc), url);
+    if (s == NULL)
+    {
+        fprintf(stderr, "Error: cannot create input stream: %s\n", url);
+        return -1;
+    }
+
+    struct bench_es_out_t *ctx = bench_es_out_create(VLC_OBJECT(s));
+    if (ctx == NULL)
+    {
+        vlc_stream_Delete(s);
+        return -1;
+    }
+
+    mtime_t cpu_start = cpu_time();
+    mtime_t start = mdate();
+    mtime_t demux_time = 0;
+
+    demux_t *demux = demux_New(VLC_OBJECT(s), name, "", s, &ctx->out);
+    if (demux == NULL)
+    {
+        es_out_Delete(&ctx->out);
+        vlc_stream_Delete(s);
+        fprintf(stderr, "Error: cannot create demultiplexer: %s\n", name);
+        return -1;
+    }
+
+    char *demux_name = strdup(module_get_object(demux->p_module));
+    int val;
+
+    do
+    {
+        mtime_t demux_start = mdate();
+        mtime_t send_time = ctx->send_time;
+
+        val = demux_Demux(demux);
+        demux_time += mdate() - demux_start - (ctx->send_time - send_time);
+    }
+    while (val == VLC_DEMUXER_SUCCESS);
+
+    demux_Delete(demux);
+
+    /* Drain and collect the remaining ES */
+    while (ctx->ids != NULL)
+    {
+        es_out_id_t *id = ctx->ids;
+
+        ctx->ids = id->next;
+        IdKill(ctx, id);
+    }
+
+    mtime_t wall = mdate() - start;
+    mtime_t cpu = cpu_time() - cpu_start;
+
+    print_run(run, demux_name ? demux_name : "?", wall, cpu, demux_time,
+              ctx->dead, json);
+    free(demux_name);
+    es_out_Delete(&ctx->out);
+    return val == VLC_DEMUXER_EOF ? 0 : -1;
+}
+
+/*
+ * Input stream benchmark: reads the whole stream, as a demuxer would,
+ * directly from the access or through the prefetch thread.
+ */
+static ssize_t PipeRead(stream_t *s, void *buf, size_t len)
+{
+    return vlc_stream_ReadPartial(s->p_source, buf, len);
+}
+
+static int PipeControl(stream_t *s, int query, va_list args)
+{
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_FASTSEEK:
+            *va_arg(args, bool *) = false;
+            return VLC_SUCCESS;
+    }
+    return vlc_stream_vaControl(s->p_source, query, args);
+}
+
+static void PipeDestroy(stream_t *s)
+{
+    vlc_stream_Delete(s->p_source);
+}
+
+/* The prefetch filter only buffers streams that cannot seek quickly (pipes,
+ * network accesses): hide seeking to get it to read local files. */
+static stream_t *prefetch_new(vlc_object_t *obj, stream_t *access)
+{
+    stream_t *pipe = vlc_stream_CommonNew(obj, PipeDestroy);
+    if (pipe == NULL)
+    {
+        vlc_stream_Delete(access);
+        return NULL;
+    }
+
+    pipe->p_source = access;
+    pipe->pf_read = PipeRead;
+    pipe->pf_control = PipeControl;
+
+    stream_t *s = vlc_stream_FilterNew(pipe, "prefetch");
+    if (s == NULL)
+        vlc_stream_Delete(pipe);
+    return s;
+}
+
+static int bench_stream(libvlc_int_t *libvlc, const char *url,
+                        const char *mode, unsigned run, bool json)
+{
+    vlc_object_t *obj = VLC_OBJECT(libvlc);
+
+    stream_t *s = vlc_access_NewMRL(obj, url);
+    if (s != NULL && !strcmp(mode, "prefetch"))
+        s = prefetch_new(obj, s);
+    if (s == NULL)
+    {
+        fprintf(stderr, "Error: cannot create %s input stream: %s\n", mode,
+                url);
+        return -1;
+    }
+
+    char *access_name = strdup(module_get_object(s->p_module));
+    static char buf[1 << 16];
+    uintmax_t bytes = 0;
+    ssize_t val;
+    mtime_t cpu_start = cpu_time();
+    mtime_t start = mdate();
+
+    while ((val = vlc_stream_Read(s, buf, sizeof (buf))) > 0)
+        bytes += val;
+
+    mtime_t wall = mdate() - start;
+    mtime_t cpu = cpu_time() - cpu_start;
+    double mib = bytes / 1048576.;
+    double rate = wall > 0 ? mib * CLOCK_FREQ / wall : 0.;
+    double cpu_per_mib = bytes > 0 ? cpu / mib : 0.;
+
+    if (json)
+        printf("%s\n    {\"mode\":\"%s\",\"module\":\"%s\",\"bytes\":%ju,"
+               "\"wall_us\":%"PRId64",\"cpu_us\":%"PRId64","
+               "\"mib_per_s\":%.3f,\"cpu_per_mib_us\":%.3f}",
+               run ? "," : "", mode, access_name ? access_name : "?", bytes,
+               wall, cpu, rate, cpu_per_mib);
+    else
+        printf("run %u: %s (%s): %ju bytes in %.3f s: %.1f MiB/s, "
+               "%.3f ms CPU per MiB\n", run + 1, mode,
+               access_name ? access_name : "?", bytes,
+               wall / (double)CLOCK_FREQ, rate, cpu_per_mib / 1000.);
+
+    free(access_name);
+    vlc_stream_Delete(s);
+    return val == 0 ? 0 : -1;
+}
+
+static void print_json_string(const char *str)
+{
+    putchar('"');
+    for (; *str; str++)
+    {
+        if (*str == '"' || *str == '\\')
+            putchar('\\');
+        if ((unsigned char)*str >= 0x20)
+            putchar(*str);
+    }
+    putchar('"');
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: [V=verbosity] %s [-j] [-r repeat] [-d demux] [-s mode] "
+            "<filename>\n"
+            "  -j         print the results in JSON\n"
+            "  -r repeat  number of runs (default 1)\n"
+            "  -d demux   force the demultiplexer module\n"
+            "  -s mode    only read the input stream, with the given file\n"
+            "             reading mode: read or prefetch\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    struct vlc_run_args args;
+    unsigned repeat = 1;
+    const char *mode = NULL;
+    bool json = false;
+    int c;
+
+    vlc_run_args_init(&args);
+
+    while ((c = getopt(argc, argv, "jr:d:s:")) != -1)
+        switch (c)
+        {
+            case 'j':
+                json = true;
+                break;
+            case 'r':
+                repeat = strtoul(optarg, NULL, 10);
+                break;
+            case 'd':
+                args.name = optarg;
+                break;
+            case 's':
+                mode = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+
+    if (optind != argc - 1 || repeat == 0
+     || (mode != NULL && strcmp(mode, "read") && strcmp(mode, "prefetch")))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const char *path = argv[optind];
+    char *url = vlc_path2uri(path, NULL);
+    if (url == NULL)
+    {
+        fprintf(stderr, "Error: cannot convert path to URL: %s\n", path);
+        return 1;
+    }
+
+    libvlc_instance_t *vlc = libvlc_create(&args);
+    if (vlc == NULL)
+    {
+        free(url);
+        return 1;
+    }
+
+    const char *name = args.name != NULL ? args.name : "any";
+    int ret = 0;
+
+    if (json)
+    {
+        printf("{\"file\":");
+        print_json_string(path);
+        printf(",\"runs\":[");
+    }
+    else
+        printf("file: %s\n", path);
+
+    for (unsigned i = 0; i < repeat && ret == 0; i++)
+        if (mode != NULL)
+            ret = bench_stream(vlc->p_libvlc_int, url, mode, i, json);
+        else
+            ret = bench_run(vlc->p_libvlc_int, url, name, i, json);
+
+    if (json)
+        printf("\n  ],\"peak_rss_kib\":%ld}\n", peak_rss());
+    else
+        printf("peak RSS: %ld KiB\n", peak_rss());
+
+    libvlc_release(vlc);
+    free(url);
+    return -ret;
+}
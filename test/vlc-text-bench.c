@@ -0,0 +1,279 @@
+/*****************************************************************************
+ * vlc-text-bench.c: text renderer benchmark
+ *****************************************************************************
+ * Copyright © 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifndef _WIN32
+# include <sys/resource.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_modules.h>
+#include <vlc_filter.h>
+#include <vlc_subpicture.h>
+#include <vlc_text_style.h>
+#include "../lib/libvlc_internal.h"
+
+#include "src/input/common.h"
+
+/* Karaoke-like subtitles: the same few lines are rendered on every frame,
+ * with the highlighted word changing every few frames. */
+static const char *const lines[] = {
+    "The quick brown fox jumps over the lazy dog",
+    "Pack my box with five dozen liquor jugs",
+    "How vexingly quick daft zebras jump",
+};
+
+#define FRAMES_PER_WORD 5
+
+static mtime_t thread_cpu_time(void)
+{
+#ifndef _WIN32
+    struct rusage ru;
+# ifdef RUSAGE_THREAD
+    int who = RUSAGE_THREAD;
+# else
+    int who = RUSAGE_SELF;
+# endif
+
+    if (getrusage(who, &ru) == 0)
+        return ru.ru_utime.tv_sec * CLOCK_FREQ + ru.ru_utime.tv_usec
+             + ru.ru_stime.tv_sec * CLOCK_FREQ + ru.ru_stime.tv_usec;
+#endif
+    return 0;
+}
+
+static text_segment_t *NewText(unsigned highlight)
+{
+    text_segment_t *first = NULL, **next = &first;
+    unsigned word = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(lines); i++)
+    {
+        char *dup = strdup(lines[i]);
+        if (dup == NULL)
+            break;
+
+        char *saveptr;
+        for (const char *w = strtok_r(dup, " ", &saveptr); w != NULL;
+             w = strtok_r(NULL, " ", &saveptr))
+        {
+            char buf[64];
+            const bool last = saveptr == NULL || *saveptr == '\0';
+
+            snprintf(buf, sizeof (buf), "%s%s", w,
+                     !last ? " " : i + 1 < ARRAY_SIZE(lines) ? "\n" : "");
+
+            text_segment_t *seg = text_segment_New(buf);
+            if (seg == NULL)
+                break;
+            if (word++ == highlight)
+            {
+                seg->style = text_style_Create(STYLE_NO_DEFAULTS);
+                if (seg->style != NULL)
+                {
+                    seg->style->i_font_color = 0xFFFF00;
+                    seg->style->i_features |= STYLE_HAS_FONT_COLOR;
+                    seg->style->i_style_flags = STYLE_BOLD;
+                    seg->style->i_features |= STYLE_HAS_FLAGS;
+                }
+            }
+            *next = seg;
+            next = &seg->p_next;
+        }
+        free(dup);
+    }
+    return first;
+}
+
+static unsigned CountWords(void)
+{
+    text_segment_t *first = NewText(0);
+    unsigned count = 0;
+
+    for (const text_segment_t *seg = first; seg != NULL; seg = seg->p_next)
+        count++;
+    text_segment_ChainDelete(first);
+    return count;
+}
+
+static int bench_run(libvlc_int_t *libvlc, unsigned width, unsigned height,
+                     unsigned frames, unsigned cache_size, unsigned run,
+                     bool json)
+{
+    static const vlc_fourcc_t chromas[] = { VLC_CODEC_RGBA, 0 };
+    filter_t *text = vlc_object_create(libvlc, sizeof (*text));
+    if (text == NULL)
+        return -1;
+
+    es_format_Init(&text->fmt_in, VIDEO_ES, 0);
+    es_format_Init(&text->fmt_out, VIDEO_ES, 0);
+    text->fmt_out.video.i_width =
+    text->fmt_out.video.i_visible_width = width;
+    text->fmt_out.video.i_height =
+    text->fmt_out.video.i_visible_height = height;
+
+    var_Create(text, "freetype-cache-size", VLC_VAR_INTEGER);
+    var_SetInteger(text, "freetype-cache-size", cache_size);
+    var_Create(text, "spu-elapsed", VLC_VAR_INTEGER);
+    var_Create(text, "text-rerender", VLC_VAR_BOOL);
+
+    text->p_module = module_need(text, "text renderer", "freetype", true);
+    if (text->p_module == NULL)
+    {
+        fprintf(stderr, "Error: cannot load the text renderer\n");
+        vlc_object_release(text);
+        return -1;
+    }
+
+    const unsigned words = CountWords();
+    video_format_t fmt;
+    unsigned rendered = 0;
+
+    video_format_Init(&fmt, VLC_CODEC_TEXT);
+
+    mtime_t cpu_start = thread_cpu_time();
+    mtime_t start = mdate();
+
+    for (unsigned i = 0; i < frames; i++)
+    {
+        subpicture_region_t *region = subpicture_region_New(&fmt);
+        if (region == NULL)
+            break;
+
+        region->p_text = NewText((i / FRAMES_PER_WORD) % words);
+        region->i_align = SUBPICTURE_ALIGN_BOTTOM;
+        if (region->p_text != NULL
+         && text->pf_render(text, region, region, chromas) == VLC_SUCCESS)
+            rendered++;
+        subpicture_region_Delete(region);
+    }
+
+    mtime_t wall = mdate() - start;
+    mtime_t cpu = thread_cpu_time() - cpu_start;
+
+    module_unneed(text, text->p_module);
+    vlc_object_release(text);
+
+    double cpu_per_frame = rendered > 0 ? cpu / (double)rendered : 0.;
+
+    if (json)
+        printf("%s\n    {\"cache_kb\":%u,\"frames\":%u,\"wall_us\":%"PRId64","
+               "\"cpu_us\":%"PRId64",\"cpu_per_frame_us\":%.1f}",
+               run ? "," : "", cache_size, rendered, wall, cpu,
+               cpu_per_frame);
+    else
+        printf("run %u: cache %u kB: %u frames in %"PRId64" us, "
+               "%.1f us CPU per frame\n", run + 1, cache_size, rendered,
+               wall, cpu_per_frame);
+    return rendered == frames ? 0 : -1;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: [V=verbosity] %s [-j] [-r repeat] [-n frames] "
+            "[-c cache] [-s WxH]\n"
+            "  -j         print the results in JSON\n"
+            "  -r repeat  number of runs (default 1)\n"
+            "  -n frames  frames to render per run (default 1000)\n"
+            "  -c cache   cache size in kB (default: 0, then the "
+            "freetype-cache-size option)\n"
+            "  -s WxH     video size (default 1920x1080)\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    struct vlc_run_args args;
+    unsigned repeat = 1, frames = 1000, width = 1920, height = 1080;
+    int cache_size = -1;
+    bool json = false;
+    int c;
+
+    vlc_run_args_init(&args);
+
+    while ((c = getopt(argc, argv, "jr:n:c:s:")) != -1)
+        switch (c)
+        {
+            case 'j':
+                json = true;
+                break;
+            case 'r':
+                repeat = strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                frames = strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                cache_size = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                if (sscanf(optarg, "%ux%u", &width, &height) != 2)
+                {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+
+    if (optind != argc || repeat == 0 || width == 0 || height == 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    libvlc_instance_t *vlc = libvlc_create(&args);
+    if (vlc == NULL)
+        return 1;
+
+    /* Without an explicit size, compare the renderer without and with its
+     * default cache. */
+    const unsigned sizes[] = {
+        0, var_InheritInteger(vlc->p_libvlc_int, "freetype-cache-size"),
+    };
+    int ret = 0, n = 0;
+
+    if (json)
+        printf("{\"runs\":[");
+    for (unsigned i = 0; i < repeat && ret == 0; i++)
+    {
+        if (cache_size >= 0)
+            ret = bench_run(vlc->p_libvlc_int, width, height, frames,
+                            cache_size, n++, json);
+        else
+            for (size_t j = 0; j < ARRAY_SIZE(sizes) && ret == 0; j++)
+                ret = bench_run(vlc->p_libvlc_int, width, height, frames,
+                                sizes[j], n++, json);
+    }
+    if (json)
+        printf("\n]}\n");
+
+    libvlc_release(vlc);
+    return -ret;
+}
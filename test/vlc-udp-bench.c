@@ -0,0 +1,251 @@
+/*****************************************************************************
+ * vlc-udp-bench.c: UDP input loopback benchmark
+ *****************************************************************************
+ * Copyright © 2020 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifndef _WIN32
+# include <sys/resource.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_access.h>
+#include <vlc_block.h>
+#include <vlc_network.h>
+#include "../lib/libvlc_internal.h"
+
+#include "src/input/common.h"
+
+/* 7 MPEG-TS packets per datagram */
+#define DATAGRAM_SIZE (7 * 188)
+
+struct sender
+{
+    vlc_object_t *obj;
+    unsigned port;
+    unsigned long count; /* datagrams to send */
+    unsigned long rate; /* datagrams per second, 0 for unlimited */
+    unsigned long sent;
+};
+
+static void *Sender(void *data)
+{
+    struct sender *sender = data;
+    uint8_t buf[DATAGRAM_SIZE];
+    int fd = net_ConnectUDP(sender->obj, "127.0.0.1", sender->port, -1);
+
+    if (fd == -1)
+        return NULL;
+
+    memset(buf, 0, sizeof (buf));
+    for (unsigned i = 0; i < DATAGRAM_SIZE; i += 188)
+        buf[i] = 0x47;
+
+    /* Send in bursts of one millisecond worth of datagrams */
+    unsigned long burst = sender->rate ? __MAX(sender->rate / 1000, 1) : 0;
+    mtime_t start = mdate();
+
+    for (unsigned long i = 0; i < sender->count; i++)
+    {
+        if (burst != 0 && (i % burst) == 0)
+            mwait(start + (mtime_t)i * CLOCK_FREQ / (mtime_t)sender->rate);
+        if (send(fd, buf, sizeof (buf), 0) == sizeof (buf))
+            sender->sent++;
+    }
+
+    net_Close(fd);
+    return NULL;
+}
+
+static mtime_t thread_cpu_time(void)
+{
+#ifndef _WIN32
+    struct rusage ru;
+# ifdef RUSAGE_THREAD
+    int who = RUSAGE_THREAD;
+# else
+    int who = RUSAGE_SELF;
+# endif
+
+    if (getrusage(who, &ru) == 0)
+        return ru.ru_utime.tv_sec * CLOCK_FREQ + ru.ru_utime.tv_usec
+             + ru.ru_stime.tv_sec * CLOCK_FREQ + ru.ru_stime.tv_usec;
+#endif
+    return 0;
+}
+
+static int bench_run(libvlc_int_t *libvlc, struct sender *sender,
+                     unsigned batch, unsigned run, bool json)
+{
+    vlc_object_t *obj = VLC_OBJECT(libvlc);
+    char url[32];
+
+    var_Create(obj, "udp-batch", VLC_VAR_INTEGER);
+    var_SetInteger(obj, "udp-batch", batch);
+    var_Create(obj, "udp-timeout", VLC_VAR_INTEGER);
+    var_SetInteger(obj, "udp-timeout", 1);
+
+    snprintf(url, sizeof (url), "udp://@127.0.0.1:%u", sender->port);
+    stream_t *s = vlc_access_NewMRL(obj, url);
+    if (s == NULL)
+    {
+        fprintf(stderr, "Error: cannot create input stream: %s\n", url);
+        return -1;
+    }
+
+    vlc_thread_t th;
+    uintmax_t bytes = 0, blocks = 0;
+    mtime_t cpu_start = thread_cpu_time();
+    mtime_t start = mdate(), end = start;
+
+    sender->obj = obj;
+    sender->sent = 0;
+    if (vlc_clone(&th, Sender, sender, VLC_THREAD_PRIORITY_LOW))
+    {
+        vlc_stream_Delete(s);
+        return -1;
+    }
+
+    for (;;)
+    {
+        block_t *block = vlc_stream_ReadBlock(s);
+
+        if (block == NULL)
+        {
+            if (vlc_stream_Eof(s))
+                break;
+            continue;
+        }
+        bytes += block->i_buffer;
+        blocks++;
+        end = mdate();
+        block_Release(block);
+    }
+
+    mtime_t cpu = thread_cpu_time() - cpu_start;
+
+    vlc_join(th, NULL);
+    vlc_stream_Delete(s);
+
+    uintmax_t received = bytes / DATAGRAM_SIZE;
+    mtime_t wall = end - start;
+    double pps = wall > 0 ? received * (double)CLOCK_FREQ / wall : 0.;
+    double per_core = cpu > 0 ? received * (double)CLOCK_FREQ / cpu : 0.;
+    double cpu_per_packet = received > 0 ? cpu / (double)received : 0.;
+
+    if (json)
+        printf("%s\n    {\"batch\":%u,\"sent\":%lu,\"received\":%ju,"
+               "\"reads\":%ju,\"wall_us\":%"PRId64",\"cpu_us\":%"PRId64","
+               "\"packets_per_s\":%.0f,\"packets_per_core_s\":%.0f,"
+               "\"cpu_per_packet_us\":%.3f}", run ? "," : "", batch,
+               sender->sent, received, blocks, wall, cpu, pps, per_core,
+               cpu_per_packet);
+    else
+        printf("run %u: batch %u: %ju/%lu datagrams in %ju reads, "
+               "%.0f packets/s, %.0f packets/s per core, "
+               "%.3f us CPU per packet\n", run + 1, batch, received,
+               sender->sent, blocks, pps, per_core, cpu_per_packet);
+    return 0;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: [V=verbosity] %s [-j] [-r repeat] [-b batch] [-n count] "
+            "[-R rate] [-p port]\n"
+            "  -j         print the results in JSON\n"
+            "  -r repeat  number of runs (default 1)\n"
+            "  -b batch   datagrams per read (default: the udp-batch "
+            "option)\n"
+            "  -n count   datagrams to send (default 1000000)\n"
+            "  -R rate    datagrams per second (default: unlimited)\n"
+            "  -p port    UDP port (default 1234)\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    struct vlc_run_args args;
+    struct sender sender = {
+        .port = 1234,
+        .count = 1000000,
+        .rate = 0,
+    };
+    unsigned repeat = 1, batch = 0;
+    bool json = false;
+    int c;
+
+    vlc_run_args_init(&args);
+
+    while ((c = getopt(argc, argv, "jr:b:n:R:p:")) != -1)
+        switch (c)
+        {
+            case 'j':
+                json = true;
+                break;
+            case 'r':
+                repeat = strtoul(optarg, NULL, 10);
+                break;
+            case 'b':
+                batch = strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                sender.count = strtoul(optarg, NULL, 10);
+                break;
+            case 'R':
+                sender.rate = strtoul(optarg, NULL, 10);
+                break;
+            case 'p':
+                sender.port = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+
+    if (optind != argc || repeat == 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    libvlc_instance_t *vlc = libvlc_create(&args);
+    if (vlc == NULL)
+        return 1;
+
+    if (batch == 0)
+        batch = var_InheritInteger(vlc->p_libvlc_int, "udp-batch");
+
+    int ret = 0;
+
+    if (json)
+        printf("{\"runs\":[");
+    for (unsigned i = 0; i < repeat && ret == 0; i++)
+        ret = bench_run(vlc->p_libvlc_int, &sender, batch, i, json);
+    if (json)
+        printf("\n]}\n");
+
+    libvlc_release(vlc);
+    return -ret;
+}